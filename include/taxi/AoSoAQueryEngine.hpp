@@ -0,0 +1,64 @@
+#pragma once
+
+#include "taxi/HugePages.hpp"
+#include "taxi/TripDataAoSoA.hpp"
+#include "taxi/SoAQueryEngine.hpp"
+#include "taxi/QueryTypes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief The six queries over the tiled TripDataAoSoA layout.
+ *
+ * Filters run a tile at a time: the predicate is evaluated for all 64 lanes
+ * of a tile (fixed trip count, no early exit, so the compiler keeps the
+ * lanes in SIMD registers) into a 64-bit mask, and the matching rows are
+ * read off the mask's set bits.  Q5 evaluates its three predicates on the
+ * same tile.  Q1 uses a time-sorted index like SoAQueryEngine; Q5 and Q6
+ * scan tiles, skipping those whose pickup range misses the time window.
+ * Results are row indices, as in SoAQueryResult.
+ */
+class AoSoAQueryEngine {
+public:
+    explicit AoSoAQueryEngine(const TripDataAoSoA& data);
+
+    /// Build the time-sorted index and per-tile pickup ranges.  Must be
+    /// called before queries.  Returns build time in milliseconds.
+    double build_indexes();
+
+    SoAQueryResult search_by_time(const TimeRangeQuery& q) const;
+    SoAQueryResult search_by_distance(const NumericRangeQuery& q) const;
+    SoAQueryResult search_by_fare(const NumericRangeQuery& q) const;
+    SoAQueryResult search_by_location(const IntRangeQuery& q) const;
+    SoAQueryResult search_combined(const CombinedQuery& q) const;
+    AggregationResult aggregate_fare_by_time(const TimeRangeQuery& q) const;
+
+    bool        indexes_built() const { return indexed_; }
+    std::size_t size()          const { return data_.size(); }
+
+private:
+    const TripDataAoSoA&      data_;
+    RowIndex                  time_sorted_idx_;  ///< row indices sorted by pickup time
+    std::vector<std::int64_t> tile_min_pickup_;  ///< per tile, once indexed
+    std::vector<std::int64_t> tile_max_pickup_;
+    bool                      indexed_ = false;
+
+    std::int64_t pickup(std::size_t row) const {
+        return data_.tiles[row / TripTile::kRows].pickup_timestamp[row % TripTile::kRows];
+    }
+
+    /// Whether tile @p t can hold a pickup time in [start, end].
+    bool tile_in_time(std::size_t t, std::int64_t start, std::int64_t end) const {
+        return !indexed_ || (tile_max_pickup_[t] >= start && tile_min_pickup_[t] <= end);
+    }
+
+    /// Rows with pred(tile, lane), over the tiles that may hold a pickup
+    /// time in [start, end].
+    template <typename Pred>
+    SoAQueryResult scan_tiles(std::int64_t start, std::int64_t end, Pred pred) const;
+};
+
+} // namespace taxi
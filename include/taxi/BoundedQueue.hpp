@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace taxi {
+
+/**
+ * @brief Bounded lock-free multi-producer / multi-consumer queue.
+ *
+ * Dmitry Vyukov's array queue: each slot carries a sequence number that
+ * tells producers and consumers whether it is free or full, so push and pop
+ * are one CAS on the shared cursor plus a release store on the slot — no
+ * mutex anywhere.  Capacity is rounded up to a power of two.
+ *
+ * The blocking wrappers spin briefly and then yield, which is what gives
+ * IngestPipeline its back-pressure: a full queue stalls the producer stage
+ * instead of letting it buffer the whole input.  close() lets consumers
+ * drain what is left and then stop.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_  = cap - 1;
+        cells_ = std::make_unique<Cell[]>(cap);
+        for (std::size_t i = 0; i < cap; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    /// Non-blocking push.  @return false if the queue is full.
+    bool try_push(T& value) {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const std::size_t seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::move(value);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Non-blocking pop.  @return false if the queue is empty.
+    bool try_pop(T& out) {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            const std::size_t seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(c.value);
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Push, waiting while the queue is full (back-pressure).
+    void push(T value) {
+        for (unsigned spins = 0; !try_push(value); ++spins) backoff(spins);
+    }
+
+    /**
+     * @brief Push, waiting while the queue is full, unless @p cancel is set
+     *        first (a failed pipeline whose consumers have stopped).
+     * @return false if cancelled; @p value is then dropped.
+     */
+    bool push(T value, const std::atomic<bool>& cancel) {
+        for (unsigned spins = 0; !try_push(value); ++spins) {
+            if (cancel.load(std::memory_order_acquire)) return false;
+            backoff(spins);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Pop, waiting while the queue is empty.
+     * @return false once the queue is closed and fully drained.
+     */
+    bool pop(T& out) {
+        for (unsigned spins = 0;; ++spins) {
+            if (try_pop(out)) return true;
+            if (closed_.load(std::memory_order_acquire)) {
+                // Everything pushed before close() is visible now.
+                return try_pop(out);
+            }
+            backoff(spins);
+        }
+    }
+
+    /// No more pushes will follow; wakes consumers once the queue drains.
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> seq{0};
+        T value{};
+    };
+
+    static void backoff(unsigned spins) {
+        if (spins >= 64) std::this_thread::yield();
+    }
+
+    // Producer and consumer cursors on separate cache lines.
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<bool>        closed_{false};
+    std::size_t             mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+} // namespace taxi
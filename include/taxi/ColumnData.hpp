@@ -0,0 +1,117 @@
+#pragma once
+
+#include "taxi/HugePages.hpp"
+#include "taxi/MappedFile.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief One TripDataSoA column: an owned std::vector or a view of a mapping.
+ *
+ * Readers see a contiguous T array either way (data(), operator[], begin()),
+ * so query code does not care where the values live.  A mapped column is
+ * paged in by the kernel only where it is touched, and its clean pages are
+ * dropped under memory pressure instead of being swapped out.
+ *
+ * The mapping is copy-on-write (MappedFile::Mode::CopyOnWrite): element
+ * writes stay private to the process.  Operations that change the size
+ * (reserve, resize, push_back) first copy a mapped column into owned
+ * storage, as does copying the column; moves keep the mapping.
+ *
+ * Owned values live in a HugeVector: columns of 2 MB and more sit on huge
+ * pages, and resize() zeroes the new values from the OpenMP threads
+ * (first_touch_zero) instead of value-initialising them on one thread.
+ */
+template <typename T>
+class ColumnData {
+    static_assert(std::is_trivially_copyable_v<T>, "columns are zeroed with memset");
+
+public:
+    using value_type = T;
+
+    ColumnData() = default;
+
+    /// View @p n values at @p p, which must lie inside @p file.
+    ColumnData(std::shared_ptr<const MappedFile> file, T* p, std::size_t n)
+        : file_(std::move(file)), ptr_(p), n_(n) {}
+
+    ColumnData(const ColumnData& o) : vec_(o.begin(), o.end()) {}
+    ColumnData& operator=(const ColumnData& o) {
+        if (this != &o) {
+            release();
+            vec_.assign(o.begin(), o.end());
+        }
+        return *this;
+    }
+    ColumnData(ColumnData&&) noexcept = default;
+    ColumnData& operator=(ColumnData&&) noexcept = default;
+
+    bool        is_mapped() const { return file_ != nullptr; }
+    std::size_t size()      const { return file_ ? n_ : vec_.size(); }
+    bool        empty()     const { return size() == 0; }
+    std::size_t capacity()  const { return file_ ? n_ : vec_.capacity(); }
+
+    const T* data() const { return file_ ? ptr_ : vec_.data(); }
+    T*       data()       { return file_ ? ptr_ : vec_.data(); }
+
+    const T& operator[](std::size_t i) const { return data()[i]; }
+    T&       operator[](std::size_t i)       { return data()[i]; }
+
+    const T* begin() const { return data(); }
+    const T* end()   const { return data() + size(); }
+    T*       begin()       { return data(); }
+    T*       end()         { return data() + size(); }
+
+    std::span<const T> span() const { return {data(), size()}; }
+
+    void reserve(std::size_t n)  { own(); vec_.reserve(n); }
+    void resize(std::size_t n) {
+        own();
+        const std::size_t old = vec_.size();
+        vec_.resize(n);   // default-initialised: nothing written yet
+        if (n > old) first_touch_zero(vec_.data() + old, (n - old) * sizeof(T));
+    }
+    /// resize() without the zeroing: the caller writes every new value.
+    void resize_for_overwrite(std::size_t n) { own(); vec_.resize(n); }
+    void push_back(const T& v)   { if (file_) own(); vec_.push_back(v); }
+    void clear()                 { release(); vec_.clear(); }
+
+    /**
+     * @brief Hint how the column is about to be read (madvise); a no-op for
+     *        owned columns.  DontNeed also discards values written since
+     *        the column was mapped.
+     */
+    void advise(Access access) const {
+        if (file_) file_->advise(ptr_, n_ * sizeof(T), access);
+    }
+
+    friend bool operator==(const ColumnData& a, const ColumnData& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+private:
+    // Copy a mapped column into vec_ and drop the mapping.
+    void own() {
+        if (!file_) return;
+        vec_.assign(ptr_, ptr_ + n_);
+        release();
+    }
+    void release() {
+        file_.reset();
+        ptr_ = nullptr;
+        n_   = 0;
+    }
+
+    HugeVector<T>                     vec_;
+    std::shared_ptr<const MappedFile> file_;   ///< keeps the mapping alive
+    T*                                ptr_ = nullptr;
+    std::size_t                       n_   = 0;
+};
+
+} // namespace taxi
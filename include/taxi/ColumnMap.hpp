@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+namespace taxi {
+
+/**
+ * @brief The logical trip fields, in TripRecord / TripDataSoA order.
+ *
+ * A Column names a field independently of where a given CSV schema puts it;
+ * ColumnMap resolves it to a physical field index per file.
+ */
+enum class Column : std::uint8_t {
+    VendorId,
+    PickupTimestamp,
+    DropoffTimestamp,
+    PassengerCount,
+    TripDistance,
+    RateCodeId,
+    StoreAndFwdFlag,
+    PuLocationId,
+    DoLocationId,
+    PaymentType,
+    FareAmount,
+    Extra,
+    MtaTax,
+    TipAmount,
+    TollsAmount,
+    ImprovementSurcharge,
+    TotalAmount,
+};
+
+inline constexpr std::size_t kColumnCount = 17;
+
+/**
+ * @brief A set of Columns (bit mask) — the projection requested at load time.
+ */
+class ColumnSet {
+public:
+    constexpr ColumnSet() = default;   ///< empty set
+    constexpr ColumnSet(std::initializer_list<Column> cols) {
+        for (Column c : cols) bits_ |= bit(c);
+    }
+
+    static constexpr ColumnSet all() {
+        ColumnSet s;
+        s.bits_ = (1u << kColumnCount) - 1;
+        return s;
+    }
+
+    constexpr bool has(Column c) const { return (bits_ & bit(c)) != 0; }
+    constexpr bool empty() const { return bits_ == 0; }
+    constexpr bool is_all() const { return bits_ == all().bits_; }
+    constexpr std::uint32_t bits() const { return bits_; }
+
+    constexpr ColumnSet operator|(ColumnSet o) const {
+        ColumnSet s;
+        s.bits_ = bits_ | o.bits_;
+        return s;
+    }
+    /// Columns in both this set and @p o.
+    constexpr ColumnSet operator&(ColumnSet o) const {
+        ColumnSet s;
+        s.bits_ = bits_ & o.bits_;
+        return s;
+    }
+    /// Columns of this set that are not in @p o.
+    constexpr ColumnSet operator-(ColumnSet o) const {
+        ColumnSet s;
+        s.bits_ = bits_ & ~o.bits_;
+        return s;
+    }
+    constexpr bool operator==(const ColumnSet&) const = default;
+
+private:
+    static constexpr std::uint32_t bit(Column c) {
+        return 1u << static_cast<unsigned>(c);
+    }
+    std::uint32_t bits_ = 0;
+};
+
+/**
+ * @brief Columns TripRecord::is_valid() and the timestamp check read.
+ *
+ * These are decoded for every row whatever the projection, so a projected
+ * load keeps exactly the rows a full load keeps.
+ */
+inline constexpr ColumnSet kValidationColumns{
+    Column::PickupTimestamp, Column::DropoffTimestamp, Column::PassengerCount,
+    Column::TripDistance, Column::TotalAmount};
+
+/**
+ * @brief Resolve a header or field name to a Column (case-insensitive).
+ *
+ * Accepts the TLC header names of every schema year (VendorID,
+ * tpep_/lpep_pickup_datetime, RatecodeID, PULocationID, ...) and the
+ * TripRecord field names (vendor_id, pickup_timestamp, ...).
+ * @return std::nullopt for columns TripRecord does not hold
+ *         (congestion_surcharge, airport_fee, ehail_fee, ...).
+ */
+std::optional<Column> column_from_name(std::string_view name);
+
+/// TripRecord field name of @p c ("pickup_timestamp", ...).
+std::string_view column_name(Column c);
+
+/**
+ * @brief Where each Column sits in the rows of one CSV file.
+ *
+ * Built once per file from its header row, so files whose schema adds
+ * (congestion_surcharge, airport_fee) or reorders columns (green taxi
+ * lpep_ files) are read by name instead of by fixed position.  A header
+ * without both pickup and dropoff timestamp columns is not trusted and the
+ * fixed TLC yellow-taxi layout is used instead.
+ */
+struct ColumnMap {
+    static constexpr std::int8_t kAbsent = -1;
+
+    /// Only the first kMaxFields fields of a row can be mapped (CsvReader).
+    static constexpr std::size_t kMaxFields = 32;
+
+    /// Physical field index of each Column, or kAbsent (decoded as empty).
+    std::array<std::int8_t, kColumnCount> index{};
+
+    /// Fields in the header row; 0 for the fixed layout (no usable header).
+    std::size_t field_count = 0;
+
+    /// Fixed layout: Column i at field i, rows of 17-19 fields accepted.
+    static ColumnMap tlc_default();
+
+    /**
+     * @brief Map the columns named in @p header (one CSV line; quotes and a
+     *        line ending allowed).  Falls back to tlc_default().
+     */
+    static ColumnMap from_header(std::string_view header);
+
+    int operator[](Column c) const { return index[static_cast<std::size_t>(c)]; }
+
+    /// Whether a row with @p n_fields fields fits this schema.
+    bool accepts(std::size_t n_fields) const {
+        return field_count > 0 ? n_fields == field_count
+                               : n_fields >= 17 && n_fields <= 19;
+    }
+
+    /// Bit i set if physical field i holds one of @p cols.
+    std::uint32_t field_mask(ColumnSet cols) const;
+};
+
+} // namespace taxi
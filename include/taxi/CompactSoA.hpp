@@ -0,0 +1,131 @@
+#pragma once
+
+#include "taxi/TripDataSoA.hpp"
+#include "taxi/NarrowColumn.hpp"
+#include "taxi/PackedColumn.hpp"
+#include "taxi/MoneyColumn.hpp"
+#include "taxi/TimestampColumn.hpp"
+#include "taxi/CsvReader.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief Compact SoA variant: int codes at their natural width, money in
+ *        cents, timestamps frame-of-reference encoded.
+ *
+ * TripDataSoA keeps the code columns as 4-byte ints.  Here the
+ * low-cardinality ones (vendor_id, passenger_count, rate_code_id,
+ * payment_type, store_and_fwd_flag) are PackedColumns of 0-4 bit dictionary
+ * codes, and the two location IDs NarrowColumns (uint16_t in practice),
+ * chosen from the values actually seen.  The seven money columns are
+ * MoneyColumns: int32_t cents, or doubles if a value is not a whole number
+ * of cents.  pickup_timestamp is a TimestampColumn (per-block base +
+ * uint32_t offsets) and dropoff_timestamp a delta from it.  Only
+ * trip_distance stays in @c wide, a TripDataSoA that no longer stores the
+ * other sixteen.  On TLC data a row shrinks from 105 to about 47 bytes.
+ *
+ * SoAQueryEngine accepts a CompactTripDataSoA and scans the compact columns
+ * directly: Q1 and the index over the encoded timestamps, Q3 and Q6 in
+ * cents, Q4 over uint16_t, Q5's passenger filter as a selection bitmap
+ * computed on the packed codes.
+ */
+struct CompactTripDataSoA {
+    /// The columns stored as PackedColumns.
+    static constexpr ColumnSet kPackedColumns{
+        Column::VendorId, Column::PassengerCount, Column::RateCodeId,
+        Column::PaymentType, Column::StoreAndFwdFlag};
+    /// The columns stored as NarrowColumns.
+    static constexpr ColumnSet kNarrowColumns{Column::PuLocationId, Column::DoLocationId};
+    /// The columns stored as MoneyColumns.
+    static constexpr ColumnSet kMoneyColumns{
+        Column::FareAmount, Column::Extra, Column::MtaTax, Column::TipAmount,
+        Column::TollsAmount, Column::ImprovementSurcharge, Column::TotalAmount};
+    /// The columns stored as TimestampColumn / TimestampDeltaColumn.  The
+    /// dropoff delta needs the pickup column: without it dropoff stays wide.
+    static constexpr ColumnSet kTimeColumns{Column::PickupTimestamp, Column::DropoffTimestamp};
+
+    TripDataSoA  wide;            ///< the stored columns not kept compact
+    TimestampColumn      pickup_timestamp;
+    TimestampDeltaColumn dropoff_timestamp;   ///< relative to pickup_timestamp
+    PackedColumn vendor_id;
+    PackedColumn passenger_count;
+    PackedColumn rate_code_id;
+    PackedColumn payment_type;
+    PackedColumn store_and_fwd_flag;
+    NarrowColumn pu_location_id;
+    NarrowColumn do_location_id;
+    MoneyColumn  fare_amount;
+    MoneyColumn  extra;
+    MoneyColumn  mta_tax;
+    MoneyColumn  tip_amount;
+    MoneyColumn  tolls_amount;
+    MoneyColumn  improvement_surcharge;
+    MoneyColumn  total_amount;
+
+    CompactTripDataSoA() = default;
+    /// Empty table that stores only @p columns.
+    explicit CompactTripDataSoA(ColumnSet columns);
+
+    std::size_t size() const { return wide.size(); }
+
+    /// Dropoff time of row @p i, decoded.
+    std::int64_t dropoff_at(std::size_t i) const {
+        return dropoff_timestamp.at(i, pickup_timestamp[i]);
+    }
+
+    /// Columns this table stores (compact and wide).
+    ColumnSet columns() const { return columns_; }
+
+    /// Bytes held by the column data.
+    std::size_t bytes() const;
+
+    void reserve(std::size_t n);
+
+    /// Append one record; a packed column gives a new value the next code
+    /// (widening by a bit past a power of two), a narrow column widens if a
+    /// value does not fit, a money column falls back to doubles on a value
+    /// that is not cents.
+    void push_back(const TripRecord& r);
+
+    /**
+     * @brief Compact the columns of a loaded table.
+     *
+     * Each packed column's dictionary and each narrow column's width come
+     * from its values, each money column is cents if all its values
+     * convert; the source vector is freed before the next column is
+     * converted, so the peak is the wide table plus one compact column.
+     */
+    static CompactTripDataSoA from_soa(TripDataSoA&& soa);
+
+    /**
+     * @brief Load CSV files straight into the compact layout.
+     *
+     * Packed columns grow their dictionary, narrow columns start as uint8_t
+     * and widen on the first value that does not fit, money columns start
+     * as cents, so no wide copy of them ever exists.
+     * @see TripDataSoA::from_csv for the parameters.
+     */
+    static CompactTripDataSoA from_csv(const std::vector<std::string>& paths,
+                                       std::size_t reserve_count = 0,
+                                       ColumnSet columns = ColumnSet::all(),
+                                       ReadMode mode = ReadMode::Mmap,
+                                       CsvReader::Stats* stats = nullptr);
+
+private:
+    // The stored columns kept compact rather than in @c wide.
+    static ColumnSet compacted(ColumnSet columns);
+    bool dropoff_is_delta() const { return compacted(columns_).has(Column::DropoffTimestamp); }
+
+    // Apply fn(column, compact member, TripDataSoA member, TripRecord member)
+    // to every stored packed, narrow, money and pickup column (not dropoff:
+    // it also needs the pickup time).
+    template <typename Fn>
+    void for_each_compact(Fn&& fn);
+
+    ColumnSet columns_ = ColumnSet::all();
+};
+
+} // namespace taxi
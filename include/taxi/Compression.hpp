@@ -0,0 +1,98 @@
+#pragma once
+
+#include "taxi/FileSource.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief Compression of an input file, recognised by its magic bytes.
+ *
+ * Gzip needs zlib and Zstd needs libzstd at build time (TAXI_HAVE_ZLIB /
+ * TAXI_HAVE_ZSTD); opening a compressed input without its library throws.
+ */
+enum class Compression {
+    None,
+    Gzip,   ///< .csv.gz: one or more gzip members
+    Zstd    ///< .csv.zst: one or more zstd frames
+};
+
+/// Compression of data starting with @p head (at least 4 bytes to detect).
+Compression detect_compression(std::string_view head);
+
+/// Compression of the file at @p path; None for non-regular files (pipes
+/// are never read ahead).
+Compression file_compression(const std::string& path);
+
+/// "none", "gzip" or "zstd".
+const char* compression_name(Compression c);
+
+/// Whether this build can decompress @p c.
+bool compression_supported(Compression c);
+
+/**
+ * @brief Streaming decompressor over a raw FileSource.
+ *
+ * next() returns decompressed chunks of up to @p chunk_bytes; consecutive
+ * gzip members and zstd frames are decoded back to back.  size() is the
+ * compressed size.  FileSource::open() wraps compressed inputs in this.
+ * @throws std::runtime_error on corrupt or truncated input.
+ */
+std::unique_ptr<FileSource> make_decompressing_source(std::unique_ptr<FileSource> raw,
+                                                      Compression c,
+                                                      const std::string& path,
+                                                      std::size_t chunk_bytes);
+
+/**
+ * @brief A compressed file decompressed into memory, as whole-line blocks.
+ *
+ * Members / frames are decoded into separate buffers; the line cut at
+ * each buffer boundary is copied into a small seam buffer so every block
+ * holds whole lines (the last block may lack its final newline).
+ */
+class DecodedText {
+public:
+    /// Whole-line blocks in file order.  Valid while this object lives
+    /// (moving it keeps them valid).
+    const std::vector<std::string_view>& blocks() const { return blocks_; }
+
+    /// Decompressed bytes.
+    std::size_t size() const;
+
+    /// Gzip members / zstd frames decoded, and how many independent units
+    /// the decoding was split into.
+    std::size_t members() const { return members_; }
+    std::size_t units() const { return parts_.size(); }
+
+private:
+    friend DecodedText decompress_parallel(std::string_view, Compression, int,
+                                           const std::string&);
+    void stitch();
+
+    std::vector<std::string>      parts_;
+    std::vector<std::string>      seams_;
+    std::vector<std::string_view> blocks_;
+    std::size_t                   members_ = 0;
+};
+
+/**
+ * @brief Decompress a whole compressed file with up to @p num_threads threads.
+ *
+ * zstd frames are located exactly from their headers; gzip members are
+ * found from member-header candidates and every split is verified (a
+ * segment must end on a member end whose CRC checks out), so a false
+ * candidate inside deflate data only costs a serial re-decode of the
+ * affected range.  A single-member / single-frame file decodes serially.
+ *
+ * @param compressed  The whole compressed file (e.g. a MappedFile view).
+ * @param path        For error messages.
+ * @throws std::runtime_error on corrupt input or a missing library.
+ */
+DecodedText decompress_parallel(std::string_view compressed, Compression c,
+                                int num_threads, const std::string& path = "");
+
+} // namespace taxi
@@ -1,22 +1,70 @@
 #pragma once
 
 #include "taxi/TripRecord.hpp"
+#include "taxi/MappedFile.hpp"
+#include "taxi/CsvScanner.hpp"
+#include "taxi/ColumnMap.hpp"
+#include "taxi/FileSource.hpp"
+#include "taxi/TimestampDecoder.hpp"
+#include <array>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <memory>
 #include <vector>
 
 namespace taxi {
 
+/**
+ * @brief How CsvReader gets bytes from disk.
+ *
+ *  - Mmap:   map the whole file and tokenize in place (zero-copy).  Rows and
+ *            fields are std::string_view slices of the mapping, so parsing
+ *            performs no per-row heap allocation.
+ *  - Stream: std::ifstream + std::getline into a reused line buffer.  Needed
+ *            for inputs that cannot be mapped (pipes, character devices).
+ *  - Buffered, Pread, Direct: the file is read in chunks through the
+ *            matching FileSource backend (read(), pread + posix_fadvise,
+ *            io_uring + O_DIRECT) and tokenized in place in each chunk; only
+ *            the line straddling two chunks is copied.
+ *
+ * Mmap silently falls back to Stream when the path is not a regular file;
+ * the FileSource modes fall back as described in FileSource.  Gzip / zstd
+ * files (.csv.gz, .csv.zst) are decompressed on the fly: Mmap and Stream
+ * switch to Buffered for them.
+ */
+enum class ReadMode {
+    Mmap,
+    Stream,
+    Buffered,
+    Pread,
+    Direct
+};
+
+/// Command-line name of @p mode ("mmap", "stream", "buffered", "pread", "direct").
+const char* read_mode_name(ReadMode mode);
+
 /**
  * @brief Streaming CSV reader for TLC taxi trip data.
- * 
- * Reads CSV files line-by-line without loading entire file into memory.
+ *
+ * Reads CSV files row-by-row without loading entire file into memory.
  * Handles parsing, type conversion, and error handling.
+ *
+ * Field boundaries come from CsvScanner: in Mmap mode the mapping is indexed
+ * in ~1 MB blocks of whole lines (SIMD, 64 bytes per step), in Stream mode
+ * each getline() buffer is indexed the same way, so both modes — and every
+ * ParallelLoader chunk — split fields by identical rules.
+ *
+ * Columns are located by name: the header row of each file is turned into a
+ * ColumnMap, so schema years that add or reorder columns parse correctly.
+ * A ColumnSet projection limits work to the requested columns — other
+ * fields are neither sliced nor decoded and come back as their defaults
+ * (the kValidationColumns are always decoded so the same rows are kept).
  */
 class CsvReader {
 public:
-    explicit CsvReader(const std::string& filepath);
+    explicit CsvReader(const std::string& filepath, ReadMode mode = ReadMode::Mmap,
+                       ColumnSet columns = ColumnSet::all());
     ~CsvReader();
 
     // Non-copyable, movable
@@ -37,6 +85,22 @@ public:
      */
     bool is_open() const;
 
+    /**
+     * @brief The mode actually in use (Mmap may have fallen back to Stream).
+     */
+    ReadMode mode() const { return mode_; }
+
+    /**
+     * @brief I/O backend actually reading the file: "mmap", "stream", or the
+     *        FileSource name (e.g. "io_uring+O_DIRECT").
+     */
+    const char* io_backend() const;
+
+    /**
+     * @brief Column positions in use (from the header, or the fixed layout).
+     */
+    const ColumnMap& column_map() const { return schema_; }
+
     /**
      * @brief Get statistics about parsing.
      */
@@ -44,6 +108,27 @@ public:
         std::size_t rows_read = 0;
         std::size_t rows_parsed_ok = 0;
         std::size_t rows_discarded = 0;
+
+        // Timestamp fields whose date part came from the DateCache (hit) or
+        // had to be decoded (miss).  Fields handled by the tolerant fallback
+        // parser count as neither.
+        std::size_t timestamp_cache_hits = 0;
+        std::size_t timestamp_cache_misses = 0;
+
+        double timestamp_cache_hit_rate() const {
+            const std::size_t n = timestamp_cache_hits + timestamp_cache_misses;
+            return n > 0 ? static_cast<double>(timestamp_cache_hits) / n : 0.0;
+        }
+
+        /// Accumulate another reader's counters (per-chunk / per-thread merge).
+        Stats& operator+=(const Stats& o) {
+            rows_read              += o.rows_read;
+            rows_parsed_ok         += o.rows_parsed_ok;
+            rows_discarded         += o.rows_discarded;
+            timestamp_cache_hits   += o.timestamp_cache_hits;
+            timestamp_cache_misses += o.timestamp_cache_misses;
+            return *this;
+        }
     };
 
     Stats get_stats() const { return stats_; }
@@ -52,9 +137,10 @@ public:
      * @brief Parse a byte-range slice of a CSV file into records.
      *
      * Used by ParallelLoader. Each thread calls this with non-overlapping
-     * [byte_start, byte_end] ranges. When byte_start > 0 the method
-     * automatically discards the (possibly partial) first line so that
-     * record ownership is unambiguous across chunks.
+     * [byte_start, byte_end] ranges.  A line belongs to the chunk that
+     * contains its first byte, so when byte_start > 0 the (possibly partial)
+     * line running into byte_start is skipped — the previous chunk owns it.
+     * The file is memory-mapped; threads share the same page-cache pages.
      *
      * @param path       Path to the CSV file.
      * @param byte_start First byte of this chunk (inclusive).
@@ -68,31 +154,121 @@ public:
         std::int64_t byte_end,
         Stats& out_stats);
 
+    /**
+     * @brief Reader over an in-memory slice of whole CSV lines.
+     *
+     * No header row is skipped and nothing is copied: the caller keeps
+     * @p bytes alive (typically a MappedFile) for the reader's lifetime.
+     * ParallelLoader hands each morsel of a shared mapping to one of these,
+     * with the ColumnMap built from that file's header.
+     */
+    static CsvReader from_bytes(std::string_view bytes,
+                                const ColumnMap& map = ColumnMap::tlc_default(),
+                                ColumnSet columns = ColumnSet::all());
+
+    /// Upper bound on fields per row that the tokenizer records (TLC has 17-20).
+    static constexpr std::size_t kMaxFields = ColumnMap::kMaxFields;
+    using FieldArray = std::array<std::string_view, kMaxFields>;
+
+    /// Bytes of whole lines indexed per CsvScanner pass in Mmap mode.
+    static constexpr std::size_t kScanBlockBytes = 1 << 20;
+
 private:
-    // Default constructor used internally by load_chunk.
-    CsvReader() : stats_(), header_read_(false) {}
+    // Reader over an in-memory byte range (no header skip); see from_bytes().
+    // The tag keeps string literals from being ambiguous with the path
+    // constructor.
+    struct FromBytes {};
+    CsvReader(FromBytes, std::string_view bytes, const ColumnMap& map, ColumnSet columns);
+
+    ReadMode         mode_ = ReadMode::Mmap;
+    std::ifstream    file_;
+    MappedFile       map_;
+    std::string_view window_;   ///< mapped bytes not yet indexed (Mmap mode)
+    std::string      line_buf_; ///< reused getline buffer (Stream mode)
+    std::unique_ptr<FileSource> source_;   ///< chunk reader (Buffered/Pread/Direct)
+    std::string_view pending_;             ///< unconsumed part of the current chunk
+    std::vector<char> carry_;              ///< partial line at the end of a chunk
+    std::vector<char> stitch_;             ///< carry_ + rest of its line, indexed as a block
+    bool             source_eof_ = false;
+    Stats            stats_;
+    bool             header_read_ = false;
+    TimestampFormat  ts_format_   = TimestampFormat::Unknown;  ///< sniffed from the first timestamp
+    DateCache        date_cache_;                              ///< date prefix -> days since epoch
+    ColumnMap        schema_ = ColumnMap::tlc_default();   ///< column positions of this file
+    ColumnSet        columns_ = ColumnSet::all();   ///< requested projection
+    ColumnSet        decode_  = ColumnSet::all();   ///< columns_ + kValidationColumns
+    std::uint32_t    wanted_fields_ = ~0u;          ///< physical fields take_row() slices
+
+    // Structural index of the current block (Mmap) or line (Stream).
+    CsvScanner                     scanner_;
+    std::string_view               block_;
+    std::span<const std::uint32_t> seps_;
+    std::size_t                    sep_pos_   = 0;
+    std::size_t                    row_start_ = 0;
+    FieldArray                     fields_;
+
+    /**
+     * @brief Consume the header row and build schema_ from it.
+     * @return false if the input is empty.
+     */
+    bool skip_header();
 
-    std::ifstream file_;
-    Stats stats_;
-    bool header_read_;
+    /**
+     * @brief Set schema_ and derive decode_ / wanted_fields_ for columns_.
+     */
+    void use_column_map(const ColumnMap& map);
+
+    /**
+     * @brief Index the next block of whole lines from window_ (Mmap and
+     *        FileSource modes).
+     * @return false when the input is exhausted.
+     */
+    bool next_block();
 
     /**
-     * @brief Parse a CSV line into a TripRecord.
-     * @param line The CSV line to parse.
-     * @param record Output parameter.
+     * @brief Point window_ at the next whole lines from source_: either the
+     *        in-place body of a chunk or a line stitched across two chunks.
+     * @return false at end of file.
+     */
+    bool refill_window();
+
+    /**
+     * @brief Split the next row into fields_.
+     * @return Number of fields in the row (only the first kMaxFields are
+     *         recorded), or 0 at end of input.
+     */
+    std::size_t next_row();
+
+    /**
+     * @brief Slice the row starting at row_start_ using the indexed separators.
+     *        Surrounding quotes and a trailing \r are stripped from each field.
+     *        Only fields in wanted_fields_ are sliced; all are counted.
+     */
+    std::size_t take_row();
+
+    /**
+     * @brief Convert split fields into a TripRecord.
+     * @param tokens   Field views of one row.
+     * @param n_tokens Number of fields in the row.
+     * @param record   Output parameter.
      * @return true if parsing succeeded, false otherwise.
      */
-    bool parse_line(const std::string& line, TripRecord& record);
+    bool parse_fields(const FieldArray& tokens, std::size_t n_tokens,
+                      TripRecord& record);
 
     /**
-     * @brief Split a CSV line into tokens, handling quoted fields.
+     * @brief Convert timestamp string to seconds since epoch (0 if invalid).
+     *
+     * Uses the fixed-width decoder for the file's layout (ts_format_): the
+     * time of day is decoded per field, the date part is memoized in
+     * date_cache_.  Fields that do not match go to parse_timestamp_slow().
      */
-    std::vector<std::string> split_csv_line(const std::string& line);
+    std::int64_t parse_timestamp(std::string_view timestamp_str);
 
     /**
-     * @brief Convert timestamp string to seconds since epoch.
+     * @brief sscanf-based parser that detects the layout per field.
      */
-    std::int64_t parse_timestamp(const std::string& timestamp_str);
+    std::int64_t parse_timestamp_slow(std::string_view timestamp_str);
 };
 
 } // namespace taxi
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace taxi {
+
+/**
+ * @brief Vectorized structural index for CSV buffers.
+ *
+ * Finds every field separator (',' outside quotes) and row terminator
+ * ('\n') in a buffer and returns their offsets.  CsvReader slices fields
+ * between consecutive offsets instead of walking the row one char at a time.
+ *
+ * The SIMD kernels classify 64 bytes per step: quote / comma / newline
+ * bitmasks are built with byte compares, the "inside quotes" mask is the
+ * prefix-XOR of the quote mask, and set bits are extracted with ctz.
+ *
+ * Quote semantics (shared by every kernel, so results are identical):
+ *  - '"' toggles the quoted state; "" inside a quoted field toggles twice.
+ *  - '\n' always ends a row and resets the quoted state, exactly like the
+ *    line-at-a-time reader — one stray quote cannot swallow the rest of a
+ *    multi-GB file.
+ *
+ * The best kernel is chosen at runtime (AVX2 > SSE4.2 > scalar); non-x86
+ * builds always use the scalar kernel.
+ */
+class CsvScanner {
+public:
+    enum class Kernel {
+        Scalar,
+        Sse42,
+        Avx2
+    };
+
+    /// Fastest kernel supported by the running CPU.
+    static Kernel detect();
+
+    /// True if @p k can run on this CPU.
+    static bool supported(Kernel k);
+
+    /// Short lowercase name ("scalar", "sse42", "avx2") for logs / CSVs.
+    static const char* name(Kernel k);
+
+    explicit CsvScanner(Kernel kernel = detect());
+
+    // Non-copyable (owns the offset buffer), movable
+    CsvScanner(const CsvScanner&) = delete;
+    CsvScanner& operator=(const CsvScanner&) = delete;
+    CsvScanner(CsvScanner&&) = default;
+    CsvScanner& operator=(CsvScanner&&) = default;
+
+    Kernel kernel() const { return kernel_; }
+
+    /**
+     * @brief Index the structural characters of @p bytes.
+     *
+     * Quoted state carries over from the previous call (a field may span
+     * two calls) until reset() or the next newline.
+     *
+     * @return Offsets (relative to bytes.data()) of every structural ',' and
+     *         '\n', in order.  Valid until the next scan() call.
+     */
+    std::span<const std::uint32_t> scan(std::string_view bytes);
+
+    /// Forget any open quote carried from the previous scan().
+    void reset() { in_quotes_ = false; }
+
+private:
+    Kernel                          kernel_;
+    bool                            in_quotes_ = false;
+    std::unique_ptr<std::uint32_t[]> out_;
+    std::size_t                     capacity_ = 0;
+};
+
+} // namespace taxi
@@ -2,6 +2,8 @@
 
 #include "taxi/TripRecord.hpp"
 #include "taxi/QueryEngine.hpp"
+#include "taxi/IngestPipeline.hpp"
+#include "taxi/CsvReader.hpp"
 #include <string>
 #include <vector>
 #include <memory>
@@ -28,21 +30,33 @@ public:
     /**
      * @brief Load trip records from a CSV file.
      * @param csv_path Path to the CSV file.
+     * @param mode     How the file is read (see ReadMode).
      * @throws std::runtime_error if file cannot be opened or read.
      */
-    void load_from_csv(const std::string& csv_path);
+    void load_from_csv(const std::string& csv_path, ReadMode mode = ReadMode::Mmap);
+
+    /**
+     * @brief Load several CSV files through the staged IngestPipeline.
+     *
+     * Reading, parsing and appending overlap across all files.  Appends to
+     * the existing records in file order, like repeated load_from_csv().
+     * @return Per-stage busy/idle times of the run.
+     * @throws std::runtime_error if a file cannot be opened or read.
+     */
+    IngestPipeline::Report load_from_csv_pipelined(const std::vector<std::string>& csv_paths,
+                                                   const IngestPipeline::Options& opts = {});
 
     /**
      * @brief Get all loaded records (const reference).
      */
-    const std::vector<TripRecord>& records() const { return records_; }
+    const TripRecords& records() const { return records_; }
 
     /**
      * @brief Move all loaded records out of this manager (leaves manager empty).
      * Use instead of records() when you don't need the manager afterwards,
      * to avoid a 17 GB copy when working with large datasets.
      */
-    std::vector<TripRecord> take_records() { return std::move(records_); }
+    TripRecords take_records() { return std::move(records_); }
 
     /**
      * @brief Get the number of loaded records.
@@ -87,6 +101,8 @@ public:
         std::size_t total_rows_read = 0;
         std::size_t total_rows_parsed = 0;
         std::size_t total_rows_discarded = 0;
+        std::size_t timestamp_cache_hits = 0;
+        std::size_t timestamp_cache_misses = 0;
     };
 
     LoadStats get_load_stats() const { return load_stats_; }
@@ -104,7 +120,7 @@ public:
     void reserve_if_needed(std::size_t estimated_size);
 
 private:
-    std::vector<TripRecord> records_;
+    TripRecords records_;
     LoadStats load_stats_;
     std::unique_ptr<QueryEngine> query_engine_;
 };
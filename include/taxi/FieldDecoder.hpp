@@ -0,0 +1,174 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+
+namespace taxi {
+
+/**
+ * @brief Allocation-free, exception-free decoding of CSV field text.
+ *
+ * Replaces std::stoi / std::stod (which need a std::string, consult the
+ * locale, and report bad input by throwing).  Every decoder returns false on
+ * empty / non-numeric / out-of-range input and leaves @p out untouched, so
+ * callers pick their own default.  Header-only so the per-field calls inline
+ * into CsvReader's row loop.
+ *
+ * Accepted syntax matches what the old strtol/strtod path accepted for TLC
+ * data: leading blanks, an optional sign, and a numeric prefix (trailing
+ * characters are ignored, e.g. "3.5" decodes as int 3).
+ */
+
+namespace detail {
+
+inline std::string_view skip_blanks(std::string_view s) {
+    std::size_t i = 0;
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t')) ++i;
+    return s.substr(i);
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Exact powers of ten representable as double (10^0 .. 10^22).
+inline constexpr double kPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// General double conversion for anything the fast paths decline
+// (exponents, nan/inf, > 15 significant digits).
+inline bool decode_double_slow(std::string_view s, double& out) {
+    if (!s.empty() && s[0] == '+') s.remove_prefix(1);
+#if defined(__cpp_lib_to_chars)
+    double v;
+    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc{}) return false;
+    out = v;
+    return true;
+#else
+    // Standard libraries without floating-point from_chars (older libc++).
+    char buf[64];
+    if (s.size() >= sizeof buf) return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    char* end = nullptr;
+    const double v = std::strtod(buf, &end);
+    if (end == buf) return false;
+    out = v;
+    return true;
+#endif
+}
+
+} // namespace detail
+
+/**
+ * @brief Decode a base-10 integer field (e.g. PULocationID, "238").
+ */
+inline bool decode_int(std::string_view s, int& out) {
+    s = detail::skip_blanks(s);
+    if (s.size() > 1 && s[0] == '+' && detail::is_digit(s[1])) s.remove_prefix(1);
+    int v;
+    const auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec != std::errc{}) return false;
+    out = v;
+    return true;
+}
+
+/**
+ * @brief Decode a decimal field (e.g. trip_distance, "1.34").
+ *
+ * Fast path: plain [-]digits[.digits] with <= 15 significant digits is
+ * accumulated as an integer mantissa and divided once by an exact power of
+ * ten.  One correctly-rounded IEEE division of two exact values yields the
+ * same double strtod would (Clinger's fast path).  Anything else goes to
+ * std::from_chars.
+ */
+inline bool decode_double(std::string_view s, double& out) {
+    s = detail::skip_blanks(s);
+    const char* p   = s.data();
+    const char* end = p + s.size();
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+
+    std::uint64_t mant = 0;
+    int digits = 0, frac = 0;
+    for (; p < end && detail::is_digit(*p); ++p, ++digits)
+        mant = mant * 10 + static_cast<unsigned>(*p - '0');
+    if (p < end && *p == '.') {
+        for (++p; p < end && detail::is_digit(*p); ++p, ++digits, ++frac)
+            mant = mant * 10 + static_cast<unsigned>(*p - '0');
+    }
+
+    const bool has_exponent = p < end && (*p == 'e' || *p == 'E');
+    if (digits == 0 || digits > 15 || has_exponent) {
+        return detail::decode_double_slow(s, out);
+    }
+
+    const double v = static_cast<double>(mant) / detail::kPow10[frac];
+    out = neg ? -v : v;
+    return true;
+}
+
+/**
+ * @brief Fixed-point decoder for money columns: "10.8" -> 1080 cents.
+ *
+ * Accepts [-]digits[.d[d]] (at most two decimals, at most 15 digits) and
+ * produces the exact amount in cents.  Returns false for anything else —
+ * including values with a third decimal — so no rounding ever happens here.
+ */
+inline bool decode_cents(std::string_view s, std::int64_t& cents) {
+    s = detail::skip_blanks(s);
+    const char* p   = s.data();
+    const char* end = p + s.size();
+
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+
+    std::int64_t whole = 0;
+    int digits = 0;
+    for (; p < end && detail::is_digit(*p); ++p, ++digits) {
+        if (digits == 15) return false;   // stop before whole * 100 can overflow
+        whole = whole * 10 + (*p - '0');
+    }
+
+    int frac = 0, frac_digits = 0;
+    if (p < end && *p == '.') {
+        for (++p; p < end && detail::is_digit(*p); ++p, ++frac_digits) {
+            if (frac_digits == 2) return false;   // sub-cent precision
+            frac = frac * 10 + (*p - '0');
+        }
+    }
+    if (frac_digits == 1) frac *= 10;
+
+    if (digits + frac_digits == 0) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) return false;
+
+    const std::int64_t v = whole * 100 + frac;
+    cents = neg ? -v : v;
+    return true;
+}
+
+/**
+ * @brief Decode a 2-decimal money field as double via the fixed-point path.
+ *
+ * cents / 100.0 is one correctly-rounded division, so the result is
+ * bit-identical to strtod; other shapes fall back to decode_double().
+ */
+inline bool decode_money(std::string_view s, double& out) {
+    std::int64_t cents;
+    if (decode_cents(s, cents)) {
+        if (cents == 0) {   // keep strtod's signed zero for "-0" / "-0.00"
+            out = detail::skip_blanks(s).front() == '-' ? -0.0 : 0.0;
+        } else {
+            out = static_cast<double>(cents) / 100.0;
+        }
+        return true;
+    }
+    return decode_double(s, out);
+}
+
+} // namespace taxi
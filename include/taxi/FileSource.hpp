@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace taxi {
+
+/**
+ * @brief Sequential chunked reader of one file — the I/O backend under
+ *        CsvReader's Buffered / Pread / Direct read modes.
+ *
+ * next() hands out the file front to back in chunks of up to chunk_bytes
+ * (chunks end anywhere, not on line boundaries).  Backends:
+ *
+ *  - Buffered: plain read() through the page cache.
+ *  - Pread:    pread() at explicit offsets; posix_fadvise(WILLNEED) starts
+ *              kernel read-ahead of the next chunk while the current one is
+ *              parsed, and DONTNEED drops chunks already read, so a one-pass
+ *              ingest leaves the page cache to the data being queried.
+ *  - Direct:   O_DIRECT reads issued through io_uring into a ring of three
+ *              aligned buffers: while one chunk is parsed the next two are
+ *              already in flight, and nothing lands in the page cache.
+ *              Falls back to buffered io_uring if the filesystem refuses
+ *              O_DIRECT, and to Pread if io_uring is unavailable (kernel,
+ *              seccomp, or built without <linux/io_uring.h>).
+ *
+ * gzip and zstd files (recognised by their magic bytes) are decompressed
+ * on the fly: next() then returns decompressed bytes and size() stays the
+ * compressed size.
+ *
+ * name() reports the backend actually in use.
+ */
+class FileSource {
+public:
+    enum class Backend {
+        Buffered,
+        Pread,
+        Direct
+    };
+
+    /// Default chunk size: a multiple of the O_DIRECT alignment.
+    static constexpr std::size_t kDefaultChunkBytes = std::size_t{4} << 20;
+
+    /**
+     * @brief Open @p path with @p backend (or its fallback).
+     * @param chunk_bytes Bytes per chunk; rounded up to 4 KB for Direct.
+     * @throws std::runtime_error if the file cannot be opened, or is
+     *         compressed and this build lacks the library to decode it.
+     */
+    static std::unique_ptr<FileSource> open(const std::string& path, Backend backend,
+                                            std::size_t chunk_bytes = kDefaultChunkBytes);
+
+    virtual ~FileSource() = default;
+
+    /**
+     * @brief Next chunk of the file; empty at end of file.
+     *
+     * The view stays valid until the following call.
+     * @throws std::runtime_error on a read error.
+     */
+    virtual std::string_view next() = 0;
+
+    /// Backend in use, e.g. "io_uring+O_DIRECT" or "pread+fadvise".
+    virtual const char* name() const = 0;
+
+    /// Total file size in bytes.
+    std::uint64_t size() const { return size_; }
+
+    /**
+     * @brief Testing only: treat the first io_uring read of every Direct
+     *        source opened from now on as if it returned at most @p bytes
+     *        (0 turns this off), to exercise the short-read path.
+     */
+    static void set_short_first_read(std::size_t bytes);
+
+protected:
+    std::uint64_t size_ = 0;
+};
+
+} // namespace taxi
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "taxi/TripRecord.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief The fields of a trip that the queries read (Q1-Q6): 40 bytes.
+ *
+ * Member names match TripRecord, so the AoS QueryEngine code runs on an
+ * array of these unchanged (HotColdQueryEngine).
+ */
+struct TripHot {
+    std::int64_t pickup_timestamp;
+    double       trip_distance;
+    double       fare_amount;
+    double       total_amount;
+    int          passenger_count;
+    int          pu_location_id;
+};
+
+/// The other fields of a trip, read only to rebuild a full record.
+struct TripCold {
+    std::int64_t dropoff_timestamp;
+    double       extra;
+    double       mta_tax;
+    double       tip_amount;
+    double       tolls_amount;
+    double       improvement_surcharge;
+    int          vendor_id;
+    int          rate_code_id;
+    int          do_location_id;
+    int          payment_type;
+    bool         store_and_fwd_flag;
+};
+
+/**
+ * @brief Hot/cold split Array-of-Structs: trip i is hot[i] + cold[i].
+ *
+ * A TripRecord scan pulls the whole ~128-byte struct through the cache to
+ * compare one 8-byte field.  Here the six queried fields live in a 40-byte
+ * TripHot, so a scan moves about a third of the bytes, while results are
+ * still record pointers (const TripHot*) that lead to the rest of the trip
+ * through cold_of() / record().
+ */
+struct HotColdTrips {
+    std::vector<TripHot>  hot;
+    std::vector<TripCold> cold;
+
+    std::size_t size() const { return hot.size(); }
+
+    void reserve(std::size_t n);
+    void push_back(const TripRecord& r);
+
+    /// Index of the trip whose hot part is @p h (a pointer into @c hot).
+    std::size_t index_of(const TripHot* h) const {
+        return static_cast<std::size_t>(h - hot.data());
+    }
+    const TripCold& cold_of(const TripHot* h) const { return cold[index_of(h)]; }
+
+    /// Trip @p i reassembled.
+    TripRecord record(std::size_t i) const;
+
+    /// Split AoS records into hot and cold arrays.
+    static HotColdTrips from_aos(std::span<const TripRecord> records);
+};
+
+} // namespace taxi
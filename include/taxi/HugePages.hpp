@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace taxi {
+
+/// Page size used for large column allocations.
+enum class PagePolicy : std::uint8_t {
+    Huge,   ///< 2 MB pages: explicit (MAP_HUGETLB) if the pool has room, else THP
+    Small   ///< 4 KB pages only (MADV_NOHUGEPAGE), for comparison
+};
+
+/// Policy of allocations made from now on (default Huge).  Process-wide.
+void       set_page_policy(PagePolicy policy);
+PagePolicy page_policy();
+
+constexpr std::size_t kHugePageBytes = std::size_t{2} << 20;
+
+/**
+ * @brief Map @p bytes (>= kHugePageBytes) of anonymous memory, 2 MB aligned.
+ *
+ * Under PagePolicy::Huge the range comes from the explicit huge page pool
+ * when it can hold it, otherwise it is advised MADV_HUGEPAGE so the kernel
+ * backs it with transparent huge pages as it is touched.  Nothing is touched
+ * here: pages are faulted in by the first write to them.
+ * @throws std::bad_alloc if the mapping fails.
+ */
+void* huge_allocate(std::size_t bytes);
+void  huge_deallocate(void* p, std::size_t bytes) noexcept;
+
+/**
+ * @brief Zero @p bytes at @p p from the OpenMP threads, 2 MB chunks split
+ *        statically across them.
+ *
+ * The scans split rows the same way (schedule(static)), so each thread
+ * faults in the pages it will later read.  Serial when small or when
+ * already inside a parallel region.
+ */
+void first_touch_zero(void* p, std::size_t bytes);
+
+/// Large allocations currently mapped, by the kind of pages that back them.
+struct HugePageStats {
+    std::size_t explicit_bytes = 0;   ///< from the MAP_HUGETLB pool
+    std::size_t thp_bytes      = 0;   ///< advised MADV_HUGEPAGE
+    std::size_t small_bytes    = 0;   ///< PagePolicy::Small
+};
+HugePageStats huge_page_stats();
+
+/// Bytes of this process's anonymous memory on transparent huge pages
+/// (AnonHugePages of /proc/self/smaps_rollup); 0 if unavailable.
+std::size_t anon_huge_page_bytes();
+
+/**
+ * @brief Allocator of the SoA columns and row indexes.
+ *
+ * Requests of 2 MB and more are served by huge_allocate(); smaller ones by
+ * operator new.  construct() without arguments default-initialises, so
+ * resize() of a vector of numbers leaves the new values unwritten instead of
+ * zero-filling them serially: the caller writes them (or zeroes them with
+ * first_touch_zero()), in parallel.
+ */
+template <typename T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+
+    HugePageAllocator() noexcept = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T)) throw std::bad_array_new_length();
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < kHugePageBytes) return static_cast<T*>(::operator new(bytes));
+        return static_cast<T*>(huge_allocate(bytes));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        const std::size_t bytes = n * sizeof(T);
+        if (bytes < kHugePageBytes) ::operator delete(p);
+        else                        huge_deallocate(p, bytes);
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    friend bool operator==(const HugePageAllocator&, const HugePageAllocator&) { return true; }
+};
+
+template <typename T>
+using HugeVector = std::vector<T, HugePageAllocator<T>>;
+
+/// Row ids, e.g. a time-sorted index.
+using RowIndex = HugeVector<std::size_t>;
+
+} // namespace taxi
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "taxi/CsvReader.hpp"
+#include "taxi/TripDataSoA.hpp"
+#include "taxi/TripRecord.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief Staged multi-file CSV ingest: read -> parse -> place.
+ *
+ *   reader (1 thread)   read()s every input file, in order, into large
+ *                       recycled buffers cut at the last newline
+ *   parsers (N threads) CsvReader over each buffer -> thread-local rows
+ *   placer (1 thread)   restores file order and appends the rows to the
+ *                       output (TripDataSoA or an AoS vector)
+ *
+ * Stages are connected by BoundedQueue (lock-free MPMC).  The reader can
+ * only run ahead by the number of buffers in the pool, and by at most that
+ * many batches past the last one placed (the reorder window), so a slow
+ * batch stalls the reader instead of growing the placer's backlog.  Memory
+ * stays bounded while disk reads, parsing and placement all overlap —
+ * across file boundaries too: the reader starts on the next file while the
+ * previous one is still parsed.  The files are read by one thread, one
+ * after another; parsing, not the single disk, is what is spread out.
+ *
+ * An exception in any stage stops the others, and load() rethrows it once
+ * every thread has joined.
+ *
+ * Each stage reports busy time (doing its own work) and idle time (waiting
+ * on a queue), which shows directly which stage is the bottleneck.
+ */
+class IngestPipeline {
+public:
+    struct Options {
+        int         parser_threads = 4;
+        std::size_t buffer_bytes   = std::size_t{8} << 20;  ///< one read batch
+        std::size_t queue_depth    = 16;   ///< batches in flight per queue
+    };
+
+    /// Busy/idle wall time of one stage, summed over its threads.
+    struct StageTimes {
+        double busy_ms = 0.0;
+        double idle_ms = 0.0;
+        int    threads = 0;
+
+        /// Fraction of the stage's thread time spent working.
+        double utilization() const {
+            const double t = busy_ms + idle_ms;
+            return t > 0.0 ? busy_ms / t : 0.0;
+        }
+    };
+
+    struct Report {
+        StageTimes reader;
+        StageTimes parser;
+        StageTimes placer;
+        CsvReader::Stats stats;       ///< parse counters over all files
+        std::size_t bytes_read = 0;
+        std::size_t batches    = 0;
+        double      wall_ms    = 0.0;
+    };
+
+    IngestPipeline() = default;
+    explicit IngestPipeline(const Options& opts) : opts_(opts) {}
+
+    /**
+     * @brief Append every valid row of @p paths (in order) to @p out.
+     *
+     * Only the columns @p out stores (TripDataSoA::columns()) are parsed;
+     * each file's header is mapped once by the reader.
+     * @throws std::runtime_error if a file cannot be opened or read, or
+     *         whatever a parser or the placer threw (e.g. std::bad_alloc).
+     */
+    Report load(const std::vector<std::string>& paths, TripDataSoA& out) const;
+
+    /// Same pipeline, AoS output (DatasetManager::load_from_csv_pipelined).
+    Report load(const std::vector<std::string>& paths, TripRecords& out) const;
+
+    const Options& options() const { return opts_; }
+
+private:
+    Options opts_;
+};
+
+} // namespace taxi
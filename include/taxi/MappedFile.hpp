@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace taxi {
+
+/**
+ * @brief Expected access to a mapped range, passed to madvise().
+ */
+enum class Access {
+    Normal,       ///< kernel default read-ahead
+    Sequential,   ///< front-to-back scan: aggressive read-ahead
+    Random,       ///< gathers through an index: no read-ahead
+    WillNeed,     ///< start reading the range in now
+    DontNeed      ///< drop the range; it is faulted in again if touched
+};
+
+/**
+ * @brief Read-only memory mapping of a whole file (POSIX mmap).
+ *
+ * Lets CsvReader tokenize directly over the page cache: rows and fields are
+ * std::string_view slices of the mapping, so no per-row copy or heap
+ * allocation is needed.  Pages are faulted in lazily by the kernel.
+ *
+ * Only regular files can be mapped; pipes and character devices must go
+ * through the std::ifstream path (ReadMode::Stream).
+ *
+ * A CopyOnWrite mapping may also be written through mutable_data(): written
+ * pages become private to the process and the file never changes.
+ */
+class MappedFile {
+public:
+    enum class Mode {
+        ReadOnly,
+        CopyOnWrite   ///< MAP_PRIVATE + PROT_WRITE: writes stay in memory
+    };
+
+    MappedFile() = default;
+
+    /**
+     * @brief Map @p path read-only.
+     * @throws std::runtime_error if the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path, Mode mode = Mode::ReadOnly);
+    ~MappedFile();
+
+    // Non-copyable, movable
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Map @p path read-only, replacing any current mapping.
+     * @return false (instead of throwing) if the file is not a mappable
+     *         regular file; the object is left closed in that case.
+     */
+    bool open(const std::string& path, Mode mode = Mode::ReadOnly);
+
+    /**
+     * @brief Unmap the file.  Safe to call on a closed mapping.
+     */
+    void close();
+
+    bool        is_open() const { return open_; }
+    const char* data()    const { return data_; }
+    std::size_t size()    const { return size_; }
+
+    std::string_view view() const { return {data_, size_}; }
+
+    /// Writable view of a CopyOnWrite mapping (nullptr for ReadOnly).
+    char* mutable_data() const {
+        return mode_ == Mode::CopyOnWrite ? const_cast<char*>(data_) : nullptr;
+    }
+
+    /**
+     * @brief Hint the kernel that the mapping will be read front to back
+     *        (MADV_SEQUENTIAL: aggressive read-ahead, early page reclaim).
+     */
+    void advise_sequential() const;
+
+    /**
+     * @brief madvise() the pages covering [p, p + bytes), which must lie in
+     *        the mapping (the range is widened to whole pages).
+     */
+    void advise(const void* p, std::size_t bytes, Access access) const;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool        open_ = false;
+    Mode        mode_ = Mode::ReadOnly;
+};
+
+} // namespace taxi
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief @p v as a whole number of cents, if it is one.
+ *
+ * Exact means c / 100.0 == v: the double a CSV field like "10.80" parses to
+ * is the correctly rounded c / 100, so every TLC amount converts and the
+ * conversion back is lossless.
+ */
+inline bool to_cents(double v, std::int32_t& cents) {
+    if (!(std::fabs(v) < 2.0e7)) return false;   // NaN, inf, beyond int32 cents
+    const auto c = static_cast<std::int32_t>(std::llround(v * 100.0));
+    if (static_cast<double>(c) / 100.0 != v) return false;
+    cents = c;
+    return true;
+}
+
+/**
+ * @brief The cents range holding exactly the amounts x with lo <= x <= hi.
+ *
+ * Bounds are matched against c / 100.0, so a cents kernel selects the same
+ * rows as the double comparison it replaces.
+ * @return false if no int32 cents value lies in the range.
+ */
+inline bool cents_range(double lo, double hi, std::int32_t& out_lo, std::int32_t& out_hi) {
+    constexpr long long kMin = std::numeric_limits<std::int32_t>::min();
+    constexpr long long kMax = std::numeric_limits<std::int32_t>::max();
+    if (!(lo <= hi)) return false;
+    auto amount = [](long long c) { return static_cast<double>(c) / 100.0; };
+
+    // Smallest c with c / 100 >= lo, and largest with c / 100 <= hi; the
+    // ceil / floor guess is off by at most one either way.
+    long long c_lo = static_cast<long long>(
+        std::ceil(std::clamp(lo * 100.0, double(kMin), kMax + 1.0)));
+    while (c_lo > kMin && amount(c_lo - 1) >= lo) --c_lo;
+    while (c_lo <= kMax && amount(c_lo) < lo) ++c_lo;
+
+    long long c_hi = static_cast<long long>(
+        std::floor(std::clamp(hi * 100.0, kMin - 1.0, double(kMax))));
+    while (c_hi < kMax && amount(c_hi + 1) <= hi) ++c_hi;
+    while (c_hi >= kMin && amount(c_hi) > hi) --c_hi;
+
+    if (c_lo > c_hi) return false;
+    out_lo = static_cast<std::int32_t>(c_lo);
+    out_hi = static_cast<std::int32_t>(c_hi);
+    return true;
+}
+
+/**
+ * @brief A money column stored as int32_t cents, with a double fallback.
+ *
+ * TLC amounts are cents-precision, so as int32_t cents a column is half the
+ * bytes of the double one, filters compare integers (8 lanes per AVX2
+ * register instead of 4), and sums are exact int64 additions whose result
+ * does not depend on how the rows were split across threads.
+ *
+ * A value that is not a whole number of cents (or is beyond +/-2e7) turns
+ * the column back into doubles — one re-encode, never a rounded amount.
+ * Kernels go through visit(), which passes std::span<const int32_t> (cents)
+ * or std::span<const double> (amounts).
+ */
+class MoneyColumn {
+public:
+    MoneyColumn() = default;
+
+    /// fn(std::span<const std::int32_t>) in cents, else fn(std::span<const double>).
+    template <typename Fn>
+    decltype(auto) visit(Fn&& fn) const {
+        if (is_cents_) return fn(std::span<const std::int32_t>(cents_));
+        return fn(std::span<const double>(amounts_));
+    }
+
+    /// Column holding @p values, as cents if every one converts exactly.
+    static MoneyColumn from(std::span<const double> values) {
+        MoneyColumn col;
+        col.cents_.reserve(values.size());
+        for (double v : values) {
+            std::int32_t c;
+            if (!to_cents(v, c)) {
+                col.cents_ = {};
+                col.is_cents_ = false;
+                col.amounts_.assign(values.begin(), values.end());
+                break;
+            }
+            col.cents_.push_back(c);
+        }
+        return col;
+    }
+
+    bool        is_cents() const { return is_cents_; }
+    std::size_t size()  const { return is_cents_ ? cents_.size() : amounts_.size(); }
+    bool        empty() const { return size() == 0; }
+    std::size_t bytes() const {
+        return is_cents_ ? cents_.size() * sizeof(std::int32_t)
+                         : amounts_.size() * sizeof(double);
+    }
+
+    /// The amount in dollars, whatever the storage.
+    double operator[](std::size_t i) const {
+        return is_cents_ ? static_cast<double>(cents_[i]) / 100.0 : amounts_[i];
+    }
+
+    void reserve(std::size_t n) {
+        if (is_cents_) cents_.reserve(n);
+        else           amounts_.reserve(n);
+    }
+
+    /// Append @p amount, switching the column to doubles if it is not cents.
+    void push_back(double amount) {
+        std::int32_t c;
+        if (is_cents_ && to_cents(amount, c)) {
+            cents_.push_back(c);
+            return;
+        }
+        if (is_cents_) to_amounts();
+        amounts_.push_back(amount);
+    }
+
+    /// Equal amounts, whatever the storage.
+    friend bool operator==(const MoneyColumn& a, const MoneyColumn& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+private:
+    // Re-encode as doubles, keeping the reserved capacity.
+    void to_amounts() {
+        amounts_.reserve(std::max(cents_.capacity(), cents_.size() + 1));
+        for (std::int32_t c : cents_) amounts_.push_back(static_cast<double>(c) / 100.0);
+        cents_    = {};
+        is_cents_ = false;
+    }
+
+    bool                      is_cents_ = true;
+    std::vector<std::int32_t> cents_;
+    std::vector<double>       amounts_;
+};
+
+} // namespace taxi
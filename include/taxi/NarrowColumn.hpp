@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace taxi {
+
+/// Bytes per value of a NarrowColumn.
+enum class IntWidth : std::uint8_t {
+    U8  = 1,   ///< uint8_t: every value in [0, 255]
+    U16 = 2,   ///< uint16_t: every value in [0, 65535]
+    I32 = 4    ///< int32_t: anything else
+};
+
+/// "u8", "u16" or "i32".
+inline const char* int_width_name(IntWidth w) {
+    return w == IntWidth::U8 ? "u8" : w == IntWidth::U16 ? "u16" : "i32";
+}
+
+/**
+ * @brief Clamp the inclusive int range [lo, hi] to the values of T.
+ * @return false if no value of T lies in the range.
+ */
+template <typename T>
+bool narrow_range(int lo, int hi, T& out_lo, T& out_hi) {
+    constexpr long long tmin = std::numeric_limits<T>::min();
+    constexpr long long tmax = std::numeric_limits<T>::max();
+    if (lo > hi || hi < tmin || lo > tmax) return false;
+    out_lo = static_cast<T>(std::max<long long>(lo, tmin));
+    out_hi = static_cast<T>(std::min<long long>(hi, tmax));
+    return true;
+}
+
+/**
+ * @brief An int column stored at the narrowest width its values need.
+ *
+ * TLC code columns have tiny domains: vendor, passenger count, rate code and
+ * payment type fit in a byte, the 265 taxi-zone location IDs in two.  A
+ * column holds uint8_t while all its values are in [0, 255], uint16_t while
+ * they are in [0, 65535], and int32_t otherwise.  push_back() of a value the
+ * current width cannot hold widens the whole column (at most twice), so an
+ * outlier costs one re-encode, never a wrong value.
+ *
+ * Kernels go through visit(), which hands them the typed span: a uint16_t
+ * scan reads half the bytes of an int scan and fills twice the SIMD lanes.
+ */
+class NarrowColumn {
+public:
+    NarrowColumn() = default;
+
+    /// fn(std::span<const T>) with T the storage type (uint8_t, uint16_t, int32_t).
+    template <typename Fn>
+    decltype(auto) visit(Fn&& fn) const {
+        switch (width_) {
+            case IntWidth::U8:  return fn(std::span<const std::uint8_t>(u8_));
+            case IntWidth::U16: return fn(std::span<const std::uint16_t>(u16_));
+            default:            return fn(std::span<const std::int32_t>(i32_));
+        }
+    }
+
+    /// Narrowest width that holds every value in [lo, hi].
+    static IntWidth width_for(int lo, int hi) {
+        if (lo >= 0 && hi <= 0xFF)   return IntWidth::U8;
+        if (lo >= 0 && hi <= 0xFFFF) return IntWidth::U16;
+        return IntWidth::I32;
+    }
+
+    /// Column holding @p values at the width their observed range needs.
+    static NarrowColumn from(std::span<const int> values) {
+        NarrowColumn col;
+        if (!values.empty()) {
+            const auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+            col.width_ = width_for(*lo, *hi);
+        }
+        col.visit_mut([&](auto& v) { v.assign(values.begin(), values.end()); });
+        return col;
+    }
+
+    IntWidth    width() const { return width_; }
+    std::size_t size()  const { return visit([](auto v) { return v.size(); }); }
+    bool        empty() const { return size() == 0; }
+    std::size_t bytes() const { return size() * static_cast<std::size_t>(width_); }
+
+    int operator[](std::size_t i) const {
+        return visit([i](auto v) { return static_cast<int>(v[i]); });
+    }
+
+    void reserve(std::size_t n) { visit_mut([n](auto& v) { v.reserve(n); }); }
+    void clear()                { *this = NarrowColumn(); }
+
+    /// Append @p value, widening the column first if it does not fit.
+    void push_back(int value) {
+        if (!fits(value)) widen_to(std::max(width_, width_for(value, value)));
+        visit_mut([value](auto& v) {
+            v.push_back(static_cast<typename std::decay_t<decltype(v)>::value_type>(value));
+        });
+    }
+
+    /// Equal values, whatever the widths.
+    friend bool operator==(const NarrowColumn& a, const NarrowColumn& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+private:
+    template <typename Fn>
+    void visit_mut(Fn&& fn) {
+        switch (width_) {
+            case IntWidth::U8:  fn(u8_);  break;
+            case IntWidth::U16: fn(u16_); break;
+            default:            fn(i32_); break;
+        }
+    }
+
+    bool fits(int value) const {
+        return width_ == IntWidth::I32 ||
+               (value >= 0 && value <= (width_ == IntWidth::U8 ? 0xFF : 0xFFFF));
+    }
+
+    // Re-encode every value at width @p w (wider than the current one),
+    // keeping the reserved capacity.
+    void widen_to(IntWidth w) {
+        std::size_t cap = 0;
+        visit_mut([&](auto& v) { cap = v.capacity(); });
+        NarrowColumn wider;
+        wider.width_ = w;
+        wider.visit_mut([&](auto& dst) {
+            dst.reserve(std::max(cap, size() + 1));
+            visit([&](auto src) { dst.assign(src.begin(), src.end()); });
+        });
+        *this = std::move(wider);
+    }
+
+    IntWidth                   width_ = IntWidth::U8;
+    std::vector<std::uint8_t>  u8_;
+    std::vector<std::uint16_t> u16_;
+    std::vector<std::int32_t>  i32_;
+};
+
+} // namespace taxi
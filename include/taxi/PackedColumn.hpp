@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief One bit per row: bit (row % 64) of word (row / 64).
+ *
+ * The output of PackedColumn::select(); combined predicates AND bitmaps or
+ * test one row with selected().
+ */
+using SelectionBitmap = std::vector<std::uint64_t>;
+
+inline bool selected(const SelectionBitmap& sel, std::size_t row) {
+    return (sel[row >> 6] >> (row & 63)) & 1;
+}
+
+/**
+ * @brief A low-cardinality int column as bit-packed dictionary codes.
+ *
+ * The distinct values form a dictionary; a row stores its value's index in
+ * it, in ceil(log2(distinct)) bits — 1 to 4 for vendor, passenger count,
+ * rate code, payment type and store_and_fwd_flag, and 0 for a column
+ * holding a single value.  from() sorts the dictionary, so a value range is
+ * a code range.
+ *
+ * Codes are bit-sliced: every 64 rows form a group of bits() words, word j
+ * holding bit j of the 64 codes.  select() compares a whole group against
+ * the code range bit-serially (AND / OR / NOT on 64-bit words, most
+ * significant bit first), so a predicate costs a few word operations per
+ * 64 rows and yields a SelectionBitmap with no unpacking.  The loop over
+ * groups is plain word arithmetic, which the compiler vectorises.
+ *
+ * push_back() appends a value not yet in the dictionary as the next code,
+ * so existing rows keep theirs; only when the dictionary outgrows
+ * 2^bits() does every group get one more (all-zero) word.  A value appended
+ * out of order can leave the codes of a range non-contiguous; select() then
+ * ORs one equality mask per matching code instead.
+ */
+class PackedColumn {
+public:
+    PackedColumn() = default;
+
+    /// Column holding @p values, with the dictionary of their distinct values.
+    template <typename T>
+    static PackedColumn from(std::span<const T> values) {
+        PackedColumn col;
+        col.dict_.assign(values.begin(), values.end());
+        std::sort(col.dict_.begin(), col.dict_.end());
+        col.dict_.erase(std::unique(col.dict_.begin(), col.dict_.end()), col.dict_.end());
+        col.bits_ = bits_for(col.dict_.size());
+        col.words_.reserve(groups(values.size()) * col.bits_);
+        for (T v : values) col.append_code(col.code_of(v));
+        return col;
+    }
+
+    std::size_t size()  const { return n_; }
+    bool        empty() const { return n_ == 0; }
+    unsigned    bits()  const { return bits_; }
+    std::size_t bytes() const {
+        return words_.size() * sizeof(std::uint64_t) + dict_.size() * sizeof(int);
+    }
+    /// The distinct values in code order (sorted after from(), new values
+    /// appended by push_back()); code i stands for dictionary()[i].
+    std::span<const int> dictionary() const { return dict_; }
+
+    int operator[](std::size_t i) const { return dict_[code(i)]; }
+
+    void reserve(std::size_t n) { words_.reserve(groups(n) * std::max(bits_, 1u)); }
+
+    /// Append @p value; a value new to the dictionary gets the next code.
+    void push_back(int value) {
+        // A linear search: the dictionary holds a handful of values.
+        const auto c = static_cast<std::uint32_t>(
+            std::find(dict_.begin(), dict_.end(), value) - dict_.begin());
+        if (c == dict_.size()) {
+            dict_.push_back(value);
+            widen(bits_for(dict_.size()));
+        }
+        append_code(c);
+    }
+
+    /**
+     * @brief Rows with lo <= value <= hi, as a bitmap of size() bits.
+     *
+     * When the matching codes are one range [c_lo, c_hi] (always, after
+     * from()), a bit-serial range compare per group of 64 rows: track
+     * "code < c_lo" and "code > c_hi" from the most significant bit down,
+     * then keep the rows that are neither.  Otherwise an OR of one
+     * bit-serial equality test per matching code.
+     */
+    SelectionBitmap select(int lo, int hi) const {
+        SelectionBitmap sel(groups(n_), 0);
+        std::vector<std::uint32_t> codes;
+        for (std::uint32_t c = 0; c < dict_.size(); ++c)
+            if (dict_[c] >= lo && dict_[c] <= hi) codes.push_back(c);
+        if (codes.empty()) return sel;
+
+        const auto [c_min, c_max] = std::minmax_element(codes.begin(), codes.end());
+        if (*c_max - *c_min + 1 == codes.size()) select_range(*c_min, *c_max, sel);
+        else                                      select_codes(codes, sel);
+        if (n_ & 63) sel.back() &= (std::uint64_t{1} << (n_ & 63)) - 1;
+        return sel;
+    }
+
+    friend bool operator==(const PackedColumn& a, const PackedColumn& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+private:
+    static std::size_t groups(std::size_t n) { return (n + 63) / 64; }
+    static unsigned bits_for(std::size_t distinct) {
+        return distinct <= 1 ? 0u : static_cast<unsigned>(std::bit_width(distinct - 1));
+    }
+
+    // sel[g] = rows of group g whose code is in [c_lo, c_hi].
+    void select_range(std::uint32_t c_lo, std::uint32_t c_hi, SelectionBitmap& sel) const {
+        const unsigned b = bits_;
+        const std::uint64_t* w = words_.data();
+        const auto ngroups = static_cast<std::ptrdiff_t>(sel.size());
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t g = 0; g < ngroups; ++g) {
+            const std::uint64_t* gw = w + static_cast<std::size_t>(g) * b;
+            std::uint64_t below = 0, eq_lo = ~std::uint64_t{0};
+            std::uint64_t above = 0, eq_hi = ~std::uint64_t{0};
+            for (unsigned j = b; j-- > 0;) {
+                const std::uint64_t x = gw[j];
+                if ((c_lo >> j) & 1) { below |= eq_lo & ~x; eq_lo &= x;  }
+                else                 {                      eq_lo &= ~x; }
+                if ((c_hi >> j) & 1) {                      eq_hi &= x;  }
+                else                 { above |= eq_hi & x;  eq_hi &= ~x; }
+            }
+            sel[g] = ~(below | above);
+        }
+    }
+
+    // sel[g] = rows of group g whose code is one of @p codes.
+    void select_codes(const std::vector<std::uint32_t>& codes, SelectionBitmap& sel) const {
+        const unsigned b = bits_;
+        const std::uint64_t* w = words_.data();
+        const std::uint32_t* cs = codes.data();
+        const std::size_t    nc = codes.size();
+        const auto ngroups = static_cast<std::ptrdiff_t>(sel.size());
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t g = 0; g < ngroups; ++g) {
+            const std::uint64_t* gw = w + static_cast<std::size_t>(g) * b;
+            std::uint64_t any = 0;
+            for (std::size_t k = 0; k < nc; ++k) {
+                std::uint64_t eq = ~std::uint64_t{0};
+                for (unsigned j = 0; j < b; ++j)
+                    eq &= ((cs[k] >> j) & 1) ? gw[j] : ~gw[j];
+                any |= eq;
+            }
+            sel[g] = any;
+        }
+    }
+
+    // Give every group @p bits words; the added high bits of existing codes
+    // are 0, so no code is decoded.  Groups move back to front in place.
+    void widen(unsigned bits) {
+        if (bits <= bits_) return;
+        const std::size_t ng = groups(n_);
+        words_.resize(ng * bits);
+        for (std::size_t g = ng; g-- > 0;) {
+            std::uint64_t* from = words_.data() + g * bits_;
+            std::uint64_t* to   = words_.data() + g * bits;
+            std::copy_backward(from, from + bits_, to + bits_);
+            std::fill(to + bits_, to + bits, 0);
+        }
+        bits_ = bits;
+    }
+
+    template <typename T>
+    std::uint32_t code_of(T v) const {
+        return static_cast<std::uint32_t>(
+            std::lower_bound(dict_.begin(), dict_.end(), static_cast<int>(v)) - dict_.begin());
+    }
+
+    std::uint32_t code(std::size_t i) const {
+        const std::uint64_t* gw = words_.data() + (i >> 6) * bits_;
+        std::uint32_t c = 0;
+        for (unsigned j = 0; j < bits_; ++j)
+            c |= static_cast<std::uint32_t>((gw[j] >> (i & 63)) & 1) << j;
+        return c;
+    }
+
+    void append_code(std::uint32_t c) {
+        if ((n_ & 63) == 0) words_.resize(words_.size() + bits_, 0);
+        std::uint64_t* gw = words_.data() + (n_ >> 6) * bits_;
+        for (unsigned j = 0; j < bits_; ++j)
+            gw[j] |= static_cast<std::uint64_t>((c >> j) & 1) << (n_ & 63);
+        ++n_;
+    }
+
+    std::vector<int>           dict_;       ///< distinct values, in code order
+    std::vector<std::uint64_t> words_;      ///< bits_ words per 64-row group
+    unsigned                   bits_ = 0;   ///< bits per code
+    std::size_t                n_    = 0;
+};
+
+} // namespace taxi
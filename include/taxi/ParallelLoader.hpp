@@ -2,7 +2,9 @@
 
 #include "taxi/TripRecord.hpp"
 #include "taxi/CsvReader.hpp"
+#include "taxi/TripDataSoA.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstddef>
 
@@ -11,34 +13,112 @@ namespace taxi {
 /**
  * @brief Parallel CSV loader using std::thread.
  *
- * Splits the CSV file into N byte-range chunks and dispatches one
- * std::thread per chunk.  Each thread runs an independent CsvReader on
- * its slice; results are merged after all threads join.
+ * Maps each CSV file once and cuts it into many small newline-aligned
+ * morsels (default 8 MB).  A fixed pool of N threads pulls morsels from a
+ * shared atomic cursor until none are left, so a thread that lands on slow
+ * pages or long rows simply takes fewer morsels instead of holding up the
+ * whole load.
+ *
+ * Morsels are handled in waves of 4 x N: each is parsed by a CsvReader over
+ * its slice of the mapping into a thread-local buffer, row counts are
+ * prefix-summed, and every buffer is copied straight to its final rows of an
+ * output reserved up front from a line count.  Rows come out in file order
+ * exactly as a serial load would produce them, and only one wave of buffers
+ * exists at a time.  load() fills an AoS vector, load_soa() the SoA columns
+ * (Phase 3b).  Each file's header is read once into a ColumnMap shared by
+ * its morsels.
+ *
+ * Plain files are only mapped, so any number of them are parsed as one
+ * group into a single reservation.  A gzip / zstd file is decompressed into
+ * memory, members or frames in parallel (decompress_parallel), parsed, and
+ * its decoded text freed before the next file is decompressed: peak memory
+ * is the output plus one file's decompressed size, and the output grows
+ * once per compressed file.
  *
  * Parallel CSV parsing implementation (Phase 2).
  */
 class ParallelLoader {
 public:
     struct Result {
-        std::vector<TripRecord> records;
+        TripRecords records;
 
         // Aggregate parse statistics across all threads
         std::size_t total_rows_read      = 0;
         std::size_t total_rows_parsed    = 0;
         std::size_t total_rows_discarded = 0;
+        std::size_t timestamp_cache_hits   = 0;
+        std::size_t timestamp_cache_misses = 0;
 
         double load_time_ms = 0.0;   // wall-clock time for the parallel load
         int    threads_used = 0;
+        std::size_t morsels = 0;     // number of work units the file was cut into
+    };
+
+    struct SoAResult {
+        TripDataSoA data;
+
+        std::size_t total_rows_read      = 0;
+        std::size_t total_rows_parsed    = 0;
+        std::size_t total_rows_discarded = 0;
+        std::size_t timestamp_cache_hits   = 0;
+        std::size_t timestamp_cache_misses = 0;
+
+        double load_time_ms = 0.0;
+        int    threads_used = 0;
+        std::size_t morsels = 0;
     };
 
+    /// Default morsel size: large enough to amortize per-morsel setup, small
+    /// enough that a 1-2 GB file yields hundreds of units to balance.
+    static constexpr std::size_t kDefaultMorselBytes = std::size_t{8} << 20;
+
     /**
      * @brief Load a CSV file using N parallel threads.
      *
-     * @param path        Path to the TLC taxi CSV file.
-     * @param num_threads Number of threads to use (clamped to >= 1).
+     * @param path         Path to the TLC taxi CSV file.
+     * @param num_threads  Number of threads to use (clamped to >= 1).
+     * @param morsel_bytes Target morsel size; each morsel is extended to the
+     *                     next newline.
      * @return Result struct with records, stats, and timing.
      */
-    static Result load(const std::string& path, int num_threads);
+    static Result load(const std::string& path, int num_threads,
+                       std::size_t morsel_bytes = kDefaultMorselBytes);
+
+    /**
+     * @brief Load several CSV files, concatenated in order, into one Result.
+     *
+     * All files share one morsel queue and one output vector, so multi-file
+     * loads need no per-file results and no second concatenation.
+     */
+    static Result load(const std::vector<std::string>& paths, int num_threads,
+                       std::size_t morsel_bytes = kDefaultMorselBytes);
+
+    /**
+     * @brief Load one or more CSV files straight into SoA columns in parallel.
+     *
+     * Files are concatenated in order and rows come out exactly as
+     * TripDataSoA::from_csv() would produce them.  Workers parse into
+     * per-morsel column buffers that are copied to their final rows.
+     *
+     * @param paths        CSV files, concatenated in order.
+     * @param num_threads  Number of threads to use (clamped to >= 1).
+     * @param morsel_bytes Target morsel size.
+     * @param columns      Columns to load; other fields are skipped by the
+     *                     tokenizer and their vectors never allocated.
+     */
+    static SoAResult load_soa(const std::vector<std::string>& paths, int num_threads,
+                              std::size_t morsel_bytes = kDefaultMorselBytes,
+                              ColumnSet columns = ColumnSet::all());
+
+    /**
+     * @brief Split @p bytes (the file without its header) into morsels.
+     *
+     * @return Boundaries b[0]=0 < b[1] < ... < b[n]=bytes.size(); morsel i
+     *         is [b[i], b[i+1]).  Every interior boundary is the first byte
+     *         of a line.
+     */
+    static std::vector<std::size_t> split_morsels(std::string_view bytes,
+                                                  std::size_t morsel_bytes);
 };
 
 } // namespace taxi
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "taxi/TripDataSoA.hpp"
+#include "taxi/SoAQueryEngine.hpp"
+#include "taxi/QueryTypes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief Trips split into one TripDataSoA per calendar month of pickup
+ *        (UTC), each with its own SoAQueryEngine.
+ *
+ * A monolithic table scans every year for every query and sorts all rows
+ * into one time index.  Here each month is a partition with its own columns,
+ * time index and zone maps, plus its pickup-time range as statistics.
+ * Queries with a time predicate (Q1, Q5, Q6) go only to the partitions whose
+ * range overlaps it; the others (Q2-Q4) to all of them.  The partitions of a
+ * query run in parallel (OpenMP, one partition per thread; a query that
+ * reaches a single partition runs it with the usual parallel scan), and the
+ * results are concatenated.
+ *
+ * Rows are numbered across the dataset: partition by partition in month
+ * order, rows of a month in load order.  locate() maps a result row back to
+ * its partition.  Adding rows renumbers the months after them.
+ *
+ * Index builds are per partition and incremental: add() creates or extends
+ * only the months its rows fall in, and build_indexes() then sorts just
+ * those.
+ */
+class PartitionedDataset {
+public:
+    /// One month of trips.
+    struct Partition {
+        int            month;      ///< year * 12 + (month - 1)
+        std::size_t    offset;     ///< dataset row of its first row
+        std::int64_t   min_pickup; ///< pickup-time range of its rows
+        std::int64_t   max_pickup;
+        TripDataSoA    data;
+        SoAQueryEngine engine;     ///< over @c data
+
+        Partition(int m, TripDataSoA&& rows);
+        Partition(const Partition&) = delete;   // engine refers to data
+        Partition& operator=(const Partition&) = delete;
+    };
+
+    PartitionedDataset() = default;
+
+    /// Split a loaded table into months; its columns are freed as they are
+    /// moved (TripDataSoA::split).  Indexes are not built yet.
+    static PartitionedDataset from_soa(TripDataSoA&& soa);
+
+    /**
+     * @brief Add rows, e.g. a newly loaded month.
+     *
+     * Rows of a month not seen before form a new partition; rows of an
+     * existing month are appended to it, which drops its index.
+     * @throws std::runtime_error if @p rows store other columns than the
+     *         dataset, or do not store pickup_timestamp.
+     */
+    void add(TripDataSoA&& rows);
+
+    /// Build the index of every partition that has none, in parallel.
+    /// Returns build time in milliseconds.
+    double build_indexes();
+
+    std::size_t size()       const { return rows_; }
+    std::size_t partitions() const { return parts_.size(); }
+    const Partition& partition(std::size_t p) const { return *parts_[p]; }
+
+    /// The partition holding dataset row @p row, and the row's index in it.
+    std::pair<const Partition*, std::size_t> locate(std::size_t row) const;
+
+    /// Month key (year * 12 + month - 1) of a Unix timestamp.
+    static int month_of(std::int64_t ts);
+
+    // ---- Same queries as SoAQueryEngine; indices are dataset rows ----
+    SoAQueryResult search_by_time(const TimeRangeQuery& q) const;
+    SoAQueryResult search_by_distance(const NumericRangeQuery& q) const;
+    SoAQueryResult search_by_fare(const NumericRangeQuery& q) const;
+    SoAQueryResult search_by_location(const IntRangeQuery& q) const;
+    SoAQueryResult search_combined(const CombinedQuery& q) const;
+    AggregationResult aggregate_fare_by_time(const TimeRangeQuery& q) const;
+
+private:
+    /// Partitions whose pickup range overlaps [start, end].
+    std::vector<const Partition*> overlapping(std::int64_t start, std::int64_t end) const;
+    std::vector<const Partition*> all() const;
+
+    /// run(engine) on each partition, in parallel; one result per partition.
+    template <typename Run>
+    static auto fan_out(const std::vector<const Partition*>& parts, Run run);
+
+    /// Per-partition results as one, row ids made dataset rows.
+    static SoAQueryResult concat(const std::vector<const Partition*>& parts,
+                                 const std::vector<SoAQueryResult>& results);
+
+    void renumber();
+
+    std::vector<std::unique_ptr<Partition>> parts_;  ///< by month
+    ColumnSet   columns_ = ColumnSet::all();
+    std::size_t rows_    = 0;
+};
+
+} // namespace taxi
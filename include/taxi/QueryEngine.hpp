@@ -1,28 +1,40 @@
 #pragma once
 
 #include "taxi/TripRecord.hpp"
+#include "taxi/HotColdTrips.hpp"
 #include "taxi/QueryTypes.hpp"
 #include "taxi/TimeIndex.hpp"
+#include <span>
 #include <vector>
 
 namespace taxi {
 
-class QueryEngine {
+/**
+ * @brief Phase 1/2 query engine over an array of records.
+ *
+ * Record is TripRecord (QueryEngine, the plain AoS layout) or TripHot
+ * (HotColdQueryEngine, the hot half of a HotColdTrips): the same scans, over
+ * 128-byte or 40-byte structs.  Results point into the array.
+ */
+template <typename Record>
+class BasicQueryEngine {
 public:
-    explicit QueryEngine(const std::vector<TripRecord>& data);
+    using Result = BasicQueryResult<Record>;
+
+    explicit BasicQueryEngine(std::span<const Record> data);
 
     // Build indexes (call after data is fully loaded).
     // Returns build time in milliseconds.
     double build_indexes();
 
     // ---- Single-field range searches (Queries 1-4) ----
-    QueryResult search_by_time(const TimeRangeQuery& q) const;
-    QueryResult search_by_distance(const NumericRangeQuery& q) const;
-    QueryResult search_by_fare(const NumericRangeQuery& q) const;
-    QueryResult search_by_location(const IntRangeQuery& q) const;
+    Result search_by_time(const TimeRangeQuery& q) const;
+    Result search_by_distance(const NumericRangeQuery& q) const;
+    Result search_by_fare(const NumericRangeQuery& q) const;
+    Result search_by_location(const IntRangeQuery& q) const;
 
     // ---- Multi-predicate search (Query 5) ----
-    QueryResult search_combined(const CombinedQuery& q) const;
+    Result search_combined(const CombinedQuery& q) const;
 
     // ---- Aggregation (Query 6) ----
     AggregationResult aggregate_fare_by_time(const TimeRangeQuery& q) const;
@@ -31,8 +43,12 @@ public:
     bool indexes_built() const { return time_index_.is_built(); }
 
 private:
-    const std::vector<TripRecord>& data_;
+    std::span<const Record> data_;
     TimeIndex time_index_;
 };
 
+using QueryEngine        = BasicQueryEngine<TripRecord>;
+/// Scans only the hot array of a HotColdTrips: HotColdQueryEngine(trips.hot).
+using HotColdQueryEngine = BasicQueryEngine<TripHot>;
+
 } // namespace taxi
@@ -32,11 +32,16 @@ struct CombinedQuery {
 
 // ---- Result types ----
 
-struct QueryResult {
-    std::vector<const TripRecord*> records;
+// Pointers into the engine's record array (TripRecord, or TripHot for the
+// hot/cold layout).
+template <typename Record>
+struct BasicQueryResult {
+    std::vector<const Record*> records;
     std::size_t scanned = 0;   // how many records were examined
 };
 
+using QueryResult = BasicQueryResult<TripRecord>;
+
 struct AggregationResult {
     double sum   = 0.0;
     double avg   = 0.0;
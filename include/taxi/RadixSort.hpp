@@ -0,0 +1,96 @@
+#pragma once
+
+#include "taxi/HugePages.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace taxi {
+
+/// A sort key and the row it belongs to.  K is uint32_t when both the key
+/// range and the row count fit in 32 bits (8-byte pairs), else uint64_t.
+template <typename K>
+struct KeyRow {
+    K key;
+    K row;
+};
+
+/**
+ * @brief Stable parallel LSD radix sort of @p pairs by their low @p key_bits
+ *        key bits.
+ *
+ * One pass per digit of up to 11 bits.  Each OpenMP thread counts the digits of its
+ * static slice of the input, the counts are prefix-summed digit by digit
+ * and thread by thread, and each thread scatters its slice to the offsets
+ * so found: stable, with no atomics or locks.  A pass where all keys share
+ * the digit is skipped.  Each pass reads and writes the pairs once, so the
+ * sort runs at memory bandwidth rather than paying log n dependent
+ * comparisons per row.
+ */
+void radix_sort(HugeVector<KeyRow<std::uint32_t>>& pairs, unsigned key_bits);
+void radix_sort(HugeVector<KeyRow<std::uint64_t>>& pairs, unsigned key_bits);
+
+template <typename K, typename Key>
+void radix_sort_rows_as(std::size_t n, Key key, std::int64_t min_key, unsigned key_bits,
+                        std::size_t* out)
+{
+    HugeVector<KeyRow<K>> pairs;
+    pairs.resize(n);   // not zero-filled: written below
+    KeyRow<K>* p = pairs.data();
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i)
+        p[i] = {static_cast<K>(static_cast<std::uint64_t>(key(i)) -
+                               static_cast<std::uint64_t>(min_key)),
+                static_cast<K>(i)};
+
+    radix_sort(pairs, key_bits);
+
+    p = pairs.data();
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) out[i] = static_cast<std::size_t>(p[i].row);
+}
+
+/**
+ * @brief Write rows 0 .. n-1 to @p out ordered by key(row), an int64_t such
+ *        as a pickup timestamp; equal keys stay in row order.
+ *
+ * The keys are range-reduced (key - min): a span of under 2^32 seconds,
+ * about 136 years, sorts as 8-byte (uint32_t key, uint32_t row) pairs in at
+ * most three passes; keys already in order skip the sort.  key(row) is
+ * called from OpenMP threads, up to three times per row.
+ */
+template <typename Key>
+void radix_sort_rows(std::size_t n, Key key, std::size_t* out)
+{
+    if (n == 0) return;
+    std::int64_t lo = std::numeric_limits<std::int64_t>::max();
+    std::int64_t hi = std::numeric_limits<std::int64_t>::min();
+    std::size_t  descents = 0;
+    #pragma omp parallel for reduction(min:lo) reduction(max:hi) reduction(+:descents) \
+        schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::int64_t k = key(i);
+        lo = std::min(lo, k);
+        hi = std::max(hi, k);
+        descents += i > 0 && k < key(i - 1);
+    }
+
+    // Already in key order (a file written in time order): the identity.
+    if (descents == 0) {
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < n; ++i) out[i] = i;
+        return;
+    }
+
+    const auto bits = static_cast<unsigned>(
+        std::bit_width(static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo)));
+
+    if (bits <= 32 && n <= std::numeric_limits<std::uint32_t>::max())
+        radix_sort_rows_as<std::uint32_t>(n, key, lo, bits, out);
+    else
+        radix_sort_rows_as<std::uint64_t>(n, key, lo, bits, out);
+}
+
+} // namespace taxi
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "taxi/TripDataSoA.hpp"
+#include "taxi/CsvReader.hpp"
+#include "taxi/HugePages.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief Versioned binary columnar snapshot of a loaded TripDataSoA.
+ *
+ * Saves the stored columns, the SoAQueryEngine time index and the parse
+ * statistics of a load, so a restart reads them back at disk bandwidth
+ * instead of re-parsing the CSVs and re-sorting the index.
+ *
+ * Layout (little-endian):
+ *
+ *     header   64 B   magic "TAXISNAP", version, byte-order mark, rows,
+ *                     column bits, size + checksum of the metadata,
+ *                     checksum of the header itself
+ *     metadata        parse stats, source fingerprints, section table
+ *                     (id, element size, offset, bytes, checksum)
+ *     sections        one per stored column, then the time index (u64
+ *                     row ids); each starts on a 4 KB boundary
+ *
+ * Every section carries a 64-bit xxHash64-style checksum, verified on load
+ * by default.  Sections are page-aligned so map() can hand them out as
+ * column views without copying.  Each source CSV is fingerprinted by path, size and mtime;
+ * is_stale() reports a snapshot whose sources have since changed.
+ * save() writes to a temporary file and renames it into place, so a crash
+ * never leaves a truncated snapshot behind.
+ */
+class Snapshot {
+public:
+    static constexpr std::uint32_t kVersion = 1;
+
+    /// One source CSV as it was when the snapshot was taken.
+    struct SourceFile {
+        std::string   path;
+        std::uint64_t size     = 0;
+        std::int64_t  mtime_ns = 0;
+
+        bool operator==(const SourceFile&) const = default;
+    };
+
+    /// Everything a snapshot restores.
+    struct Contents {
+        TripDataSoA              data;
+        RowIndex                 time_index;   ///< empty if none was saved
+        CsvReader::Stats         stats;
+        std::vector<SourceFile>  sources;
+        std::uint64_t            bytes = 0;    ///< snapshot file size
+    };
+
+    /// Fingerprints of @p paths as they are on disk now.
+    static std::vector<SourceFile> fingerprint(const std::vector<std::string>& paths);
+
+    /**
+     * @brief Write @p data (its stored columns), @p time_index and @p stats.
+     * @param time_index Row ids sorted by pickup time, or empty.
+     * @return Bytes written.
+     * @throws std::runtime_error on an I/O error, or if @p time_index is
+     *         neither empty nor data.size() long.
+     */
+    static std::uint64_t save(const std::string& path, const TripDataSoA& data,
+                              const RowIndex& time_index,
+                              const CsvReader::Stats& stats,
+                              const std::vector<SourceFile>& sources);
+
+    /**
+     * @brief Read a snapshot back.
+     * @param verify Check every section's checksum (one extra pass over
+     *               data already in cache).
+     * @throws std::runtime_error if the file is missing, not a snapshot, of
+     *         another version or byte order, truncated, or corrupt.
+     */
+    static Contents load(const std::string& path, bool verify = true);
+
+    /**
+     * @brief Map a snapshot instead of reading it: the columns of the
+     *        returned table are copy-on-write views of the file (ColumnData)
+     *        and are paged in by the kernel as queries touch them.  Only the
+     *        header, metadata and time index are read up front.
+     * @param verify Check every section's checksum, which reads the whole
+     *               file; off by default so unused columns stay on disk.
+     * @throws std::runtime_error as load().
+     */
+    static Contents map(const std::string& path, bool verify = false);
+
+    /// Whether @p path starts with the snapshot magic.
+    static bool is_snapshot(const std::string& path);
+
+    /// Whether a recorded source still exists but no longer matches its
+    /// fingerprint.  Sources that are gone (archived) do not count.
+    static bool is_stale(const Contents& snapshot);
+};
+
+} // namespace taxi
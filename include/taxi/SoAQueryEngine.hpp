@@ -1,7 +1,10 @@
 #pragma once
 
 #include "taxi/TripDataSoA.hpp"
+#include "taxi/CompactSoA.hpp"
+#include "taxi/HugePages.hpp"
 #include "taxi/QueryTypes.hpp"
+#include "taxi/ZoneMap.hpp"
 #include <cstddef>
 #include <cstdint>
 #include <utility>
@@ -18,7 +21,7 @@ namespace taxi {
  */
 struct SoAQueryResult {
     std::vector<std::size_t> indices;   ///< matching row indices into the SoA arrays
-    std::size_t              scanned = 0; ///< number of rows examined (for analysis)
+    std::size_t              scanned = 0; ///< number of rows whose values were read (for analysis)
 };
 
 /**
@@ -29,21 +32,65 @@ struct SoAQueryResult {
  * Key performance advantages over AoS QueryEngine:
  *  - Q2 (distance scan): reads only data_.trip_distance[] — 8 doubles per
  *    64-byte cache line vs. 0.5 TripRecords (128 B struct) in AoS.
- *  - Q3 (fare scan): reads only data_.total_amount[].
- *  - Q4 (location scan): reads only data_.pu_location_id[] (4-byte ints).
+ *  - Q3 (fare scan): reads only data_.total_amount[] (or int32 cents).
+ *  - Q4 (location scan): reads only data_.pu_location_id[] (4-byte ints, or
+ *    2-byte ones from a CompactTripDataSoA).
  *  - Q5 (combined): each predicate array is accessed independently; the CPU
  *    prefetcher sees stride-1 access on typed arrays.
  *  - Q6 (aggregation): reduction over data_.fare_amount[] — fully vectorisable.
  *  - All scans parallelised with OpenMP (same as Phase 2 QueryEngine).
+ *
+ * Each query madvise()s the columns it reads (ColumnData::advise): scans ask
+ * for sequential read-ahead, the index binary search for none.  This only
+ * matters for columns mapped from a snapshot, which page in on first touch.
+ *
+ * Built from a CompactTripDataSoA, the queries read the compact columns:
+ * Q4 compares uint16_t locations, Q5 turns the passenger predicate into a
+ * selection bitmap computed on the bit-packed codes, Q3 filters int32 cents
+ * and Q6 sums them in int64 (an exact sum, identical for every
+ * OMP_NUM_THREADS).  The time index is built and searched over the
+ * frame-of-reference pickup times, decoding only the rows it probes; without
+ * an index, Q1 and Q6 skip whole blocks outside the time range.  Other
+ * columns are read from @c wide as usual.
+ *
+ * Index building also summarises every column in a ZoneMap.  Q2, Q3 and Q4
+ * consult it per block of 4096 rows: blocks whose min / max miss the range
+ * are skipped, blocks inside it are taken without being read, and only the
+ * others are compared row by row.  SoAQueryResult::scanned counts the rows
+ * compared, so it shows how much a query was pruned.
+ *
+ * On a table clustered by TripDataSoA::cluster_by_time() no index is built:
+ * a time range is found by binary search on the pickup column itself and is
+ * a slice of rows, so Q1 returns the slice and Q5 / Q6 scan it stride-1.
+ * Clustered by day and location, the slice holds whole days and its rows
+ * are still compared against the time range.
  */
 class SoAQueryEngine {
 public:
     explicit SoAQueryEngine(const TripDataSoA& data);
+    /// Query a compact table; it must outlive the engine, like @p data above.
+    explicit SoAQueryEngine(const CompactTripDataSoA& data);
 
-    /// Build the time-sorted index.  Must be called before queries.
-    /// Returns build time in milliseconds.
+    /// Build the time-sorted index (none for a time-clustered table) and the
+    /// zone maps.  Must be called before queries.  Returns build time in
+    /// milliseconds.
     double build_indexes();
 
+    /// Adopt a time index saved earlier (Snapshot) instead of sorting;
+    /// the zone maps are still built.
+    /// @throws std::runtime_error if its size does not match the data.
+    void restore_indexes(RowIndex time_index);
+
+    /// Row ids sorted by pickup time (empty before the index is built, and
+    /// for a time-clustered table).
+    const RowIndex& time_index() const { return time_sorted_idx_; }
+
+    /// Row order the time queries rely on instead of the index.
+    TimeClustering time_clustering() const { return clustered_; }
+
+    /// Per-block column summaries (empty before the index is built).
+    const ZoneMap& zone_map() const { return zones_; }
+
     // ---- Single-field range searches (Q1-Q4) ----
     SoAQueryResult search_by_time(const TimeRangeQuery& q) const;
     SoAQueryResult search_by_distance(const NumericRangeQuery& q) const;
@@ -60,13 +107,42 @@ public:
     std::size_t size()          const { return data_.size(); }
 
 private:
-    const TripDataSoA&       data_;
-    std::vector<std::size_t> time_sorted_idx_; ///< row indices sorted by pickup_timestamp
-    bool                     indexed_ = false;
+    const TripDataSoA&        data_;
+    const CompactTripDataSoA* compact_ = nullptr;  ///< narrow int columns, if any
+    RowIndex                  time_sorted_idx_; ///< row indices sorted by pickup_timestamp
+    ZoneMap                   zones_;           ///< per-block min / max of every column
+    TimeClustering            clustered_ = TimeClustering::None;  ///< rows in time order: no index
+    bool                      indexed_ = false;
+
+    void build_zone_maps() { zones_ = compact_ ? ZoneMap::build(*compact_) : ZoneMap::build(data_); }
 
     /// Binary-search the sorted index; returns [lo, hi) position range.
     std::pair<std::size_t, std::size_t>
     time_lookup(std::int64_t start, std::int64_t end) const;
+
+    /// Rows [lo, hi) of a clustered table that can hold a pickup time in
+    /// [start, end]: exactly those for Pickup, whole days for DayLocation.
+    std::pair<std::size_t, std::size_t>
+    time_slice(std::int64_t start, std::int64_t end) const;
+
+    /// Whether every row of time_slice() is in the time range.
+    bool slice_exact() const { return clustered_ == TimeClustering::Pickup; }
+
+    // fn(ts) with ts[row] the pickup time: the int64 column, or for a
+    // compact table its TimestampColumn::Reader.
+    template <typename Fn>
+    decltype(auto) with_pickup(Fn&& fn) const {
+        if (compact_) return compact_->pickup_timestamp.visit(fn);
+        return fn(data_.pickup_timestamp.data());
+    }
+
+    /// Q5 with the passenger predicate as pax(row) -> bool.
+    template <typename PaxMatch>
+    SoAQueryResult search_combined(const CombinedQuery& q, PaxMatch pax) const;
+
+    /// Q6 over a fare_amount column of element type T (double, or int32 cents).
+    template <typename T>
+    AggregationResult aggregate_fare_by_time(const TimeRangeQuery& q, const T* fare) const;
 };
 
 } // namespace taxi
@@ -1,32 +1,36 @@
 #pragma once
 
 #include "taxi/TripRecord.hpp"
-#include <vector>
+#include "taxi/HugePages.hpp"
+#include <span>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
 
 namespace taxi {
 
+// Record is TripRecord or TripHot (anything with a pickup_timestamp).
 class TimeIndex {
 public:
     TimeIndex() = default;
 
-    void build(const std::vector<TripRecord>& records);
+    template <typename Record>
+    void build(std::span<const Record> records);
 
     // Return [begin_idx, end_idx) into indices_ for the given time range.
+    template <typename Record>
     std::pair<std::size_t, std::size_t> lookup(
-        const std::vector<TripRecord>& records,
+        std::span<const Record> records,
         std::int64_t start_time,
         std::int64_t end_time
     ) const;
 
-    const std::vector<std::size_t>& sorted_indices() const { return indices_; }
+    const RowIndex& sorted_indices() const { return indices_; }
     bool is_built() const { return built_; }
     std::size_t size() const { return indices_.size(); }
 
 private:
-    std::vector<std::size_t> indices_;
+    RowIndex indices_;
     bool built_ = false;
 };
 
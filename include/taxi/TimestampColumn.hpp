@@ -0,0 +1,219 @@
+#pragma once
+
+#include "taxi/NarrowColumn.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief An int64 timestamp column, frame-of-reference encoded in blocks.
+ *
+ * Rows are grouped in blocks of kBlockRows.  Each block keeps its minimum
+ * (the base) and its span; a row stores only a uint32_t offset from the
+ * base.  Rows loaded in file order are close in time, so a block spans
+ * minutes and the column is 4 bytes a row instead of 8 (plus 12 bytes per
+ * block).  A block spanning more than 2^32 seconds (136 years) turns the
+ * column back into plain int64 — one re-encode, never a wrong value.
+ *
+ * Kernels go through visit(), which passes a Reader (encoded) or a
+ * const int64_t* (plain); both index as ts[row].  A Reader also exposes the
+ * blocks: block_range() turns a time range into an offset range, so range
+ * filters skip disjoint blocks outright and compare 4-byte offsets, without
+ * decoding, in the rest.
+ */
+class TimestampColumn {
+public:
+    static constexpr unsigned    kBlockShift = 10;
+    static constexpr std::size_t kBlockRows  = std::size_t{1} << kBlockShift;
+
+    /// Read access to an encoded column.
+    struct Reader {
+        const std::int64_t*  base;
+        const std::uint32_t* span;
+        const std::uint32_t* offsets;
+        std::size_t          blocks;
+
+        std::int64_t operator[](std::size_t i) const {
+            return base[i >> kBlockShift] + offsets[i];
+        }
+
+        /**
+         * @brief Offsets [lo, hi] of block @p b whose time is in [start, end].
+         * @return false if the block holds no such time.
+         */
+        bool block_range(std::size_t b, std::int64_t start, std::int64_t end,
+                         std::uint32_t& lo, std::uint32_t& hi) const {
+            const std::int64_t first = base[b];
+            const std::int64_t last  = first + span[b];
+            if (start > end || end < first || start > last) return false;
+            lo = static_cast<std::uint32_t>(std::max(start, first) - first);
+            hi = static_cast<std::uint32_t>(std::min(end, last) - first);
+            return true;
+        }
+    };
+
+    TimestampColumn() = default;
+
+    /// fn(Reader) if encoded, else fn(const std::int64_t*).
+    template <typename Fn>
+    decltype(auto) visit(Fn&& fn) const {
+        if (encoded_)
+            return fn(Reader{base_.data(), span_.data(), offsets_.data(), base_.size()});
+        return fn(static_cast<const std::int64_t*>(plain_.data()));
+    }
+
+    /// Column holding @p values, encoded unless a block spans too long.
+    static TimestampColumn from(std::span<const std::int64_t> values) {
+        TimestampColumn col;
+        col.reserve(values.size());
+        for (std::int64_t v : values) col.push_back(v);
+        return col;
+    }
+
+    bool        is_encoded() const { return encoded_; }
+    std::size_t size()  const { return encoded_ ? offsets_.size() : plain_.size(); }
+    bool        empty() const { return size() == 0; }
+    std::size_t bytes() const {
+        return encoded_ ? offsets_.size() * sizeof(std::uint32_t) +
+                              base_.size() * (sizeof(std::int64_t) + sizeof(std::uint32_t))
+                        : plain_.size() * sizeof(std::int64_t);
+    }
+
+    std::int64_t operator[](std::size_t i) const {
+        return encoded_ ? base_[i >> kBlockShift] + offsets_[i] : plain_[i];
+    }
+
+    void reserve(std::size_t n) {
+        if (!encoded_) { plain_.reserve(n); return; }
+        offsets_.reserve(n);
+        base_.reserve((n + kBlockRows - 1) / kBlockRows);
+        span_.reserve((n + kBlockRows - 1) / kBlockRows);
+    }
+
+    /// Append @p t; a value below its block's base rebases the block.
+    void push_back(std::int64_t t) {
+        if (!encoded_) { plain_.push_back(t); return; }
+        const std::size_t i = offsets_.size();
+        if ((i & (kBlockRows - 1)) == 0) {           // first row of a new block
+            base_.push_back(t);
+            span_.push_back(0);
+            offsets_.push_back(0);
+            return;
+        }
+        std::int64_t&  base = base_.back();
+        std::uint32_t& span = span_.back();
+        const std::int64_t first = std::min(base, t);
+        const std::int64_t last  = std::max(base + span, t);
+        if (static_cast<std::uint64_t>(last - first) > kMaxSpan) {
+            to_plain();
+            plain_.push_back(t);
+            return;
+        }
+        if (first < base) {                          // rebase the open block
+            const auto shift = static_cast<std::uint32_t>(base - first);
+            for (std::size_t j = i & ~(kBlockRows - 1); j < i; ++j) offsets_[j] += shift;
+            base = first;
+        }
+        span = static_cast<std::uint32_t>(last - first);
+        offsets_.push_back(static_cast<std::uint32_t>(t - base));
+    }
+
+    friend bool operator==(const TimestampColumn& a, const TimestampColumn& b) {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (a[i] != b[i]) return false;
+        return true;
+    }
+
+private:
+    static constexpr std::uint64_t kMaxSpan = std::numeric_limits<std::uint32_t>::max();
+
+    void to_plain() {
+        plain_.reserve(std::max(offsets_.capacity(), offsets_.size() + 1));
+        for (std::size_t i = 0; i < offsets_.size(); ++i) plain_.push_back((*this)[i]);
+        base_ = {};
+        span_ = {};
+        offsets_ = {};
+        encoded_ = false;
+    }
+
+    bool                       encoded_ = true;
+    std::vector<std::int64_t>  base_;      ///< per block: minimum
+    std::vector<std::uint32_t> span_;      ///< per block: maximum - minimum
+    std::vector<std::uint32_t> offsets_;   ///< per row: value - block base
+    std::vector<std::int64_t>  plain_;     ///< the values, once not encoded
+};
+
+/**
+ * @brief An int64 timestamp stored as a delta from a reference timestamp.
+ *
+ * Dropoff time is pickup time plus the trip duration, which is seconds to
+ * hours: as a NarrowColumn of deltas it takes 2 bytes a row (uint16_t holds
+ * 18 hours) and widens on longer trips.  A delta outside the int range
+ * turns the column back into plain int64.
+ */
+class TimestampDeltaColumn {
+public:
+    TimestampDeltaColumn() = default;
+
+    /// values[i] stored relative to refs[i].
+    static TimestampDeltaColumn from(std::span<const std::int64_t> values,
+                                     std::span<const std::int64_t> refs) {
+        TimestampDeltaColumn col;
+        col.reserve(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) col.push_back(values[i], refs[i], refs);
+        return col;
+    }
+
+    bool        is_delta() const { return is_delta_; }
+    std::size_t size()  const { return is_delta_ ? delta_.size() : plain_.size(); }
+    bool        empty() const { return size() == 0; }
+    std::size_t bytes() const {
+        return is_delta_ ? delta_.bytes() : plain_.size() * sizeof(std::int64_t);
+    }
+    /// Width of the deltas ("u16", ...), or "i64" once plain.
+    const char* width_name() const { return is_delta_ ? int_width_name(delta_.width()) : "i64"; }
+
+    /// Row @p i, given its reference timestamp.
+    std::int64_t at(std::size_t i, std::int64_t ref) const {
+        return is_delta_ ? ref + delta_[i] : plain_[i];
+    }
+
+    void reserve(std::size_t n) {
+        if (is_delta_) delta_.reserve(n);
+        else           plain_.reserve(n);
+    }
+
+    /**
+     * @brief Append @p value relative to @p ref.
+     * @param refs  reference timestamps of the rows so far (refs[i] for row
+     *              i), read only if the column has to turn plain.
+     */
+    template <typename Refs>
+    void push_back(std::int64_t value, std::int64_t ref, const Refs& refs) {
+        if (is_delta_) {
+            const std::int64_t d = value - ref;
+            if (d >= std::numeric_limits<int>::min() && d <= std::numeric_limits<int>::max()) {
+                delta_.push_back(static_cast<int>(d));
+                return;
+            }
+            plain_.reserve(delta_.size() + 1);
+            for (std::size_t i = 0; i < delta_.size(); ++i) plain_.push_back(refs[i] + delta_[i]);
+            delta_    = {};
+            is_delta_ = false;
+        }
+        plain_.push_back(value);
+    }
+
+private:
+    bool                      is_delta_ = true;
+    NarrowColumn              delta_;    ///< value - reference, while is_delta_
+    std::vector<std::int64_t> plain_;    ///< the values, once not deltas
+};
+
+} // namespace taxi
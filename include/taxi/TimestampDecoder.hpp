@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace taxi {
+
+/**
+ * @brief Text layouts of the TLC pickup/dropoff timestamp columns.
+ *
+ *  - Iso:           "2021-01-01 00:00:37"     (24-hour)
+ *  - UsSlash:       "01/01/2021 12:00:07 AM"  (12-hour)
+ *  - YearMonthName: "2084 Nov 04 12:32:24 PM" (12-hour)
+ *
+ * A file uses one layout throughout, so CsvReader sniffs it from the first
+ * timestamp and then runs the matching fixed-width decoder on every field.
+ */
+enum class TimestampFormat {
+    Unknown,
+    Iso,
+    UsSlash,
+    YearMonthName
+};
+
+namespace detail {
+
+inline bool ts_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Fixed-width unsigned decimal at p[0..n).  No sign, no blanks.
+inline bool fixed_digits(const char* p, int n, int& out) {
+    int v = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!ts_digit(p[i])) return false;
+        v = v * 10 + (p[i] - '0');
+    }
+    out = v;
+    return true;
+}
+
+// "Jan".."Dec" (exact case, as in the TLC exports) -> 1..12, else 0.
+inline int month_from_name(const char* p) {
+    // Distinct packed keys, so one compare per month.
+    const std::uint32_t key = (static_cast<std::uint32_t>(static_cast<unsigned char>(p[0])) << 16) |
+                              (static_cast<std::uint32_t>(static_cast<unsigned char>(p[1])) << 8) |
+                               static_cast<std::uint32_t>(static_cast<unsigned char>(p[2]));
+    constexpr std::uint32_t kNames[12] = {
+        0x4A616E, 0x466562, 0x4D6172, 0x417072, 0x4D6179, 0x4A756E,   // Jan..Jun
+        0x4A756C, 0x417567, 0x536570, 0x4F6374, 0x4E6F76, 0x446563};  // Jul..Dec
+    for (int i = 0; i < 12; ++i) {
+        if (kNames[i] == key) return i + 1;
+    }
+    return 0;
+}
+
+} // namespace detail
+
+/**
+ * @brief Days since 1970-01-01 of a proleptic Gregorian date.
+ *
+ * Constant time (Howard Hinnant's days_from_civil): shift the year to start
+ * in March so the leap day is last, then count whole 400-year eras.
+ * Valid for any year; @p m in 1..12, @p d in 1..31.
+ */
+constexpr std::int64_t days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;                                 // [0, 399]
+    const int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1; // [0, 365]
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;         // [0, 146096]
+    return static_cast<std::int64_t>(era) * 146097 + doe - 719468;
+}
+
+/**
+ * @brief The proleptic Gregorian date @p days after 1970-01-01: the inverse
+ *        of days_from_civil(), by the same era arithmetic.
+ */
+constexpr void civil_from_days(std::int64_t days, int& y, int& m, int& d) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int doe = static_cast<int>(days - era * 146097);                // [0, 146096]
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365]
+    const int mp  = (5 * doy + 2) / 153;                                   // [0, 11]
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(era * 400 + yoe) + (m <= 2);
+}
+
+/**
+ * @brief Guess the layout from one timestamp field (Unknown if none fits).
+ */
+inline TimestampFormat detect_timestamp_format(std::string_view s) {
+    if (s.size() >= 3 && s[2] == '/') return TimestampFormat::UsSlash;
+    if (s.size() >= 5 && detail::ts_digit(s[0])) {
+        if (s[4] == '-') return TimestampFormat::Iso;
+        if (s[4] == ' ') return TimestampFormat::YearMonthName;
+    }
+    return TimestampFormat::Unknown;
+}
+
+/**
+ * @brief Length of the date part ("YYYY-MM-DD", "YYYY Mon DD", ...) of @p fmt;
+ *        the time of day starts one separator byte later.  0 for Unknown.
+ */
+constexpr std::size_t timestamp_date_length(TimestampFormat fmt) {
+    switch (fmt) {
+    case TimestampFormat::Iso:           return 10;
+    case TimestampFormat::UsSlash:       return 10;
+    case TimestampFormat::YearMonthName: return 11;
+    case TimestampFormat::Unknown:       break;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decode the date part of a fixed-width timestamp to days since epoch.
+ * @return false if @p s does not have the exact layout of @p fmt or the
+ *         month/day are out of range.
+ */
+inline bool decode_civil_date(std::string_view s, TimestampFormat fmt,
+                              std::int64_t& days) {
+    if (s.size() < timestamp_date_length(fmt) || fmt == TimestampFormat::Unknown) {
+        return false;
+    }
+    const char* p = s.data();
+    int y = 0, m = 0, d = 0;
+    switch (fmt) {
+    case TimestampFormat::Iso:   // YYYY-MM-DD
+        if (p[4] != '-' || p[7] != '-' ||
+            !detail::fixed_digits(p, 4, y) || !detail::fixed_digits(p + 5, 2, m) ||
+            !detail::fixed_digits(p + 8, 2, d)) {
+            return false;
+        }
+        break;
+    case TimestampFormat::UsSlash:   // MM/DD/YYYY
+        if (p[2] != '/' || p[5] != '/' ||
+            !detail::fixed_digits(p, 2, m) || !detail::fixed_digits(p + 3, 2, d) ||
+            !detail::fixed_digits(p + 6, 4, y)) {
+            return false;
+        }
+        break;
+    case TimestampFormat::YearMonthName:   // YYYY Mon DD
+        if (p[4] != ' ' || p[8] != ' ' || !detail::fixed_digits(p, 4, y) ||
+            !detail::fixed_digits(p + 9, 2, d)) {
+            return false;
+        }
+        m = detail::month_from_name(p + 5);
+        break;
+    case TimestampFormat::Unknown:
+        return false;
+    }
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    days = days_from_civil(y, m, d);
+    return true;
+}
+
+/**
+ * @brief Decode the "hh:mm:ss[ AM|PM]" part of a fixed-width timestamp.
+ *
+ * @param s   The whole timestamp field (the time starts after the date part).
+ * @param secs Seconds since midnight, 12-hour clocks converted to 24-hour.
+ * @return false on a layout mismatch or out-of-range hour/minute/second.
+ */
+inline bool decode_time_of_day(std::string_view s, TimestampFormat fmt,
+                               std::int32_t& secs) {
+    const std::size_t off = timestamp_date_length(fmt) + 1;
+    const bool twelve_hour = fmt != TimestampFormat::Iso;
+    if (off == 1 || s.size() < off + (twelve_hour ? 11 : 8)) return false;
+
+    const char* p = s.data() + off;
+    int h = 0, mi = 0, se = 0;
+    if (p[-1] != ' ' || p[2] != ':' || p[5] != ':' ||
+        !detail::fixed_digits(p, 2, h) || !detail::fixed_digits(p + 3, 2, mi) ||
+        !detail::fixed_digits(p + 6, 2, se)) {
+        return false;
+    }
+    if (twelve_hour) {
+        if (p[8] != ' ') return false;
+        const char a = static_cast<char>(p[9] | 0x20);   // ASCII lower-case
+        const char b = static_cast<char>(p[10] | 0x20);
+        if (b != 'm' || (a != 'a' && a != 'p')) return false;
+        if (a == 'p' && h != 12) h += 12;
+        else if (a == 'a' && h == 12) h = 0;
+    }
+    if (h > 23 || mi > 59 || se > 60) return false;
+
+    secs = h * 3600 + mi * 60 + se;
+    return true;
+}
+
+/**
+ * @brief Fixed-width timestamp -> seconds since the Unix epoch.
+ * @return false if @p s is not exactly in layout @p fmt; callers fall back
+ *         to a tolerant parser for such fields.
+ */
+inline bool decode_timestamp(std::string_view s, TimestampFormat fmt,
+                             std::int64_t& out) {
+    std::int64_t days;
+    std::int32_t secs;
+    if (!decode_civil_date(s, fmt, days) || !decode_time_of_day(s, fmt, secs)) {
+        return false;
+    }
+    out = days * 86400LL + secs;
+    return true;
+}
+
+/**
+ * @brief Memo of recently seen date prefixes -> days since epoch.
+ *
+ * A month of trips has ~30 distinct dates but millions of timestamps, so
+ * CsvReader decodes only hh:mm:ss per field and looks the date part up
+ * here.  Direct-mapped, 64 slots, keys compared as two 64-bit words; one
+ * instance per reader, so no synchronization.
+ */
+class DateCache {
+public:
+    static constexpr std::size_t kSlots     = 64;
+    static constexpr std::size_t kMaxKeyLen = 16;
+
+    /// @return true and set @p days if @p date is cached.
+    bool find(std::string_view date, std::int64_t& days) const {
+        if (date.size() > kMaxKeyLen) return false;
+        const Key k = make_key(date);
+        const Slot& s = slots_[slot_of(k)];
+        if (!s.used || s.key.lo != k.lo || s.key.hi != k.hi) return false;
+        days = s.days;
+        return true;
+    }
+
+    /// Remember @p date -> @p days, evicting whatever shared its slot.
+    void insert(std::string_view date, std::int64_t days) {
+        if (date.size() > kMaxKeyLen) return;
+        const Key k = make_key(date);
+        slots_[slot_of(k)] = Slot{k, days, true};
+    }
+
+private:
+    struct Key  { std::uint64_t lo = 0, hi = 0; };
+    struct Slot { Key key; std::int64_t days = 0; bool used = false; };
+
+    static Key make_key(std::string_view date) {
+        // Zero padding keeps keys of different lengths distinct for the
+        // fixed-width layouts (a date never contains NUL).
+        char buf[kMaxKeyLen] = {};
+        std::memcpy(buf, date.data(), date.size());
+        Key k;
+        std::memcpy(&k.lo, buf, 8);
+        std::memcpy(&k.hi, buf + 8, 8);
+        return k;
+    }
+
+    static std::size_t slot_of(const Key& k) {
+        const std::uint64_t h = (k.lo ^ (k.hi * 0x9E3779B97F4A7C15ull)) * 0xFF51AFD7ED558CCDull;
+        return static_cast<std::size_t>(h >> 58);   // top 6 bits -> 0..63
+    }
+
+    Slot slots_[kSlots];
+};
+
+} // namespace taxi
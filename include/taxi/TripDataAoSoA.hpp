@@ -0,0 +1,79 @@
+#pragma once
+
+#include "taxi/TripRecord.hpp"
+#include "taxi/TripDataSoA.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+/**
+ * @brief 64 consecutive trips, each field contiguous inside the tile.
+ *
+ * A field of a tile is 64 values: 512 bytes for an 8-byte field, eight whole
+ * cache lines (the tile is cache-line aligned and every field a multiple of
+ * 64 bytes).  One tile is 6720 bytes, so all the columns a predicate reads
+ * for 64 rows sit within a few pages instead of in separate arrays.  Member
+ * names match TripRecord.  Rows past the end of the table are zero.
+ */
+struct alignas(64) TripTile {
+    static constexpr std::size_t kRows = 64;
+
+    std::int64_t pickup_timestamp[kRows];
+    std::int64_t dropoff_timestamp[kRows];
+    double       trip_distance[kRows];
+    double       fare_amount[kRows];
+    double       extra[kRows];
+    double       mta_tax[kRows];
+    double       tip_amount[kRows];
+    double       tolls_amount[kRows];
+    double       improvement_surcharge[kRows];
+    double       total_amount[kRows];
+    int          vendor_id[kRows];
+    int          passenger_count[kRows];
+    int          rate_code_id[kRows];
+    int          pu_location_id[kRows];
+    int          do_location_id[kRows];
+    int          payment_type[kRows];
+    std::uint8_t store_and_fwd_flag[kRows];
+};
+
+/**
+ * @brief Array-of-Structs-of-Arrays (tiled) layout: a vector of TripTiles.
+ *
+ * Between AoS and SoA.  A scan of one field reads 512 useful bytes per tile
+ * and skips the other 6 KB, nearly as dense as a SoA column.  A multi-column
+ * predicate (Q5) reads its columns from the same tile, a few KB apart,
+ * rather than from arrays hundreds of MB apart.  AoSoAQueryEngine filters a
+ * tile at a time into a 64-bit row mask.
+ *
+ * Row i is lane i % 64 of tile i / 64.
+ */
+struct TripDataAoSoA {
+    static constexpr std::size_t kTileRows = TripTile::kRows;
+
+    std::vector<TripTile> tiles;
+
+    std::size_t size() const { return rows_; }
+
+    void reserve(std::size_t n) { tiles.reserve((n + kTileRows - 1) / kTileRows); }
+
+    /// Append one record.
+    void push_back(const TripRecord& r);
+
+    /// Row @p i reassembled.
+    TripRecord record(std::size_t i) const;
+
+    /// Tile layout of AoS records.
+    static TripDataAoSoA from_aos(std::span<const TripRecord> records);
+
+    /// Tile layout of a SoA table; fields it does not store are zero.
+    static TripDataAoSoA from_soa(const TripDataSoA& soa);
+
+private:
+    std::size_t rows_ = 0;
+};
+
+} // namespace taxi
@@ -1,18 +1,32 @@
 #pragma once
 
 #include "taxi/TripRecord.hpp"
+#include "taxi/ColumnMap.hpp"
+#include "taxi/CsvReader.hpp"
+#include "taxi/ColumnData.hpp"
+#include "taxi/MappedFile.hpp"
+#include <array>
 #include <cstdint>
 #include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace taxi {
 
+/// Row order of a TripDataSoA, as set by cluster_by_time().
+enum class TimeClustering : std::uint8_t {
+    None,          ///< load order
+    Pickup,        ///< by pickup time
+    DayLocation,   ///< by pickup day (UTC), then pu_location_id, then pickup time
+};
+
 /**
  * @brief Object-of-Arrays (SoA) layout for trip data — Phase 3.
  *
  * Instead of std::vector<TripRecord> (Array-of-Structs / AoS), each field is
- * stored in its own contiguous typed std::vector<T>.
+ * stored in its own contiguous typed array (ColumnData<T>).
  *
  * Why SoA is faster for scan-heavy workloads:
  *  - Scanning one field (e.g. trip_distance) loads only that field's cache
@@ -22,28 +36,115 @@ namespace taxi {
  *    auto-vectorize (SIMD: SSE/AVX) far more aggressively than interleaved
  *    struct fields.
  *  - Effective cache-line utilisation: 8 doubles vs. 0.5 TripRecords per line.
+ *
+ * A TripDataSoA may hold only a projection of the columns (see columns());
+ * vectors outside it stay empty and are never allocated.
+ *
+ * Columns are ColumnData: owned vectors after a CSV load, or lazily paged
+ * views of a snapshot file after map_columns() (Snapshot::map), so a table
+ * larger than RAM only keeps the columns a query touches resident.
  */
 struct TripDataSoA {
+    TripDataSoA() = default;
+    /// Empty table that stores only @p columns.
+    explicit TripDataSoA(ColumnSet columns) : columns_(columns) {}
+
     // ---- parallel arrays — index i corresponds to the i-th trip ----
-    std::vector<int>          vendor_id;
-    std::vector<std::int64_t> pickup_timestamp;
-    std::vector<std::int64_t> dropoff_timestamp;
-    std::vector<int>          passenger_count;
-    std::vector<double>       trip_distance;
-    std::vector<int>          rate_code_id;
-    std::vector<std::uint8_t> store_and_fwd_flag;  // uint8_t avoids std::vector<bool> bit-packing, enabling SIMD
-    std::vector<int>          pu_location_id;
-    std::vector<int>          do_location_id;
-    std::vector<int>          payment_type;
-    std::vector<double>       fare_amount;
-    std::vector<double>       extra;
-    std::vector<double>       mta_tax;
-    std::vector<double>       tip_amount;
-    std::vector<double>       tolls_amount;
-    std::vector<double>       improvement_surcharge;
-    std::vector<double>       total_amount;
-
-    std::size_t size() const { return pickup_timestamp.size(); }
+    ColumnData<int>          vendor_id;
+    ColumnData<std::int64_t> pickup_timestamp;
+    ColumnData<std::int64_t> dropoff_timestamp;
+    ColumnData<int>          passenger_count;
+    ColumnData<double>       trip_distance;
+    ColumnData<int>          rate_code_id;
+    ColumnData<std::uint8_t> store_and_fwd_flag;  // uint8_t avoids std::vector<bool> bit-packing, enabling SIMD
+    ColumnData<int>          pu_location_id;
+    ColumnData<int>          do_location_id;
+    ColumnData<int>          payment_type;
+    ColumnData<double>       fare_amount;
+    ColumnData<double>       extra;
+    ColumnData<double>       mta_tax;
+    ColumnData<double>       tip_amount;
+    ColumnData<double>       tolls_amount;
+    ColumnData<double>       improvement_surcharge;
+    ColumnData<double>       total_amount;
+
+    std::size_t size() const { return rows_; }
+
+    /// Columns this table stores; the other vectors are always empty.
+    ColumnSet columns() const { return columns_; }
+
+    /// reserve() / resize() every stored column.
+    void reserve(std::size_t n);
+    void resize(std::size_t n);
+
+    /// resize() without zeroing the new rows: the caller writes every one.
+    void resize_for_overwrite(std::size_t n);
+
+    /// Append one record, one value per stored column.
+    void push_back(const TripRecord& r);
+
+    /**
+     * @brief Copy all rows of @p src into rows [offset, offset + src.size()).
+     *
+     * Columns must already be sized to hold them.  Disjoint ranges may be
+     * filled from different threads concurrently (ParallelLoader::load_soa).
+     * Both tables must store the same columns.
+     */
+    void assign_rows(std::size_t offset, const TripDataSoA& src);
+
+    /// Stop storing @p cols: their vectors are freed and columns() shrinks.
+    void drop_columns(ColumnSet cols);
+
+    /**
+     * @brief Permute every stored column into pickup-time order, so that a
+     *        time range is a contiguous slice of rows and needs no index.
+     *
+     * The order is a stable radix sort of the pickup times, or with
+     * TimeClustering::DayLocation of (pickup day, pu_location_id), ties in
+     * pickup time; TimeClustering::None leaves the rows as they are.  The
+     * columns are then gathered one at a time, each in parallel, so the peak
+     * is the table plus the permutation and one column.  A mapped column
+     * becomes an owned one.  push_back() and resize() reset the order to
+     * TimeClustering::None.
+     * @throws std::runtime_error if a column the order needs is not stored.
+     */
+    void cluster_by_time(TimeClustering order = TimeClustering::Pickup);
+
+    /// Row order from the last cluster_by_time(), if rows were not added since.
+    TimeClustering time_clustering() const { return clustering_; }
+
+    /**
+     * @brief Move the rows of @p src into @p parts tables: row i goes to
+     *        table part[i], rows keeping their order.
+     *
+     * Works a column at a time and frees each source column once it is
+     * scattered, so the peak is @p src plus one column.
+     * @throws std::runtime_error if part.size() != src.size().
+     */
+    static std::vector<TripDataSoA> split(TripDataSoA&& src,
+                                          std::span<const std::uint32_t> part,
+                                          std::size_t parts);
+
+    /// Raw storage of one stored column, for binary I/O (Snapshot).
+    template <typename Byte>
+    struct ColumnBytes {
+        Column      column;
+        std::size_t elem_bytes;
+        Byte*       data;         ///< size() elements of elem_bytes each
+    };
+
+    /// Storage of every stored column, in Column order.
+    std::vector<ColumnBytes<char>>       column_bytes();
+    std::vector<ColumnBytes<const char>> column_bytes() const;
+
+    /**
+     * @brief Turn every stored column into a view of @p file (a CopyOnWrite
+     *        mapping): column c gets @p rows values from byte offsets[c].
+     *        Used by Snapshot::map(); nothing is read until it is touched.
+     * @throws std::runtime_error if a column would run past the mapping.
+     */
+    void map_columns(std::shared_ptr<const MappedFile> file, std::size_t rows,
+                     const std::array<std::uint64_t, kColumnCount>& offsets);
 
     /**
      * @brief Convert an AoS vector<TripRecord> to SoA layout.
@@ -54,22 +155,38 @@ struct TripDataSoA {
      * @param records Source AoS records (unmodified).
      * @return TripDataSoA with all parallel arrays pre-populated.
      */
-    static TripDataSoA from_aos(const std::vector<TripRecord>& records);
+    static TripDataSoA from_aos(std::span<const TripRecord> records);
 
     /**
      * @brief Load SoA layout directly from CSV files — no intermediate AoS.
      *
-     * Single-pass: reads each record via CsvReader and pushes each field
-     * directly into its column vector.  Peak memory = SoA only (~N × field_bytes),
+     * Single-pass: reads each record via a memory-mapped CsvReader and pushes
+     * each field directly into its column vector.  Peak memory = SoA only (~N × field_bytes),
      * avoiding the 2× peak of from_aos() (AoS + SoA simultaneously).
      *
      * @param paths          One or more CSV file paths (concatenated in order).
      * @param reserve_count  Pre-reserve this many rows per column (0 = none).
      *                       Pass an overestimate (e.g. 100000000) to avoid
      *                       reallocation during load.
+     * @param columns        Columns to load; the CSV fields of all others
+     *                       are skipped by the tokenizer.
+     * @param mode           How each file is read (see ReadMode).
+     * @param stats          If set, receives the parse counters of all files.
      */
     static TripDataSoA from_csv(const std::vector<std::string>& paths,
-                                std::size_t reserve_count = 0);
+                                std::size_t reserve_count = 0,
+                                ColumnSet columns = ColumnSet::all(),
+                                ReadMode mode = ReadMode::Mmap,
+                                CsvReader::Stats* stats = nullptr);
+
+private:
+    // Apply fn(vector member, record member[, Column]) to every stored column.
+    template <typename Fn>
+    void for_each_column(Fn&& fn);
+
+    ColumnSet      columns_    = ColumnSet::all();
+    std::size_t    rows_       = 0;
+    TimeClustering clustering_ = TimeClustering::None;
 };
 
 } // namespace taxi
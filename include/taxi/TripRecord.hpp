@@ -1,5 +1,6 @@
 #pragma once
 
+#include "taxi/HugePages.hpp"
 #include <cstdint>
 
 namespace taxi {
@@ -37,4 +38,8 @@ struct TripRecord {
     bool is_valid() const;
 };
 
+/// AoS table of records.  resize() leaves the new rows unwritten
+/// (HugePageAllocator), so the loaders fill them from their own threads.
+using TripRecords = HugeVector<TripRecord>;
+
 } // namespace taxi
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "taxi/ColumnMap.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace taxi {
+
+struct TripDataSoA;
+struct CompactTripDataSoA;
+
+/**
+ * @brief Summary of one block of one column.
+ *
+ * Values are compared as doubles: exact for every trip column (int64
+ * timestamps included, being far below 2^53).  NaN values count as nulls and
+ * are left out of min / max; a block of nulls only has min > max.
+ */
+struct Zone {
+    double        min   = std::numeric_limits<double>::infinity();
+    double        max   = -std::numeric_limits<double>::infinity();
+    std::uint32_t nulls = 0;   ///< NaN values
+    std::uint32_t zeros = 0;   ///< values equal to 0
+};
+
+/// What a zone says about the rows of its block for lo <= value <= hi.
+enum class ZoneMatch : std::uint8_t {
+    None,   ///< no row can match: skip the block
+    Some,   ///< some rows may match: scan the block
+    All     ///< every row matches: take the block without reading it
+};
+
+inline ZoneMatch zone_match(const Zone& z, double lo, double hi) {
+    if (!(lo <= hi) || z.max < lo || z.min > hi) return ZoneMatch::None;
+    if (z.nulls == 0 && z.min >= lo && z.max <= hi) return ZoneMatch::All;
+    return ZoneMatch::Some;
+}
+
+/**
+ * @brief Per-block min / max / null and zero counts of the columns of a table.
+ *
+ * Rows are grouped in blocks of kBlockRows; for each column the map keeps
+ * one Zone per block.  A range scan asks zone_match() per block and skips
+ * the blocks that cannot match, takes the blocks that match entirely without
+ * reading them, and compares values only in the rest.  In file order most
+ * columns are unclustered and few blocks are decided, but a column the
+ * table is sorted or clustered by (pickup time, or location in a table
+ * ordered by it) is pruned to a handful of blocks.
+ *
+ * The map costs 24 bytes per column per block, about 0.1 byte per row for
+ * all seventeen columns.
+ */
+class ZoneMap {
+public:
+    static constexpr unsigned    kBlockShift = 12;
+    static constexpr std::size_t kBlockRows  = std::size_t{1} << kBlockShift;
+
+    ZoneMap() = default;
+
+    /**
+     * @brief Zones of every stored column of @p data.
+     *
+     * Columns mapped from a snapshot are left out: summarising them would
+     * page the whole file in at load time.  Scans of a column without zones
+     * read every row.
+     */
+    static ZoneMap build(const TripDataSoA& data);
+    /// Zones of every stored column of a compact table, compact ones included.
+    static ZoneMap build(const CompactTripDataSoA& data);
+
+    /// Summarise column @p c from its @p n values get(0) .. get(n - 1).
+    template <typename Get>
+    void add(Column c, std::size_t n, Get get) {
+        std::vector<Zone>& zones = zones_[static_cast<std::size_t>(c)];
+        zones.assign(blocks(n), Zone{});
+        const auto nblocks = static_cast<std::ptrdiff_t>(zones.size());
+        #pragma omp parallel for schedule(static)
+        for (std::ptrdiff_t b = 0; b < nblocks; ++b) {
+            const std::size_t first = static_cast<std::size_t>(b) << kBlockShift;
+            const std::size_t last  = std::min(n, first + kBlockRows);
+            Zone z;
+            for (std::size_t i = first; i < last; ++i) {
+                const double v = static_cast<double>(get(i));
+                if (v != v) { ++z.nulls; continue; }
+                z.min = std::min(z.min, v);
+                z.max = std::max(z.max, v);
+                z.zeros += (v == 0);
+            }
+            zones[b] = z;
+        }
+    }
+
+    /// Zones of column @p c, one per block; empty if it has none.
+    std::span<const Zone> zones(Column c) const {
+        return zones_[static_cast<std::size_t>(c)];
+    }
+
+    std::size_t bytes() const {
+        std::size_t total = 0;
+        for (const auto& z : zones_) total += z.size() * sizeof(Zone);
+        return total;
+    }
+
+    static std::size_t blocks(std::size_t n) { return (n + kBlockRows - 1) >> kBlockShift; }
+
+private:
+    std::array<std::vector<Zone>, kColumnCount> zones_;
+};
+
+} // namespace taxi
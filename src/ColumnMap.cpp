@@ -0,0 +1,117 @@
+#include "taxi/ColumnMap.hpp"
+
+#include <cctype>
+
+namespace taxi {
+
+namespace {
+
+struct ColumnNames {
+    Column           column;
+    std::string_view field;       // TripRecord field name
+    std::string_view aliases[3];  // TLC header names across schema years
+};
+
+constexpr ColumnNames kNames[kColumnCount] = {
+    {Column::VendorId,             "vendor_id",             {"VendorID"}},
+    {Column::PickupTimestamp,      "pickup_timestamp",      {"tpep_pickup_datetime", "lpep_pickup_datetime", "pickup_datetime"}},
+    {Column::DropoffTimestamp,     "dropoff_timestamp",     {"tpep_dropoff_datetime", "lpep_dropoff_datetime", "dropoff_datetime"}},
+    {Column::PassengerCount,       "passenger_count",       {}},
+    {Column::TripDistance,         "trip_distance",         {}},
+    {Column::RateCodeId,           "rate_code_id",          {"RatecodeID"}},
+    {Column::StoreAndFwdFlag,      "store_and_fwd_flag",    {}},
+    {Column::PuLocationId,         "pu_location_id",        {"PULocationID"}},
+    {Column::DoLocationId,         "do_location_id",        {"DOLocationID"}},
+    {Column::PaymentType,          "payment_type",          {}},
+    {Column::FareAmount,           "fare_amount",           {}},
+    {Column::Extra,                "extra",                 {}},
+    {Column::MtaTax,               "mta_tax",               {}},
+    {Column::TipAmount,            "tip_amount",            {}},
+    {Column::TollsAmount,          "tolls_amount",          {}},
+    {Column::ImprovementSurcharge, "improvement_surcharge", {}},
+    {Column::TotalAmount,          "total_amount",          {}},
+};
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) !=
+            std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Header cell without surrounding blanks, quotes or a line ending.
+std::string_view trim_cell(std::string_view s) {
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' || s.back() == ' ' ||
+                          s.back() == '"')) {
+        s.remove_suffix(1);
+    }
+    while (!s.empty() && (s.front() == ' ' || s.front() == '"')) s.remove_prefix(1);
+    return s;
+}
+
+} // namespace
+
+std::optional<Column> column_from_name(std::string_view name) {
+    name = trim_cell(name);
+    for (const auto& n : kNames) {
+        if (iequals(name, n.field)) return n.column;
+        for (std::string_view alias : n.aliases) {
+            if (!alias.empty() && iequals(name, alias)) return n.column;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view column_name(Column c) {
+    return kNames[static_cast<std::size_t>(c)].field;
+}
+
+ColumnMap ColumnMap::tlc_default() {
+    ColumnMap m;
+    for (std::size_t i = 0; i < kColumnCount; ++i) {
+        m.index[i] = static_cast<std::int8_t>(i);
+    }
+    return m;
+}
+
+ColumnMap ColumnMap::from_header(std::string_view header) {
+    ColumnMap m;
+    m.index.fill(kAbsent);
+
+    std::size_t field = 0;
+    for (;;) {
+        const auto comma = header.find(',');
+        const std::string_view cell = header.substr(0, comma);
+        if (field < kMaxFields) {
+            const auto col = column_from_name(cell);
+            if (col && m[*col] == kAbsent) {
+                m.index[static_cast<std::size_t>(*col)] = static_cast<std::int8_t>(field);
+            }
+        }
+        ++field;
+        if (comma == std::string_view::npos) break;
+        header.remove_prefix(comma + 1);
+    }
+    m.field_count = field;
+
+    if (m[Column::PickupTimestamp] == kAbsent || m[Column::DropoffTimestamp] == kAbsent) {
+        return tlc_default();   // not a recognizable header
+    }
+    return m;
+}
+
+std::uint32_t ColumnMap::field_mask(ColumnSet cols) const {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < kColumnCount; ++i) {
+        if (cols.has(static_cast<Column>(i)) && index[i] != kAbsent) {
+            mask |= 1u << index[i];
+        }
+    }
+    return mask;
+}
+
+} // namespace taxi
@@ -0,0 +1,117 @@
+#include "taxi/CompactSoA.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace taxi {
+
+template <typename Fn>
+void CompactTripDataSoA::for_each_compact(Fn&& fn)
+{
+    auto visit = [&](Column c, auto& col, auto src, auto field) {
+        if (columns_.has(c)) fn(c, col, src, field);
+    };
+    visit(Column::VendorId,       vendor_id,       &TripDataSoA::vendor_id,       &TripRecord::vendor_id);
+    visit(Column::PassengerCount, passenger_count, &TripDataSoA::passenger_count, &TripRecord::passenger_count);
+    visit(Column::RateCodeId,     rate_code_id,    &TripDataSoA::rate_code_id,    &TripRecord::rate_code_id);
+    visit(Column::PaymentType,    payment_type,    &TripDataSoA::payment_type,    &TripRecord::payment_type);
+    visit(Column::StoreAndFwdFlag, store_and_fwd_flag,
+          &TripDataSoA::store_and_fwd_flag, &TripRecord::store_and_fwd_flag);
+    visit(Column::PuLocationId,   pu_location_id,  &TripDataSoA::pu_location_id,  &TripRecord::pu_location_id);
+    visit(Column::DoLocationId,   do_location_id,  &TripDataSoA::do_location_id,  &TripRecord::do_location_id);
+    visit(Column::FareAmount,     fare_amount,     &TripDataSoA::fare_amount,     &TripRecord::fare_amount);
+    visit(Column::Extra,          extra,           &TripDataSoA::extra,           &TripRecord::extra);
+    visit(Column::MtaTax,         mta_tax,         &TripDataSoA::mta_tax,         &TripRecord::mta_tax);
+    visit(Column::TipAmount,      tip_amount,      &TripDataSoA::tip_amount,      &TripRecord::tip_amount);
+    visit(Column::TollsAmount,    tolls_amount,    &TripDataSoA::tolls_amount,    &TripRecord::tolls_amount);
+    visit(Column::ImprovementSurcharge, improvement_surcharge,
+          &TripDataSoA::improvement_surcharge, &TripRecord::improvement_surcharge);
+    visit(Column::TotalAmount,    total_amount,    &TripDataSoA::total_amount,    &TripRecord::total_amount);
+    visit(Column::PickupTimestamp, pickup_timestamp,
+          &TripDataSoA::pickup_timestamp, &TripRecord::pickup_timestamp);
+}
+
+ColumnSet CompactTripDataSoA::compacted(ColumnSet columns)
+{
+    ColumnSet out = columns & (kPackedColumns | kNarrowColumns | kMoneyColumns);
+    if (columns.has(Column::PickupTimestamp)) out = out | (columns & kTimeColumns);
+    return out;
+}
+
+CompactTripDataSoA::CompactTripDataSoA(ColumnSet columns)
+    : wide(columns - compacted(columns)), columns_(columns) {}
+
+std::size_t CompactTripDataSoA::bytes() const
+{
+    std::size_t total = 0;
+    for (const auto& c : wide.column_bytes()) total += c.elem_bytes * wide.size();
+    // Unstored compact columns are empty.
+    for (const PackedColumn* col : {&vendor_id, &passenger_count, &rate_code_id,
+                                    &payment_type, &store_and_fwd_flag})
+        total += col->bytes();
+    total += pu_location_id.bytes() + do_location_id.bytes();
+    for (const MoneyColumn* col : {&fare_amount, &extra, &mta_tax, &tip_amount,
+                                   &tolls_amount, &improvement_surcharge, &total_amount})
+        total += col->bytes();
+    return total + pickup_timestamp.bytes() + dropoff_timestamp.bytes();
+}
+
+void CompactTripDataSoA::reserve(std::size_t n)
+{
+    wide.reserve(n);
+    for_each_compact([&](Column, auto& col, auto, auto) { col.reserve(n); });
+    if (dropoff_is_delta()) dropoff_timestamp.reserve(n);
+}
+
+void CompactTripDataSoA::push_back(const TripRecord& r)
+{
+    wide.push_back(r);
+    for_each_compact([&](Column, auto& col, auto, auto field) { col.push_back(r.*field); });
+    if (dropoff_is_delta())
+        dropoff_timestamp.push_back(r.dropoff_timestamp, r.pickup_timestamp, pickup_timestamp);
+}
+
+CompactTripDataSoA CompactTripDataSoA::from_soa(TripDataSoA&& soa)
+{
+    CompactTripDataSoA out(soa.columns());
+    // Convert one column at a time and free its wide vector straight away;
+    // dropoff first, while the pickup column it is relative to is there.
+    if (out.dropoff_is_delta()) {
+        out.dropoff_timestamp = TimestampDeltaColumn::from(soa.dropoff_timestamp.span(),
+                                                           soa.pickup_timestamp.span());
+        soa.drop_columns({Column::DropoffTimestamp});
+    }
+    out.for_each_compact([&](Column c, auto& col, auto src, auto) {
+        col = std::decay_t<decltype(col)>::from((soa.*src).span());
+        soa.drop_columns({c});
+    });
+    out.wide = std::move(soa);
+    return out;
+}
+
+CompactTripDataSoA CompactTripDataSoA::from_csv(const std::vector<std::string>& paths,
+                                                std::size_t reserve_count,
+                                                ColumnSet columns,
+                                                ReadMode mode,
+                                                CsvReader::Stats* stats)
+{
+    CompactTripDataSoA out(columns);
+    if (reserve_count > 0) out.reserve(reserve_count);
+
+    CsvReader::Stats total;
+    for (const auto& path : paths) {
+        CsvReader reader(path, mode, columns);
+        if (!reader.is_open())
+            throw std::runtime_error("CompactTripDataSoA::from_csv: cannot open " + path);
+        TripRecord r;
+        while (reader.read_next(r)) {
+            out.push_back(r);
+        }
+        total += reader.get_stats();
+    }
+    if (stats) *stats = total;
+    return out;
+}
+
+} // namespace taxi
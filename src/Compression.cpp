@@ -0,0 +1,454 @@
+#include "taxi/Compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(TAXI_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(TAXI_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace taxi {
+
+namespace {
+
+[[noreturn]] void fail(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string("decompress: ") + what + ": " + path);
+}
+
+[[noreturn]] void unsupported(Compression c, const std::string& path) {
+    throw std::runtime_error(std::string("decompress: built without ") +
+                             (c == Compression::Gzip ? "zlib" : "libzstd") +
+                             ", cannot read " + path);
+}
+
+// Run fn(i) for i in [0, n) on up to num_threads threads (atomic cursor).
+template <typename Fn>
+void run_parallel(int num_threads, std::size_t n, Fn&& fn) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&] {
+        for (std::size_t i = next++; i < n; i = next++) fn(i);
+    };
+    const int t_count = static_cast<int>(std::min<std::size_t>(std::max(num_threads, 1), n));
+    if (t_count <= 1) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < t_count; ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+}
+
+// Grow @p out by at least @p min_extra bytes of writable space.
+void grow(std::string& out, std::size_t used, std::size_t min_extra) {
+    if (out.size() - used < min_extra) {
+        out.resize(std::max(used + min_extra, out.size() * 2));
+    }
+}
+
+#if defined(TAXI_HAVE_ZLIB)
+
+// Decode the gzip members in @p in into @p out.  @return false unless the
+// input ends exactly at the end of a member (CRC and length verified).
+bool gunzip_all(std::string_view in, std::string& out, std::size_t& members) {
+    z_stream zs{};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) return false;   // gzip wrapper only
+
+    // avail_in is 32-bit: feed inputs over 4 GB in 1 GB slices.
+    constexpr std::size_t kSlice = std::size_t{1} << 30;
+    auto refill = [&] {
+        const std::size_t n = std::min(in.size(), kSlice);
+        zs.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        zs.avail_in = static_cast<uInt>(n);
+        in.remove_prefix(n);
+    };
+    refill();
+
+    std::size_t used = 0;
+    bool ok = false;
+    for (;;) {
+        if (zs.avail_in == 0 && !in.empty()) refill();
+        grow(out, used, std::size_t{1} << 20);
+        zs.next_out  = reinterpret_cast<Bytef*>(out.data() + used);
+        zs.avail_out = static_cast<uInt>(std::min<std::size_t>(out.size() - used, 1u << 30));
+        const uInt before = zs.avail_out;
+        const int r = inflate(&zs, Z_NO_FLUSH);
+        used += before - zs.avail_out;
+        if (r == Z_STREAM_END) {
+            ++members;
+            if (zs.avail_in == 0 && in.empty()) { ok = true; break; }
+            inflateReset(&zs);   // next member
+            continue;
+        }
+        if (r == Z_BUF_ERROR && zs.avail_in == 0 && !in.empty()) continue;
+        if (r != Z_OK && !(r == Z_BUF_ERROR && zs.avail_in > 0)) break;
+    }
+    inflateEnd(&zs);
+    out.resize(used);
+    return ok;
+}
+
+// Offsets that look like the start of a gzip member: magic, deflate, no
+// reserved flag bits, a known XFL.  The first byte always starts one.
+std::vector<std::size_t> gzip_member_candidates(std::string_view in) {
+    std::vector<std::size_t> starts{0};
+    const auto* b = reinterpret_cast<const unsigned char*>(in.data());
+    for (std::size_t p = 1; p + 10 <= in.size(); ++p) {
+        const void* hit = std::memchr(b + p, 0x1f, in.size() - 10 - p + 1);
+        if (!hit) break;
+        p = static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - b);
+        if (b[p + 1] == 0x8b && b[p + 2] == 8 && (b[p + 3] & 0xe0) == 0 &&
+            (b[p + 8] == 0 || b[p + 8] == 2 || b[p + 8] == 4)) {
+            starts.push_back(p);
+        }
+    }
+    return starts;
+}
+
+#endif // TAXI_HAVE_ZLIB
+
+#if defined(TAXI_HAVE_ZSTD)
+
+// Decode the zstd frames in @p in into @p out.
+bool unzstd_all(std::string_view in, std::string& out, std::size_t& frames) {
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    if (!dctx) return false;
+    ZSTD_inBuffer src{in.data(), in.size(), 0};
+    std::size_t used = 0;
+    std::size_t hint = 1;
+    bool ok = true;
+    while (src.pos < src.size || hint != 0) {
+        grow(out, used, std::size_t{1} << 20);
+        ZSTD_outBuffer dst{out.data() + used, out.size() - used, 0};
+        const std::size_t before_in = src.pos;
+        hint = ZSTD_decompressStream(dctx, &dst, &src);
+        used += dst.pos;
+        if (ZSTD_isError(hint)) { ok = false; break; }
+        if (hint == 0) ++frames;
+        if (src.pos == src.size && dst.pos == 0 && src.pos == before_in && hint != 0) {
+            ok = false;   // truncated frame
+            break;
+        }
+    }
+    ZSTD_freeDCtx(dctx);
+    out.resize(used);
+    return ok;
+}
+
+#endif // TAXI_HAVE_ZSTD
+
+// ---- Streaming sources ------------------------------------------------------
+
+#if defined(TAXI_HAVE_ZLIB)
+
+class GzipSource final : public FileSource {
+public:
+    GzipSource(std::unique_ptr<FileSource> raw, std::string path, std::size_t chunk_bytes)
+        : raw_(std::move(raw)), path_(std::move(path)), out_(chunk_bytes) {
+        size_ = raw_->size();
+        if (inflateInit2(&zs_, 15 + 16) != Z_OK) fail("inflateInit failed", path_);
+        name_ = std::string("gzip:") + raw_->name();
+    }
+    ~GzipSource() override { inflateEnd(&zs_); }
+
+    std::string_view next() override {
+        zs_.next_out  = reinterpret_cast<Bytef*>(out_.data());
+        zs_.avail_out = static_cast<uInt>(out_.size());
+        while (zs_.avail_out > 0) {
+            if (zs_.avail_in == 0 && !raw_eof_) {
+                const std::string_view c = raw_->next();
+                raw_eof_     = c.empty();
+                zs_.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(c.data()));
+                zs_.avail_in = static_cast<uInt>(c.size());
+            }
+            if (zs_.avail_in == 0 && raw_eof_ && !in_member_) break;
+
+            const int r = inflate(&zs_, Z_NO_FLUSH);
+            if (r == Z_STREAM_END) {
+                inflateReset(&zs_);   // another member may follow
+                in_member_ = false;
+                continue;
+            }
+            if (r == Z_BUF_ERROR && zs_.avail_in == 0) {
+                if (raw_eof_) fail("truncated gzip input", path_);
+                continue;
+            }
+            if (r != Z_OK) fail(zs_.msg ? zs_.msg : "corrupt gzip input", path_);
+            in_member_ = true;
+        }
+        return {out_.data(), out_.size() - zs_.avail_out};
+    }
+
+    const char* name() const override { return name_.c_str(); }
+
+private:
+    std::unique_ptr<FileSource> raw_;
+    std::string       path_;
+    std::string       name_;
+    std::vector<char> out_;
+    z_stream          zs_{};
+    bool              raw_eof_   = false;
+    bool              in_member_ = false;
+};
+
+#endif // TAXI_HAVE_ZLIB
+
+#if defined(TAXI_HAVE_ZSTD)
+
+class ZstdSource final : public FileSource {
+public:
+    ZstdSource(std::unique_ptr<FileSource> raw, std::string path, std::size_t chunk_bytes)
+        : raw_(std::move(raw)), path_(std::move(path)), out_(chunk_bytes),
+          ds_(ZSTD_createDStream()) {
+        size_ = raw_->size();
+        if (!ds_) fail("ZSTD_createDStream failed", path_);
+        name_ = std::string("zstd:") + raw_->name();
+    }
+    ~ZstdSource() override { ZSTD_freeDStream(ds_); }
+
+    std::string_view next() override {
+        ZSTD_outBuffer dst{out_.data(), out_.size(), 0};
+        while (dst.pos < dst.size) {
+            if (in_.pos == in_.size && !raw_eof_) {
+                const std::string_view c = raw_->next();
+                raw_eof_ = c.empty();
+                in_ = {c.data(), c.size(), 0};
+            }
+            if (in_.pos == in_.size && raw_eof_ && !in_frame_) break;
+
+            const std::size_t before = dst.pos;
+            const std::size_t r = ZSTD_decompressStream(ds_, &dst, &in_);
+            if (ZSTD_isError(r)) fail(ZSTD_getErrorName(r), path_);
+            in_frame_ = r != 0;
+            if (in_.pos == in_.size && raw_eof_ && dst.pos == before) {
+                if (in_frame_) fail("truncated zstd input", path_);
+                break;
+            }
+        }
+        return {out_.data(), dst.pos};
+    }
+
+    const char* name() const override { return name_.c_str(); }
+
+private:
+    std::unique_ptr<FileSource> raw_;
+    std::string       path_;
+    std::string       name_;
+    std::vector<char> out_;
+    ZSTD_DStream*     ds_;
+    ZSTD_inBuffer     in_{nullptr, 0, 0};
+    bool              raw_eof_  = false;
+    bool              in_frame_ = false;
+};
+
+#endif // TAXI_HAVE_ZSTD
+
+} // namespace
+
+Compression detect_compression(std::string_view head) {
+    const auto* b = reinterpret_cast<const unsigned char*>(head.data());
+    if (head.size() >= 3 && b[0] == 0x1f && b[1] == 0x8b && b[2] == 8) {
+        return Compression::Gzip;
+    }
+    if (head.size() >= 4 && b[0] == 0x28 && b[1] == 0xb5 && b[2] == 0x2f && b[3] == 0xfd) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+Compression file_compression(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return Compression::None;
+    struct stat st{};
+    char head[4];
+    ssize_t n = 0;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        n = ::pread(fd, head, sizeof(head), 0);
+    }
+    ::close(fd);
+    return n > 0 ? detect_compression(std::string_view(head, static_cast<std::size_t>(n)))
+                 : Compression::None;
+}
+
+const char* compression_name(Compression c) {
+    switch (c) {
+    case Compression::None: return "none";
+    case Compression::Gzip: return "gzip";
+    case Compression::Zstd: return "zstd";
+    }
+    return "?";
+}
+
+bool compression_supported(Compression c) {
+    switch (c) {
+    case Compression::None: return true;
+#if defined(TAXI_HAVE_ZLIB)
+    case Compression::Gzip: return true;
+#endif
+#if defined(TAXI_HAVE_ZSTD)
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+std::unique_ptr<FileSource> make_decompressing_source(std::unique_ptr<FileSource> raw,
+                                                      Compression c,
+                                                      const std::string& path,
+                                                      std::size_t chunk_bytes) {
+    switch (c) {
+    case Compression::None:
+        return raw;
+    case Compression::Gzip:
+#if defined(TAXI_HAVE_ZLIB)
+        return std::make_unique<GzipSource>(std::move(raw), path, chunk_bytes);
+#else
+        break;
+#endif
+    case Compression::Zstd:
+#if defined(TAXI_HAVE_ZSTD)
+        return std::make_unique<ZstdSource>(std::move(raw), path, chunk_bytes);
+#else
+        break;
+#endif
+    }
+    unsupported(c, path);
+}
+
+// ---- Parallel whole-file decoding -------------------------------------------
+
+std::size_t DecodedText::size() const {
+    std::size_t n = 0;
+    for (auto b : blocks_) n += b.size();
+    return n;
+}
+
+void DecodedText::stitch() {
+    // A line cut between two parts goes to a seam buffer; the reserve keeps
+    // seams_ from reallocating under the views taken of it.
+    seams_.reserve(parts_.size() + 1);
+    std::string carry;
+    for (const std::string& part : parts_) {
+        std::string_view v = part;
+        if (!carry.empty()) {
+            const auto nl = v.find('\n');
+            if (nl == std::string_view::npos) {
+                carry.append(v);
+                continue;
+            }
+            carry.append(v.substr(0, nl + 1));
+            seams_.push_back(std::move(carry));
+            blocks_.emplace_back(seams_.back());
+            carry.clear();
+            v.remove_prefix(nl + 1);
+        }
+        const auto last = v.rfind('\n');
+        const std::size_t body = last == std::string_view::npos ? 0 : last + 1;
+        if (body > 0) blocks_.push_back(v.substr(0, body));
+        carry.assign(v.substr(body));
+    }
+    if (!carry.empty()) {
+        seams_.push_back(std::move(carry));
+        blocks_.emplace_back(seams_.back());
+    }
+}
+
+DecodedText decompress_parallel(std::string_view compressed, Compression c,
+                                int num_threads, const std::string& path) {
+    DecodedText out;
+    if (c == Compression::None) {
+        out.parts_.emplace_back(compressed);
+        out.stitch();
+        return out;
+    }
+    if (!compression_supported(c)) unsupported(c, path);
+
+    // Split points: exact frame boundaries (zstd) or verified member-header
+    // candidates (gzip).
+    std::vector<std::size_t> starts;
+#if defined(TAXI_HAVE_ZSTD)
+    if (c == Compression::Zstd) {
+        for (std::size_t p = 0; p < compressed.size();) {
+            const std::size_t n = ZSTD_findFrameCompressedSize(compressed.data() + p,
+                                                               compressed.size() - p);
+            if (ZSTD_isError(n) || n == 0) fail("corrupt zstd frame", path);
+            starts.push_back(p);
+            p += n;
+        }
+    }
+#endif
+#if defined(TAXI_HAVE_ZLIB)
+    if (c == Compression::Gzip) starts = gzip_member_candidates(compressed);
+#endif
+    starts.push_back(compressed.size());
+
+    const std::size_t n_seg = starts.size() - 1;
+    std::vector<std::string>  parts(n_seg);
+    std::vector<std::size_t>  members(n_seg, 0);
+    std::vector<char>         ok(n_seg, 0);
+    auto decode = [&](std::size_t a, std::size_t b, std::string& dst, std::size_t& m) {
+        const std::string_view in = compressed.substr(starts[a], starts[b] - starts[a]);
+        dst.clear();
+        m = 0;
+#if defined(TAXI_HAVE_ZLIB)
+        if (c == Compression::Gzip) {
+            // The member trailer's ISIZE is a good first allocation.
+            std::uint32_t isize = 0;
+            if (in.size() >= 4) std::memcpy(&isize, in.data() + in.size() - 4, 4);
+            dst.resize(std::clamp<std::size_t>(isize + 4096, in.size(), in.size() * 64));
+            return gunzip_all(in, dst, m);
+        }
+#endif
+#if defined(TAXI_HAVE_ZSTD)
+        if (c == Compression::Zstd) {
+            const auto content = ZSTD_getFrameContentSize(in.data(), in.size());
+            dst.resize(content <= in.size() * 1024 ? content + 4096 : in.size() * 4);
+            return unzstd_all(in, dst, m);
+        }
+#endif
+        return false;
+    };
+
+    run_parallel(num_threads, n_seg, [&](std::size_t i) {
+        ok[i] = decode(i, i + 1, parts[i], members[i]);
+    });
+
+    // A false gzip candidate leaves a run of failed segments between two
+    // verified boundaries: decode that range again as one unit.
+    for (std::size_t i = 0; i < n_seg;) {
+        if (ok[i]) {
+            out.parts_.push_back(std::move(parts[i]));
+            out.members_ += members[i];
+            ++i;
+            continue;
+        }
+        std::size_t j = i + 1;
+        while (j < n_seg && !ok[j]) ++j;
+        std::string merged;
+        std::size_t m = 0;
+        if (!decode(i, j, merged, m)) {
+            fail(c == Compression::Gzip ? "corrupt or truncated gzip input"
+                                        : "corrupt or truncated zstd input", path);
+        }
+        out.parts_.push_back(std::move(merged));
+        out.members_ += m;
+        for (std::size_t k = i; k < j; ++k) std::string().swap(parts[k]);
+        i = j;
+    }
+
+    out.stitch();
+    return out;
+}
+
+} // namespace taxi
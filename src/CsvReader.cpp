@@ -1,23 +1,97 @@
 #include "taxi/CsvReader.hpp"
-#include <sstream>
+#include "taxi/Compression.hpp"
+#include "taxi/FieldDecoder.hpp"
+#include "taxi/TimestampDecoder.hpp"
 #include <stdexcept>
 #include <algorithm>
-#include <ctime>
 #include <cctype>
-#include <iomanip>
+#include <cstdio>
+#include <cstring>
 
 namespace taxi {
 
-CsvReader::CsvReader(const std::string& filepath)
-    : file_(filepath, std::ios::in), stats_(), header_read_(false) {
-    if (!file_.is_open()) {
-        throw std::runtime_error("Failed to open CSV file: " + filepath);
+namespace {
+
+bool is_blank(std::string_view s) {
+    return s.find_first_not_of(" \t\r\n") == std::string_view::npos;
+}
+
+// Copy a field into a NUL-terminated stack buffer so the C conversion
+// routines can be used without allocating.  Returns false if it does not fit.
+template <std::size_t N>
+bool to_cstr(std::string_view s, char (&buf)[N]) {
+    if (s.size() >= N) return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    return true;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) !=
+            std::toupper(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
     }
-    // Skip header line
-    std::string header;
-    if (std::getline(file_, header)) {
-        header_read_ = true;
+    return true;
+}
+
+} // namespace
+
+const char* read_mode_name(ReadMode mode) {
+    switch (mode) {
+    case ReadMode::Mmap:     return "mmap";
+    case ReadMode::Stream:   return "stream";
+    case ReadMode::Buffered: return "buffered";
+    case ReadMode::Pread:    return "pread";
+    case ReadMode::Direct:   return "direct";
+    }
+    return "?";
+}
+
+CsvReader::CsvReader(const std::string& filepath, ReadMode mode, ColumnSet columns)
+    : mode_(mode), stats_(), header_read_(false), columns_(columns) {
+    // Compressed files cannot be tokenized in place: decompress them in
+    // chunks through a FileSource instead.
+    if ((mode_ == ReadMode::Mmap || mode_ == ReadMode::Stream) &&
+        file_compression(filepath) != Compression::None) {
+        mode_ = ReadMode::Buffered;
+    }
+
+    if (mode_ == ReadMode::Mmap && !map_.open(filepath)) {
+        mode_ = ReadMode::Stream;   // not a regular file — stream it instead
+    }
+
+    if (mode_ == ReadMode::Buffered || mode_ == ReadMode::Pread ||
+        mode_ == ReadMode::Direct) {
+        const auto backend = mode_ == ReadMode::Buffered ? FileSource::Backend::Buffered
+                           : mode_ == ReadMode::Pread    ? FileSource::Backend::Pread
+                                                         : FileSource::Backend::Direct;
+        source_ = FileSource::open(filepath, backend);
+    } else if (mode_ == ReadMode::Mmap) {
+        map_.advise_sequential();
+        window_ = map_.view();
+    } else {
+        file_.open(filepath, std::ios::in);
+        if (!file_.is_open()) {
+            throw std::runtime_error("Failed to open CSV file: " + filepath);
+        }
     }
+
+    header_read_ = skip_header();
+}
+
+CsvReader::CsvReader(FromBytes, std::string_view bytes, const ColumnMap& map,
+                     ColumnSet columns)
+    : mode_(ReadMode::Mmap), window_(bytes), stats_(), header_read_(true),
+      columns_(columns) {
+    use_column_map(map);
+}
+
+CsvReader CsvReader::from_bytes(std::string_view bytes, const ColumnMap& map,
+                                ColumnSet columns) {
+    return CsvReader(FromBytes{}, bytes, map, columns);
 }
 
 CsvReader::~CsvReader() {
@@ -26,25 +100,183 @@ CsvReader::~CsvReader() {
     }
 }
 
+const char* CsvReader::io_backend() const {
+    if (source_) return source_->name();
+    return mode_ == ReadMode::Stream ? "stream" : "mmap";
+}
+
 bool CsvReader::is_open() const {
+    if (source_) return true;
+    if (mode_ == ReadMode::Mmap) {
+        return map_.is_open() || window_.data() != nullptr;
+    }
     return file_.is_open() && file_.good();
 }
 
+bool CsvReader::skip_header() {
+    std::string_view header;
+    bool ok = true;
+    if (mode_ == ReadMode::Stream) {
+        ok = static_cast<bool>(std::getline(file_, line_buf_));
+        header = line_buf_;
+    } else if (window_.empty() && !(source_ && refill_window())) {
+        ok = false;
+    } else {
+        const auto nl = window_.find('\n');
+        header = window_.substr(0, nl);
+        window_.remove_prefix(nl == std::string_view::npos ? window_.size() : nl + 1);
+    }
+    use_column_map(ok ? ColumnMap::from_header(header) : ColumnMap::tlc_default());
+    return ok;
+}
+
+void CsvReader::use_column_map(const ColumnMap& map) {
+    schema_ = map;
+    decode_ = columns_ | kValidationColumns;
+    // Field 0 is always sliced: read_next() checks it for blank lines.
+    wanted_fields_ = schema_.field_mask(decode_) | 1u;
+}
+
+bool CsvReader::refill_window() {
+    for (;;) {
+        if (pending_.empty()) {
+            if (!source_eof_) {
+                pending_    = source_->next();
+                source_eof_ = pending_.empty();
+            }
+            if (pending_.empty()) {
+                // End of file: a last line without a trailing newline.
+                if (carry_.empty()) return false;
+                stitch_.swap(carry_);
+                carry_.clear();
+                window_ = std::string_view(stitch_.data(), stitch_.size());
+                return true;
+            }
+        }
+
+        if (!carry_.empty()) {
+            // Finish the line cut at the end of the previous chunk.  It is
+            // the only copy: the rest of the chunk is indexed in place.
+            const auto nl = pending_.find('\n');
+            const std::size_t take = nl == std::string_view::npos ? pending_.size() : nl + 1;
+            carry_.insert(carry_.end(), pending_.data(), pending_.data() + take);
+            pending_.remove_prefix(take);
+            if (nl == std::string_view::npos) continue;
+            stitch_.swap(carry_);
+            carry_.clear();
+            window_ = std::string_view(stitch_.data(), stitch_.size());
+            return true;
+        }
+
+        // Whole lines of the chunk in place; the cut tail waits in carry_
+        // (copied before the next chunk overwrites the buffer).
+        const auto last = pending_.rfind('\n');
+        const std::size_t body = last == std::string_view::npos ? 0 : last + 1;
+        carry_.assign(pending_.data() + body, pending_.data() + pending_.size());
+        window_  = pending_.substr(0, body);
+        pending_ = {};
+        if (body > 0) return true;
+    }
+}
+
+bool CsvReader::next_block() {
+    if (window_.empty() && !(source_ && refill_window())) return false;
+
+    // Cut the block after the last newline inside kScanBlockBytes so rows
+    // never straddle two blocks; a single over-long row extends the block.
+    std::size_t len = window_.size();
+    if (len > kScanBlockBytes) {
+        auto nl = window_.rfind('\n', kScanBlockBytes - 1);
+        if (nl == std::string_view::npos) nl = window_.find('\n', kScanBlockBytes);
+        if (nl != std::string_view::npos) len = nl + 1;
+    }
+
+    block_ = window_.substr(0, len);
+    window_.remove_prefix(len);
+
+    scanner_.reset();
+    seps_      = scanner_.scan(block_);
+    sep_pos_   = 0;
+    row_start_ = 0;
+    return true;
+}
+
+std::size_t CsvReader::next_row() {
+    if (mode_ == ReadMode::Stream) {
+        if (!std::getline(file_, line_buf_)) return 0;
+        block_ = line_buf_;
+        scanner_.reset();
+        seps_      = scanner_.scan(block_);
+        sep_pos_   = 0;
+        row_start_ = 0;
+    } else {
+        while (row_start_ >= block_.size()) {
+            if (!next_block()) return 0;
+        }
+    }
+    return take_row();
+}
+
+std::size_t CsvReader::take_row() {
+    /**
+     * Field slicing over the structural index
+     *
+     * Handles RFC 4180-style CSV:
+     * - Fields may be quoted with double quotes
+     * - Quoted fields may contain commas (the scanner does not report them)
+     * - Empty fields are allowed
+     *
+     * Each field is a view into the block with the surrounding quotes
+     * removed.  Escaped "" pairs are left as-is inside the view (un-escaping
+     * would need a copy); no TLC column that we convert can contain one.
+     * A row ends at a '\n' separator or at the end of the block.
+     */
+    std::size_t count = 0;
+    std::size_t start = row_start_;
+
+    for (;;) {
+        bool        row_end;
+        std::size_t off;
+        if (sep_pos_ < seps_.size()) {
+            off     = seps_[sep_pos_++];
+            row_end = block_[off] == '\n';
+        } else {
+            off     = block_.size();    // last row without trailing newline
+            row_end = true;
+        }
+
+        // Unwanted fields are only counted: projected-out columns cost one
+        // separator step each.
+        if (count < kMaxFields && ((wanted_fields_ >> count) & 1u)) {
+            auto f = block_.substr(start, off - start);
+            if (row_end && !f.empty() && f.back() == '\r') f.remove_suffix(1);
+            if (!f.empty() && f.front() == '"') f.remove_prefix(1);
+            if (!f.empty() && f.back() == '"') f.remove_suffix(1);
+            fields_[count] = f;
+        }
+        ++count;
+
+        start = off + 1;
+        if (row_end) break;
+    }
+
+    row_start_ = start;
+    return count;
+}
+
 bool CsvReader::read_next(TripRecord& record) {
-    std::string line;
-    
     // Keep reading until we get a valid record or hit EOF
-    while (std::getline(file_, line)) {
+    while (const std::size_t n_fields = next_row()) {
         stats_.rows_read++;
         
         // Skip empty/whitespace-only lines
-        if (line.empty() || (line.find_first_not_of(" \t\r\n") == std::string::npos)) {
+        if (n_fields == 1 && is_blank(fields_[0])) {
             stats_.rows_discarded++;
             continue; // Try next line
         }
         
-        // Try to parse the line
-        if (parse_line(line, record)) {
+        // Try to parse the row
+        if (parse_fields(fields_, n_fields, record)) {
             stats_.rows_parsed_ok++;
             return true; // Successfully parsed a record
         } else {
@@ -58,11 +290,13 @@ bool CsvReader::read_next(TripRecord& record) {
     return false;
 }
 
-bool CsvReader::parse_line(const std::string& line, TripRecord& record) {
+bool CsvReader::parse_fields(const FieldArray& tokens, std::size_t n_tokens,
+                             TripRecord& record) {
     /**
-     * Parse CSV line into TripRecord
-     * 
-     * Expected CSV column order (17 fields):
+     * Convert one row's fields into a TripRecord
+     *
+     * Field positions come from schema_ (the file's header).  Without a usable
+     * header the TLC yellow-taxi order is assumed (17 fields):
      * 0: VendorID
      * 1: tpep_pickup_datetime
      * 2: tpep_dropoff_datetime
@@ -81,205 +315,174 @@ bool CsvReader::parse_line(const std::string& line, TripRecord& record) {
      * 15: improvement_surcharge
      * 16: total_amount
      */
-    
-    try {
-        auto tokens = split_csv_line(line);
-        
-        if (tokens.size() < 17 || tokens.size() > 19) {
-            return false;
-        }
 
-        // Helper lambda to safely parse integer with default
-        auto parse_int = [](const std::string& str, int default_val = 0) -> int {
-            if (str.empty() || str.find_first_not_of(" \t") == std::string::npos) {
-                return default_val;
-            }
-            try {
-                return std::stoi(str);
-            } catch (...) {
-                return default_val;
-            }
-        };
-
-        // Helper lambda to safely parse double with default
-        auto parse_double = [](const std::string& str, double default_val = 0.0) -> double {
-            if (str.empty() || str.find_first_not_of(" \t") == std::string::npos) {
-                return default_val;
-            }
-            try {
-                return std::stod(str);
-            } catch (...) {
-                return default_val;
-            }
-        };
-
-        // Parse critical fields - if these fail, discard the row
-        std::int64_t pickup_ts = parse_timestamp(tokens[1]);
-        std::int64_t dropoff_ts = parse_timestamp(tokens[2]);
-        
-        if (pickup_ts <= 0 || dropoff_ts <= pickup_ts) {
-            return false; // Invalid timestamps - discard row
-        }
-
-        // Parse all fields
-        record.vendor_id = parse_int(tokens[0], 0);
-        record.pickup_timestamp = pickup_ts;
-        record.dropoff_timestamp = dropoff_ts;
-        record.passenger_count = parse_int(tokens[3], 0);
-        record.trip_distance = parse_double(tokens[4], 0.0);
-        record.rate_code_id = parse_int(tokens[5], 0);
-        
-        // Parse store_and_fwd_flag (Y/N -> true/false)
-        std::string flag = tokens[6];
-        std::transform(flag.begin(), flag.end(), flag.begin(), ::toupper);
-        record.store_and_fwd_flag = (flag == "Y" || flag == "YES" || flag == "TRUE" || flag == "1");
-        
-        record.pu_location_id = parse_int(tokens[7], 0);
-        record.do_location_id = parse_int(tokens[8], 0);
-        record.payment_type = parse_int(tokens[9], 0);
-        
-        // Parse monetary fields (normalize empty/missing to 0.0)
-        record.fare_amount = parse_double(tokens[10], 0.0);
-        record.extra = parse_double(tokens[11], 0.0);
-        record.mta_tax = parse_double(tokens[12], 0.0);
-        record.tip_amount = parse_double(tokens[13], 0.0);
-        record.tolls_amount = parse_double(tokens[14], 0.0);
-        record.improvement_surcharge = parse_double(tokens[15], 0.0);
-        record.total_amount = parse_double(tokens[16], 0.0);
-
-        // Validate record meets minimum requirements
-        if (!record.is_valid()) {
-            return false;
-        }
-
-        return true;
-        
-    } catch (const std::exception&) {
-        // Any parsing error - discard row
+    if (!schema_.accepts(n_tokens)) {
         return false;
     }
-}
 
-std::vector<std::string> CsvReader::split_csv_line(const std::string& line) {
-    /**
-     * CSV Line Parser
-     * 
-     * Handles RFC 4180-compliant CSV format:
-     * - Fields may be quoted with double quotes
-     * - Quoted fields may contain commas
-     * - Escaped quotes within quoted fields are represented as ""
-     * - Empty fields are allowed
-     * 
-     * Example: "field1","field,with,commas","field""with""quotes",field4
-     * Results: ["field1", "field,with,commas", "field\"with\"quotes", "field4"]
-     */
-    std::vector<std::string> tokens;
-    std::string current_token;
-    bool in_quotes = false;
+    // Field of column c in this row; columns the schema lacks read as empty.
+    auto field = [&](Column c) -> std::string_view {
+        const int i = schema_[c];
+        return i >= 0 ? tokens[static_cast<std::size_t>(i)] : std::string_view{};
+    };
+
+    // Field decoders (FieldDecoder.hpp): from_chars-based, no allocation,
+    // no exceptions.  Empty or malformed fields fall back to the default.
+    auto parse_int = [](std::string_view str, int default_val = 0) -> int {
+        int v;
+        return decode_int(str, v) ? v : default_val;
+    };
+
+    auto parse_double = [](std::string_view str, double default_val = 0.0) -> double {
+        double v;
+        return decode_double(str, v) ? v : default_val;
+    };
+
+    // Money columns take the fixed-point (integer cents) fast path.
+    auto parse_money = [](std::string_view str, double default_val = 0.0) -> double {
+        double v;
+        return decode_money(str, v) ? v : default_val;
+    };
+
+    // Projected-out columns are not decoded and keep their default value.
+    auto get_int = [&](Column c) {
+        return decode_.has(c) ? parse_int(field(c), 0) : 0;
+    };
+    auto get_money = [&](Column c) {
+        return decode_.has(c) ? parse_money(field(c), 0.0) : 0.0;
+    };
+
+    // Parse critical fields - if these fail, discard the row
+    std::int64_t pickup_ts = parse_timestamp(field(Column::PickupTimestamp));
+    std::int64_t dropoff_ts = parse_timestamp(field(Column::DropoffTimestamp));
     
-    for (std::size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
-        
-        if (c == '"') {
-            if (in_quotes && i + 1 < line.length() && line[i + 1] == '"') {
-                // Escaped quote (double quote) - add single quote to token
-                current_token += '"';
-                ++i; // Skip next quote
-            } else {
-                // Toggle quote state
-                in_quotes = !in_quotes;
-                // Note: We don't add the quote character itself to the token
-            }
-        } else if (c == ',' && !in_quotes) {
-            // Field separator - save current token and start new one
-            tokens.push_back(current_token);
-            current_token.clear();
-        } else {
-            // Regular character - add to current token
-            current_token += c;
-        }
+    if (pickup_ts <= 0 || dropoff_ts <= pickup_ts) {
+        return false; // Invalid timestamps - discard row
     }
+
+    // Parse all requested fields (validation columns always)
+    record.vendor_id = get_int(Column::VendorId);
+    record.pickup_timestamp = pickup_ts;
+    record.dropoff_timestamp = dropoff_ts;
+    record.passenger_count = parse_int(field(Column::PassengerCount), 0);
+    record.trip_distance = parse_double(field(Column::TripDistance), 0.0);
+    record.rate_code_id = get_int(Column::RateCodeId);
+    
+    // Parse store_and_fwd_flag (Y/N -> true/false)
+    const std::string_view flag = decode_.has(Column::StoreAndFwdFlag)
+                                      ? field(Column::StoreAndFwdFlag) : std::string_view{};
+    record.store_and_fwd_flag = iequals(flag, "Y") || iequals(flag, "YES") ||
+                                iequals(flag, "TRUE") || flag == "1";
     
-    // Add the last token (after final comma or end of line)
-    tokens.push_back(current_token);
+    record.pu_location_id = get_int(Column::PuLocationId);
+    record.do_location_id = get_int(Column::DoLocationId);
+    record.payment_type = get_int(Column::PaymentType);
     
-    return tokens;
+    // Parse monetary fields (normalize empty/missing to 0.0)
+    record.fare_amount = get_money(Column::FareAmount);
+    record.extra = get_money(Column::Extra);
+    record.mta_tax = get_money(Column::MtaTax);
+    record.tip_amount = get_money(Column::TipAmount);
+    record.tolls_amount = get_money(Column::TollsAmount);
+    record.improvement_surcharge = get_money(Column::ImprovementSurcharge);
+    record.total_amount = parse_money(field(Column::TotalAmount), 0.0);
+
+    // Validate record meets minimum requirements
+    if (!record.is_valid()) {
+        return false;
+    }
+
+    return true;
 }
 
-std::int64_t CsvReader::parse_timestamp(const std::string& timestamp_str) {
+std::int64_t CsvReader::parse_timestamp(std::string_view timestamp_str) {
     if (timestamp_str.empty()) {
         return 0;
     }
 
-    try {
-        int year = 0, month = 0, day = 0, hour = 0, min = 0, sec = 0;
-        std::string ampm;
-
-        if (timestamp_str.size() >= 2 && timestamp_str[2] == '/') {
-            // Format: "MM/DD/YYYY HH:MM:SS AM/PM"
-            char slash1, slash2, colon1, colon2;
-            std::istringstream ss(timestamp_str);
-            ss >> month >> slash1 >> day >> slash2 >> year
-               >> hour >> colon1 >> min >> colon2 >> sec >> ampm;
-            if (ss.fail()) return 0;
-        } else if (timestamp_str.size() >= 4 &&
-                   std::isdigit(static_cast<unsigned char>(timestamp_str[0])) &&
-                   std::isdigit(static_cast<unsigned char>(timestamp_str[3]))) {
-            // Format: "YYYY MMM DD HH:MM:SS AM/PM"
-            std::string month_str;
-            char colon1, colon2;
-            std::istringstream ss(timestamp_str);
-            ss >> year >> month_str >> day >> hour >> colon1 >> min >> colon2 >> sec >> ampm;
-            if (ss.fail()) return 0;
-
-            const char* months[] = {"Jan","Feb","Mar","Apr","May","Jun",
-                                    "Jul","Aug","Sep","Oct","Nov","Dec"};
-            for (int i = 0; i < 12; ++i) {
-                if (month_str == months[i]) { month = i + 1; break; }
-            }
-            if (month == 0) return 0;
-        } else {
-            // Format: "YYYY-MM-DD HH:MM:SS" (24-hour, no AM/PM)
-            std::tm tm = {};
-            std::istringstream ss(timestamp_str);
-            ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-            if (ss.fail()) return 0;
-            year  = tm.tm_year + 1900;
-            month = tm.tm_mon + 1;
-            day   = tm.tm_mday;
-            hour  = tm.tm_hour;
-            min   = tm.tm_min;
-            sec   = tm.tm_sec;
+    // The layout is fixed per file: sniff it once, then decode every field
+    // with the matching fixed-width parser.
+    if (ts_format_ == TimestampFormat::Unknown) {
+        ts_format_ = detect_timestamp_format(timestamp_str);
+    }
+    // Only hh:mm:ss changes between most rows; the day number of a date
+    // prefix is computed once and then served from date_cache_.
+    const std::size_t date_len = timestamp_date_length(ts_format_);
+    std::int32_t secs;
+    if (date_len > 0 && decode_time_of_day(timestamp_str, ts_format_, secs)) {
+        const std::string_view date = timestamp_str.substr(0, date_len);
+        std::int64_t days;
+        if (date_cache_.find(date, days)) {
+            stats_.timestamp_cache_hits++;
+            return days * 86400LL + secs;
         }
-
-        // 12-hour to 24-hour conversion when AM/PM is present
-        if (!ampm.empty()) {
-            std::transform(ampm.begin(), ampm.end(), ampm.begin(), ::toupper);
-            if (ampm == "PM" && hour != 12) hour += 12;
-            else if (ampm == "AM" && hour == 12) hour = 0;
+        if (decode_civil_date(timestamp_str, ts_format_, days)) {
+            stats_.timestamp_cache_misses++;
+            date_cache_.insert(date, days);
+            return days * 86400LL + secs;
         }
+    }
+    return parse_timestamp_slow(timestamp_str);
+}
 
-        // Days since Unix epoch
-        std::int64_t days_since_epoch = 0;
-        for (int y = 1970; y < year; ++y) {
-            bool leap = ((y % 4 == 0 && y % 100 != 0) || (y % 400 == 0));
-            days_since_epoch += leap ? 366 : 365;
+std::int64_t CsvReader::parse_timestamp_slow(std::string_view timestamp_str) {
+    // Tolerant path for fields that are not in the file's fixed-width layout
+    // (unpadded numbers, a stray row in another format): format chosen per
+    // field, sscanf accepts variable-width numbers.
+    char buf[64];
+    if (!to_cstr(timestamp_str, buf)) {
+        return 0;
+    }
+
+    int year = 0, month = 0, day = 0, hour = 0, min = 0, sec = 0;
+    char ampm[3] = {};
+
+    switch (detect_timestamp_format(timestamp_str)) {
+    case TimestampFormat::UsSlash:
+        // Format: "MM/DD/YYYY HH:MM:SS AM/PM"
+        if (std::sscanf(buf, "%d/%d/%d %d:%d:%d %2s",
+                        &month, &day, &year, &hour, &min, &sec, ampm) != 7) {
+            return 0;
+        }
+        break;
+    case TimestampFormat::YearMonthName: {
+        // Format: "YYYY MMM DD HH:MM:SS AM/PM"
+        char month_str[4] = {};
+        if (std::sscanf(buf, "%d %3s %d %d:%d:%d %2s",
+                        &year, month_str, &day, &hour, &min, &sec, ampm) != 7 ||
+            std::strlen(month_str) != 3) {
+            return 0;
+        }
+        month = detail::month_from_name(month_str);
+        break;
+    }
+    case TimestampFormat::Iso:
+    case TimestampFormat::Unknown:
+        // Format: "YYYY-MM-DD HH:MM:SS" (24-hour, no AM/PM)
+        if (std::sscanf(buf, "%d-%d-%d %d:%d:%d",
+                        &year, &month, &day, &hour, &min, &sec) != 6) {
+            return 0;
         }
-        int days_in_month[] = {31,28,31,30,31,30,31,31,30,31,30,31};
-        if ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0))
-            days_in_month[1] = 29;
-        for (int m = 0; m < month - 1; ++m)
-            days_since_epoch += days_in_month[m];
-        days_since_epoch += day - 1;
-
-        return days_since_epoch * 86400LL
-             + static_cast<std::int64_t>(hour) * 3600LL
-             + static_cast<std::int64_t>(min)  * 60LL
-             + static_cast<std::int64_t>(sec);
-
-    } catch (const std::exception&) {
+        break;
+    }
+
+    // 12-hour to 24-hour conversion when AM/PM is present
+    if (ampm[0] != '\0') {
+        if (iequals(ampm, "PM") && hour != 12) hour += 12;
+        else if (iequals(ampm, "AM") && hour == 12) hour = 0;
+    }
+
+    // Same field ranges std::get_time enforced for %m %d %H %M %S.
+    if (month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour < 0 || hour > 23 || min < 0 || min > 59 ||
+        sec < 0 || sec > 60) {
         return 0;
     }
+
+    return days_from_civil(year, month, day) * 86400LL
+         + static_cast<std::int64_t>(hour) * 3600LL
+         + static_cast<std::int64_t>(min)  * 60LL
+         + static_cast<std::int64_t>(sec);
 }
 
 // ---- Parallel chunk loader --------------------------------------------------
@@ -290,60 +493,51 @@ std::vector<TripRecord> CsvReader::load_chunk(
     std::int64_t byte_end,
     Stats& out_stats)
 {
-    std::ifstream f(path, std::ios::in);
-    if (!f.is_open()) {
+    MappedFile map;
+    if (!map.open(path)) {
         throw std::runtime_error("CsvReader::load_chunk: cannot open " + path);
     }
 
+    const std::string_view bytes = map.view();
+    const auto size = static_cast<std::int64_t>(bytes.size());
+    if (byte_start < 0) byte_start = 0;
+    if (byte_end >= size) byte_end = size - 1;
+
+    std::size_t first;
     if (byte_start > 0) {
-        // Seek into the middle of the file. The byte boundary almost certainly
-        // falls inside a line that started in the previous chunk, so discard
-        // everything up to and including the next newline.  The previous chunk
-        // will have read that line in full, so ownership is unambiguous.
-        f.seekg(byte_start);
-        if (!f.good()) {
-            throw std::runtime_error(
-                "CsvReader::load_chunk: seek failed for " + path);
-        }
-        std::string discard;
-        std::getline(f, discard);
+        // A line belongs to the chunk holding its first byte.  Skip the line
+        // that runs into byte_start (owned by the previous chunk) unless
+        // byte_start is exactly the first byte of a line.
+        const auto nl = bytes.find('\n', static_cast<std::size_t>(byte_start - 1));
+        first = (nl == std::string_view::npos) ? bytes.size() : nl + 1;
     } else {
         // Chunk 0: skip the CSV header row.
-        std::string header;
-        std::getline(f, header);
+        const auto nl = bytes.find('\n');
+        first = (nl == std::string_view::npos) ? bytes.size() : nl + 1;
     }
 
-    // Build a bare CsvReader that owns the already-positioned stream.
-    CsvReader reader;
-    reader.file_ = std::move(f);
-    reader.header_read_ = true;
+    // Extend the chunk to the end of the line containing byte_end so the
+    // last owned line is read in full.
+    std::size_t last = bytes.size();
+    if (byte_end >= 0) {
+        const auto nl = bytes.find('\n', static_cast<std::size_t>(byte_end));
+        if (nl != std::string_view::npos) last = nl + 1;
+    }
 
     std::vector<TripRecord> results;
-    TripRecord rec;
-
-    while (reader.file_.good()) {
-        // Check position BEFORE reading the line so every line is owned by
-        // exactly one chunk: lines whose first byte is <= byte_end belong here.
-        auto pos = static_cast<std::int64_t>(reader.file_.tellg());
-        if (pos < 0 || pos > byte_end) break;
-
-        std::string line;
-        if (!std::getline(reader.file_, line)) break;
-
-        reader.stats_.rows_read++;
-
-        if (line.empty() ||
-            line.find_first_not_of(" \t\r\n") == std::string::npos) {
-            reader.stats_.rows_discarded++;
-            continue;
-        }
+    if (first >= last) {
+        out_stats = Stats();
+        return results;
+    }
 
-        if (reader.parse_line(line, rec)) {
-            reader.stats_.rows_parsed_ok++;
-            results.push_back(rec);
-        } else {
-            reader.stats_.rows_discarded++;
-        }
+    // Bare reader over the owned slice of the mapping, columns located by
+    // the file's header.
+    const auto header_end = bytes.find('\n');
+    const ColumnMap columns = ColumnMap::from_header(bytes.substr(0, header_end));
+    CsvReader reader = from_bytes(bytes.substr(first, last - first), columns);
+    TripRecord rec;
+    while (reader.read_next(rec)) {
+        results.push_back(rec);
     }
 
     out_stats = reader.stats_;
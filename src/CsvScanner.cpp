@@ -0,0 +1,206 @@
+/**
+ * CsvScanner.cpp — structural indexing of CSV buffers (SIMD + scalar).
+ *
+ * Every kernel reduces a 64-byte block to three bitmasks (quote, comma,
+ * newline) and hands them to resolve_block(), so the quote rules live in
+ * exactly one place.  The x86 kernels are compiled with per-function target
+ * attributes and picked at runtime, so the library itself still builds for
+ * the baseline ISA.
+ */
+
+#include "taxi/CsvScanner.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TAXI_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace taxi {
+
+namespace {
+
+// Running XOR from bit 0 upwards: bit i = parity of quotes at positions <= i.
+inline std::uint64_t prefix_xor(std::uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Turn one block's character masks into structural offsets.
+inline std::size_t resolve_block(std::uint64_t quote, std::uint64_t comma,
+                                 std::uint64_t newline, bool& in_quotes,
+                                 std::uint32_t base, std::uint32_t* out) {
+    std::uint64_t inside = prefix_xor(quote);
+    if (in_quotes) inside = ~inside;
+
+    // A newline closes any quote left open on its row: flip the parity of
+    // everything from the newline onwards.  Rows are ~100+ bytes, so this
+    // loop runs at most once per block in practice.
+    for (std::uint64_t nl = newline; nl != 0; nl &= nl - 1) {
+        const int p = __builtin_ctzll(nl);
+        if ((inside >> p) & 1) inside ^= ~std::uint64_t{0} << p;
+    }
+    in_quotes = (inside >> 63) & 1;
+
+    std::uint64_t structural = (comma & ~inside) | newline;
+    std::size_t n = 0;
+    while (structural != 0) {
+        out[n++] = base + static_cast<std::uint32_t>(__builtin_ctzll(structural));
+        structural &= structural - 1;
+    }
+    return n;
+}
+
+std::size_t scan_scalar(const char* data, std::size_t len, std::size_t from,
+                        bool& in_quotes, std::uint32_t* out) {
+    std::size_t n = 0;
+    for (std::size_t i = from; i < len; ++i) {
+        const char c = data[i];
+        if (c == '"') {
+            in_quotes = !in_quotes;
+        } else if (c == '\n') {
+            out[n++] = static_cast<std::uint32_t>(i);
+            in_quotes = false;
+        } else if (c == ',' && !in_quotes) {
+            out[n++] = static_cast<std::uint32_t>(i);
+        }
+    }
+    return n;
+}
+
+#if defined(TAXI_SCAN_X86)
+
+// Byte-compare 16 bytes against a needle -> 16-bit mask (SSE4.2 tier).
+#define TAXI_MASK16(v, needle) \
+    static_cast<std::uint64_t>(static_cast<std::uint16_t>( \
+        _mm_movemask_epi8(_mm_cmpeq_epi8((v), (needle)))))
+
+// Byte-compare 2 x 32 bytes against a needle -> 64-bit mask (AVX2 tier).
+#define TAXI_MASK64(lo, hi, needle) \
+    ((static_cast<std::uint64_t>(static_cast<std::uint32_t>( \
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8((hi), (needle))))) << 32) | \
+     static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8((lo), (needle)))))
+
+__attribute__((target("sse4.2")))
+std::size_t scan_sse42(const char* data, std::size_t len,
+                       bool& in_quotes, std::uint32_t* out) {
+    const __m128i q  = _mm_set1_epi8('"');
+    const __m128i cm = _mm_set1_epi8(',');
+    const __m128i nl = _mm_set1_epi8('\n');
+
+    std::size_t n = 0, i = 0;
+    for (; i + 64 <= len; i += 64) {
+        std::uint64_t mq = 0, mc = 0, mn = 0;
+        for (int k = 0; k < 4; ++k) {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(data + i + 16 * k));
+            mq |= TAXI_MASK16(v, q)  << (16 * k);
+            mc |= TAXI_MASK16(v, cm) << (16 * k);
+            mn |= TAXI_MASK16(v, nl) << (16 * k);
+        }
+        n += resolve_block(mq, mc, mn, in_quotes,
+                           static_cast<std::uint32_t>(i), out + n);
+    }
+    return n + scan_scalar(data, len, i, in_quotes, out + n);
+}
+
+__attribute__((target("avx2")))
+std::size_t scan_avx2(const char* data, std::size_t len,
+                      bool& in_quotes, std::uint32_t* out) {
+    const __m256i q  = _mm256_set1_epi8('"');
+    const __m256i cm = _mm256_set1_epi8(',');
+    const __m256i nl = _mm256_set1_epi8('\n');
+
+    std::size_t n = 0, i = 0;
+    for (; i + 64 <= len; i += 64) {
+        const __m256i lo = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(data + i));
+        const __m256i hi = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(data + i + 32));
+        n += resolve_block(TAXI_MASK64(lo, hi, q), TAXI_MASK64(lo, hi, cm),
+                           TAXI_MASK64(lo, hi, nl), in_quotes,
+                           static_cast<std::uint32_t>(i), out + n);
+    }
+    return n + scan_scalar(data, len, i, in_quotes, out + n);
+}
+
+#undef TAXI_MASK16
+#undef TAXI_MASK64
+
+#endif // TAXI_SCAN_X86
+
+} // namespace
+
+CsvScanner::Kernel CsvScanner::detect() {
+    if (supported(Kernel::Avx2))  return Kernel::Avx2;
+    if (supported(Kernel::Sse42)) return Kernel::Sse42;
+    return Kernel::Scalar;
+}
+
+bool CsvScanner::supported(Kernel k) {
+    switch (k) {
+    case Kernel::Scalar:
+        return true;
+#if defined(TAXI_SCAN_X86)
+    case Kernel::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#else
+    case Kernel::Sse42:
+    case Kernel::Avx2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char* CsvScanner::name(Kernel k) {
+    switch (k) {
+    case Kernel::Scalar: return "scalar";
+    case Kernel::Sse42:  return "sse42";
+    case Kernel::Avx2:   return "avx2";
+    }
+    return "unknown";
+}
+
+CsvScanner::CsvScanner(Kernel kernel)
+    : kernel_(supported(kernel) ? kernel : Kernel::Scalar) {}
+
+std::span<const std::uint32_t> CsvScanner::scan(std::string_view bytes) {
+    const std::size_t len = bytes.size();
+    if (len > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("CsvScanner::scan: buffer exceeds 4 GiB");
+    }
+    // Worst case every byte is structural.
+    if (len > capacity_) {
+        out_ = std::make_unique_for_overwrite<std::uint32_t[]>(len);
+        capacity_ = len;
+    }
+
+    std::size_t n = 0;
+    switch (kernel_) {
+#if defined(TAXI_SCAN_X86)
+    case Kernel::Avx2:
+        n = scan_avx2(bytes.data(), len, in_quotes_, out_.get());
+        break;
+    case Kernel::Sse42:
+        n = scan_sse42(bytes.data(), len, in_quotes_, out_.get());
+        break;
+#endif
+    default:
+        n = scan_scalar(bytes.data(), len, 0, in_quotes_, out_.get());
+        break;
+    }
+    return {out_.get(), n};
+}
+
+} // namespace taxi
@@ -10,11 +10,13 @@ DatasetManager::DatasetManager() : records_(), load_stats_() {
     records_.reserve(1000000); // Reserve for ~1M records initially
 }
 
-void DatasetManager::load_from_csv(const std::string& csv_path) {
+void DatasetManager::load_from_csv(const std::string& csv_path, ReadMode mode) {
     // NOTE: does NOT call clear() — each call APPENDS to existing records.
     // Callers that want a fresh load should call clear() explicitly beforehand.
     try {
-        CsvReader reader(csv_path);
+        // Default: memory-mapped, zero-copy tokenization (no per-row heap
+        // allocation).  The chunked modes tokenize each read buffer in place.
+        CsvReader reader(csv_path, mode);
         if (!reader.is_open()) {
             throw std::runtime_error("Failed to open CSV file: " + csv_path);
         }
@@ -29,6 +31,8 @@ void DatasetManager::load_from_csv(const std::string& csv_path) {
         load_stats_.total_rows_read      += csv_stats.rows_read;
         load_stats_.total_rows_parsed    += csv_stats.rows_parsed_ok;
         load_stats_.total_rows_discarded += csv_stats.rows_discarded;
+        load_stats_.timestamp_cache_hits   += csv_stats.timestamp_cache_hits;
+        load_stats_.timestamp_cache_misses += csv_stats.timestamp_cache_misses;
 
     } catch (const std::runtime_error&) {
         // Re-throw runtime errors (file not found, etc.)
@@ -39,6 +43,18 @@ void DatasetManager::load_from_csv(const std::string& csv_path) {
     }
 }
 
+IngestPipeline::Report DatasetManager::load_from_csv_pipelined(
+    const std::vector<std::string>& csv_paths, const IngestPipeline::Options& opts) {
+    auto report = IngestPipeline(opts).load(csv_paths, records_);
+
+    load_stats_.total_rows_read        += report.stats.rows_read;
+    load_stats_.total_rows_parsed      += report.stats.rows_parsed_ok;
+    load_stats_.total_rows_discarded   += report.stats.rows_discarded;
+    load_stats_.timestamp_cache_hits   += report.stats.timestamp_cache_hits;
+    load_stats_.timestamp_cache_misses += report.stats.timestamp_cache_misses;
+    return report;
+}
+
 void DatasetManager::clear() {
     records_.clear();
     load_stats_ = LoadStats();
@@ -0,0 +1,431 @@
+#include "taxi/FileSource.hpp"
+#include "taxi/Compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(TAXI_HAVE_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace taxi {
+
+namespace {
+
+// O_DIRECT needs buffer addresses, offsets and lengths aligned to the
+// logical block size; 4 KB covers every common device.
+constexpr std::size_t kDirectAlign = 4096;
+
+// FileSource::set_short_first_read(): 0 unless a test asked for it.
+std::atomic<std::size_t> g_short_first_read{0};
+
+// Owning file descriptor.
+class Fd {
+public:
+    explicit Fd(int fd = -1) : fd_(fd) {}
+    ~Fd() { if (fd_ >= 0) ::close(fd_); }
+    Fd(Fd&& o) noexcept : fd_(std::exchange(o.fd_, -1)) {}
+    Fd& operator=(Fd&& o) noexcept {
+        std::swap(fd_, o.fd_);
+        return *this;
+    }
+    Fd(const Fd&) = delete;
+    Fd& operator=(const Fd&) = delete;
+
+    int get() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+[[noreturn]] void throw_errno(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string("FileSource: ") + what + " " + path + ": " +
+                             std::strerror(errno));
+}
+
+// ---- Buffered: read() through the page cache -------------------------------
+
+class BufferedSource final : public FileSource {
+public:
+    BufferedSource(Fd fd, std::uint64_t size, std::string path, std::size_t chunk_bytes)
+        : fd_(std::move(fd)), path_(std::move(path)), buf_(chunk_bytes) {
+        size_ = size;
+#if defined(POSIX_FADV_SEQUENTIAL)
+        ::posix_fadvise(fd_.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+
+    std::string_view next() override {
+        std::size_t n = 0;
+        while (n < buf_.size()) {
+            const ssize_t r = ::read(fd_.get(), buf_.data() + n, buf_.size() - n);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw_errno("read failed:", path_);
+            }
+            if (r == 0) break;
+            n += static_cast<std::size_t>(r);
+        }
+        return {buf_.data(), n};
+    }
+
+    const char* name() const override { return "read"; }
+
+private:
+    Fd                fd_;
+    std::string       path_;
+    std::vector<char> buf_;
+};
+
+// ---- Pread: explicit offsets, kernel read-ahead, no cache residue -----------
+
+class PreadSource final : public FileSource {
+public:
+    PreadSource(Fd fd, std::uint64_t size, std::string path, std::size_t chunk_bytes)
+        : fd_(std::move(fd)), path_(std::move(path)), buf_(chunk_bytes) {
+        size_ = size;
+        advise(0, buf_.size(), POSIX_FADV_WILLNEED);
+    }
+
+    std::string_view next() override {
+        if (offset_ >= size_) return {};
+        const std::size_t want = static_cast<std::size_t>(
+            std::min<std::uint64_t>(buf_.size(), size_ - offset_));
+        std::size_t n = 0;
+        while (n < want) {
+            const ssize_t r = ::pread(fd_.get(), buf_.data() + n, want - n,
+                                      static_cast<off_t>(offset_ + n));
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                throw_errno("pread failed:", path_);
+            }
+            if (r == 0) break;   // truncated under us
+            n += static_cast<std::size_t>(r);
+        }
+        // The bytes are in buf_ now: drop their cache pages, and start
+        // reading the next chunk in the background while this one is parsed.
+        advise(offset_, n, POSIX_FADV_DONTNEED);
+        offset_ += n;
+        advise(offset_, buf_.size(), POSIX_FADV_WILLNEED);
+        return {buf_.data(), n};
+    }
+
+    const char* name() const override { return "pread+fadvise"; }
+
+private:
+    void advise(std::uint64_t off, std::size_t len, int advice) const {
+        if (len > 0) ::posix_fadvise(fd_.get(), static_cast<off_t>(off),
+                                     static_cast<off_t>(len), advice);
+    }
+
+    Fd                fd_;
+    std::string       path_;
+    std::vector<char> buf_;
+    std::uint64_t     offset_ = 0;
+};
+
+#if defined(TAXI_HAVE_IO_URING)
+
+// ---- Minimal io_uring (raw syscalls, no liburing dependency) ----------------
+
+class Uring {
+public:
+    Uring() = default;
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+
+    ~Uring() {
+        if (sqes_) ::munmap(sqes_, sqes_bytes_);
+        if (cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_bytes_);
+        if (sq_ring_) ::munmap(sq_ring_, sq_bytes_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    /// @return false if io_uring is not available.
+    bool init(unsigned entries) {
+        io_uring_params p{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) return false;
+
+        sq_bytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+
+        sq_ring_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+        if (!sq_ring_) return false;
+        cq_ring_ = single ? sq_ring_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+        if (!cq_ring_) return false;
+        sqes_bytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqes_bytes_, IORING_OFF_SQES));
+        if (!sqes_) return false;
+
+        auto* sq = static_cast<char*>(sq_ring_);
+        auto* cq = static_cast<char*>(cq_ring_);
+        sq_tail_  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_  = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_head_  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_  = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_     = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    /// Queue and submit one read.  @return false if the kernel rejected it.
+    bool read(int fd, char* buf, unsigned len, std::uint64_t off, std::uint64_t tag) {
+        const unsigned tail = *sq_tail_;   // single submitter
+        const unsigned idx  = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[idx];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = IORING_OP_READ;
+        sqe.fd        = fd;
+        sqe.addr      = reinterpret_cast<std::uint64_t>(buf);
+        sqe.len       = len;
+        sqe.off       = off;
+        sqe.user_data = tag;
+        sq_array_[idx] = idx;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        for (;;) {
+            const long r = ::syscall(__NR_io_uring_enter, fd_, 1, 0, 0, nullptr, 0);
+            if (r >= 0) return r == 1;
+            if (errno != EINTR) return false;
+        }
+    }
+
+    /// Block until one completion arrives.  @return false on ring error.
+    bool wait(std::uint64_t& tag, int& res) {
+        for (;;) {
+            const unsigned head = *cq_head_;   // single consumer
+            const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+            if (head != tail) {
+                const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                tag = cqe.user_data;
+                res = cqe.res;
+                std::atomic_ref<unsigned>(*cq_head_).store(head + 1, std::memory_order_release);
+                return true;
+            }
+            const long r = ::syscall(__NR_io_uring_enter, fd_, 0, 1,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r < 0 && errno != EINTR) return false;
+        }
+    }
+
+private:
+    void* map(std::size_t bytes, off_t what) const {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd_, what);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    int           fd_ = -1;
+    void*         sq_ring_ = nullptr;
+    void*         cq_ring_ = nullptr;
+    io_uring_sqe* sqes_    = nullptr;
+    std::size_t   sq_bytes_ = 0, cq_bytes_ = 0, sqes_bytes_ = 0;
+    unsigned*     sq_tail_  = nullptr;
+    unsigned*     sq_array_ = nullptr;
+    unsigned      sq_mask_  = 0;
+    unsigned*     cq_head_  = nullptr;
+    unsigned*     cq_tail_  = nullptr;
+    unsigned      cq_mask_  = 0;
+    io_uring_cqe* cqes_     = nullptr;
+};
+
+// ---- Direct: O_DIRECT reads in flight on a ring of three buffers ------------
+
+class UringSource final : public FileSource {
+public:
+    static constexpr int kBuffers = 3;   // one parsed, two in flight
+
+    UringSource(std::uint64_t size, std::string path, std::size_t chunk_bytes)
+        : path_(std::move(path)),
+          chunk_((chunk_bytes + kDirectAlign - 1) / kDirectAlign * kDirectAlign) {
+        size_ = size;
+    }
+
+    ~UringSource() override {
+        // The kernel may still be writing into our buffers: reap every
+        // outstanding read before they are freed.
+        for (int i = 0; i < kBuffers; ++i) {
+            while (slots_[i].in_flight && !slots_[i].done && reap()) {}
+        }
+        for (auto& s : slots_) std::free(s.buf);
+    }
+
+    /// Set up the ring and queue the first reads.  @return false to fall back.
+    bool start(Fd fd, bool direct) {
+        if (!ring_.init(kBuffers)) return false;
+        for (auto& s : slots_) {
+            void* p = nullptr;
+            if (::posix_memalign(&p, kDirectAlign, chunk_) != 0) throw std::bad_alloc();
+            s.buf = static_cast<char*>(p);
+        }
+        fd_     = std::move(fd);
+        direct_ = direct;
+        short_first_read_ = g_short_first_read.load(std::memory_order_relaxed);
+        for (int i = 0; i < kBuffers; ++i) {
+            if (!issue(i)) return false;
+        }
+        return true;
+    }
+
+    std::string_view next() override {
+        if (handed_out_ >= 0) {
+            // The caller is done with the previous chunk: refill that buffer.
+            if (!issue(handed_out_)) throw std::runtime_error("FileSource: io_uring submit failed: " + path_);
+            handed_out_ = -1;
+        }
+
+        const int i = turn_;
+        Slot& s = slots_[i];
+        if (!s.in_flight) return {};   // end of file
+        while (!s.done) {
+            if (!reap()) throw_errno("io_uring wait failed:", path_);
+        }
+        if (s.res < 0) {
+            errno = -s.res;
+            throw_errno("io_uring read failed:", path_);
+        }
+
+        // A short read before EOF is finished synchronously.  O_DIRECT
+        // needs the offset, length and buffer aligned, so the read restarts
+        // at the block holding the first missing byte; s.offset is a chunk
+        // boundary, so the same block of s.buf is aligned too.
+        const std::size_t expected = static_cast<std::size_t>(
+            std::min<std::uint64_t>(chunk_, size_ - s.offset));
+        std::size_t got = static_cast<std::size_t>(s.res);
+        if (s.offset == 0 && short_first_read_ > 0) got = std::min(got, short_first_read_);
+        while (got < expected) {
+            const std::size_t from = direct_ ? got / kDirectAlign * kDirectAlign : got;
+            const ssize_t r = ::pread(fd_.get(), s.buf + from, chunk_ - from,
+                                      static_cast<off_t>(s.offset + from));
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) throw_errno("pread failed:", path_);
+            if (from + static_cast<std::size_t>(r) <= got) break;   // EOF
+            got = from + static_cast<std::size_t>(r);
+        }
+
+        s.in_flight = false;
+        handed_out_ = i;
+        turn_ = (turn_ + 1) % kBuffers;
+        return {s.buf, std::min(got, expected)};
+    }
+
+    const char* name() const override {
+        return direct_ ? "io_uring+O_DIRECT" : "io_uring";
+    }
+
+private:
+    struct Slot {
+        char*         buf = nullptr;
+        std::uint64_t offset = 0;
+        int           res = 0;
+        bool          in_flight = false;
+        bool          done = false;
+    };
+
+    // Queue the next chunk of the file into slot i (no-op past EOF).
+    bool issue(int i) {
+        Slot& s = slots_[i];
+        if (next_offset_ >= size_) {
+            s.in_flight = false;
+            return true;
+        }
+        s.offset    = next_offset_;
+        s.in_flight = true;
+        s.done      = false;
+        next_offset_ += chunk_;
+        // Whole aligned chunk even at the tail: O_DIRECT lengths must be
+        // block multiples; the kernel stops at EOF.
+        return ring_.read(fd_.get(), s.buf, static_cast<unsigned>(chunk_), s.offset,
+                          static_cast<std::uint64_t>(i));
+    }
+
+    bool reap() {
+        std::uint64_t tag;
+        int res;
+        if (!ring_.wait(tag, res) || tag >= kBuffers) return false;
+        slots_[tag].res  = res;
+        slots_[tag].done = true;
+        return true;
+    }
+
+    Uring         ring_;
+    Fd            fd_;
+    std::string   path_;
+    std::size_t   chunk_;
+    bool          direct_ = false;
+    std::size_t   short_first_read_ = 0;
+    Slot          slots_[kBuffers];
+    std::uint64_t next_offset_ = 0;
+    int           turn_ = 0;
+    int           handed_out_ = -1;
+};
+
+#endif // TAXI_HAVE_IO_URING
+
+// The file's bytes as stored, through @p backend or its fallback.
+std::unique_ptr<FileSource> open_raw(const std::string& path, FileSource::Backend backend,
+                                     std::size_t chunk_bytes) {
+    using Backend = FileSource::Backend;
+    Fd fd(::open(path.c_str(), O_RDONLY));
+    if (fd.get() < 0) throw_errno("cannot open", path);
+    struct stat st{};
+    if (::fstat(fd.get(), &st) != 0) throw_errno("cannot stat", path);
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+
+    // Offsets and sizes only mean something for regular files.
+    if (!S_ISREG(st.st_mode)) backend = Backend::Buffered;
+
+    switch (backend) {
+    case Backend::Buffered:
+        return std::make_unique<BufferedSource>(std::move(fd), size, path, chunk_bytes);
+    case Backend::Pread:
+        break;
+    case Backend::Direct: {
+#if defined(TAXI_HAVE_IO_URING)
+        Fd direct_fd(::open(path.c_str(), O_RDONLY | O_DIRECT));
+        const bool direct = direct_fd.get() >= 0;
+        auto src = std::make_unique<UringSource>(size, path, chunk_bytes);
+        if (src->start(direct ? std::move(direct_fd) : std::move(fd), direct)) {
+            return src;
+        }
+        if (fd.get() < 0) {   // handed to the failed ring: reopen for the fallback
+            fd = Fd(::open(path.c_str(), O_RDONLY));
+            if (fd.get() < 0) throw_errno("cannot open", path);
+        }
+#endif
+        break;
+    }
+    }
+    return std::make_unique<PreadSource>(std::move(fd), size, path, chunk_bytes);
+}
+
+} // namespace
+
+void FileSource::set_short_first_read(std::size_t bytes) {
+    g_short_first_read.store(bytes, std::memory_order_relaxed);
+}
+
+std::unique_ptr<FileSource> FileSource::open(const std::string& path, Backend backend,
+                                             std::size_t chunk_bytes) {
+    if (chunk_bytes == 0) chunk_bytes = kDefaultChunkBytes;
+    return make_decompressing_source(open_raw(path, backend, chunk_bytes),
+                                     file_compression(path), path, chunk_bytes);
+}
+
+} // namespace taxi
@@ -0,0 +1,53 @@
+#include "taxi/HotColdTrips.hpp"
+
+namespace taxi {
+
+void HotColdTrips::reserve(std::size_t n)
+{
+    hot.reserve(n);
+    cold.reserve(n);
+}
+
+void HotColdTrips::push_back(const TripRecord& r)
+{
+    hot.push_back({r.pickup_timestamp, r.trip_distance, r.fare_amount, r.total_amount,
+                   r.passenger_count, r.pu_location_id});
+    cold.push_back({r.dropoff_timestamp, r.extra, r.mta_tax, r.tip_amount, r.tolls_amount,
+                    r.improvement_surcharge, r.vendor_id, r.rate_code_id, r.do_location_id,
+                    r.payment_type, r.store_and_fwd_flag});
+}
+
+TripRecord HotColdTrips::record(std::size_t i) const
+{
+    const TripHot&  h = hot[i];
+    const TripCold& c = cold[i];
+    TripRecord r;
+    r.vendor_id             = c.vendor_id;
+    r.pickup_timestamp      = h.pickup_timestamp;
+    r.dropoff_timestamp     = c.dropoff_timestamp;
+    r.passenger_count       = h.passenger_count;
+    r.trip_distance         = h.trip_distance;
+    r.rate_code_id          = c.rate_code_id;
+    r.store_and_fwd_flag    = c.store_and_fwd_flag;
+    r.pu_location_id        = h.pu_location_id;
+    r.do_location_id        = c.do_location_id;
+    r.payment_type          = c.payment_type;
+    r.fare_amount           = h.fare_amount;
+    r.extra                 = c.extra;
+    r.mta_tax               = c.mta_tax;
+    r.tip_amount            = c.tip_amount;
+    r.tolls_amount          = c.tolls_amount;
+    r.improvement_surcharge = c.improvement_surcharge;
+    r.total_amount          = h.total_amount;
+    return r;
+}
+
+HotColdTrips HotColdTrips::from_aos(std::span<const TripRecord> records)
+{
+    HotColdTrips out;
+    out.reserve(records.size());
+    for (const auto& r : records) out.push_back(r);
+    return out;
+}
+
+} // namespace taxi
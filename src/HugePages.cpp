@@ -0,0 +1,133 @@
+#include "taxi/HugePages.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include <sys/mman.h>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace taxi {
+
+namespace {
+
+std::atomic<PagePolicy>  g_policy{PagePolicy::Huge};
+std::atomic<std::size_t> g_explicit_bytes{0};
+std::atomic<std::size_t> g_thp_bytes{0};
+std::atomic<std::size_t> g_small_bytes{0};
+
+// Counter each live mapping was added to, so huge_deallocate() can take its
+// bytes back off.  Only >= 2 MB allocations land here, so a locked map is
+// cheap next to the mmap / munmap around it.
+std::mutex                                           g_live_mu;
+std::unordered_map<void*, std::atomic<std::size_t>*> g_live;
+
+void* track(void* p, std::atomic<std::size_t>& counter, std::size_t len) {
+    counter += len;
+    std::lock_guard<std::mutex> lock(g_live_mu);
+    g_live.emplace(p, &counter);
+    return p;
+}
+
+std::size_t round_up(std::size_t bytes) {
+    return (bytes + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+}
+
+} // namespace
+
+void set_page_policy(PagePolicy policy) { g_policy = policy; }
+PagePolicy page_policy() { return g_policy; }
+
+void* huge_allocate(std::size_t bytes)
+{
+    const std::size_t len  = round_up(bytes);
+    const bool        huge = g_policy == PagePolicy::Huge;
+
+#if defined(MAP_HUGETLB)
+    // Explicit pool: reserved at mmap time, so a short pool fails here
+    // rather than at a later page fault.
+    if (huge) {
+        void* p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return track(p, g_explicit_bytes, len);
+    }
+#endif
+
+    // Over-map by one huge page and trim to a 2 MB aligned range, so that
+    // every 2 MB of the column can become one huge page.
+    void* raw = ::mmap(nullptr, len + kHugePageBytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) throw std::bad_alloc();
+    const auto base    = reinterpret_cast<std::uintptr_t>(raw);
+    const auto aligned = (base + kHugePageBytes - 1) & ~(kHugePageBytes - 1);
+    if (aligned > base) ::munmap(raw, aligned - base);
+    const std::size_t tail = base + len + kHugePageBytes - (aligned + len);
+    if (tail > 0) ::munmap(reinterpret_cast<void*>(aligned + len), tail);
+
+    void* p = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(p, len, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+#endif
+    return track(p, huge ? g_thp_bytes : g_small_bytes, len);
+}
+
+void huge_deallocate(void* p, std::size_t bytes) noexcept
+{
+    // Same call for both kinds: the explicit pool takes whole huge pages.
+    const std::size_t len = round_up(bytes);
+    ::munmap(p, len);
+
+    std::lock_guard<std::mutex> lock(g_live_mu);
+    const auto it = g_live.find(p);
+    if (it == g_live.end()) return;
+    *it->second -= len;
+    g_live.erase(it);
+}
+
+void first_touch_zero(void* p, std::size_t bytes)
+{
+    char* const bytes_at = static_cast<char*>(p);
+    bool serial = bytes < 2 * kHugePageBytes;
+#if defined(_OPENMP)
+    serial = serial || omp_in_parallel();
+#endif
+    if (serial) {
+        std::memset(bytes_at, 0, bytes);
+        return;
+    }
+    const auto chunks = static_cast<std::ptrdiff_t>((bytes + kHugePageBytes - 1) / kHugePageBytes);
+    #pragma omp parallel for schedule(static)
+    for (std::ptrdiff_t c = 0; c < chunks; ++c) {
+        const std::size_t first = static_cast<std::size_t>(c) * kHugePageBytes;
+        std::memset(bytes_at + first, 0, std::min(kHugePageBytes, bytes - first));
+    }
+}
+
+HugePageStats huge_page_stats()
+{
+    return {g_explicit_bytes, g_thp_bytes, g_small_bytes};
+}
+
+std::size_t anon_huge_page_bytes()
+{
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("AnonHugePages:", 0) != 0) continue;
+        std::istringstream fields(line.substr(14));
+        std::size_t kb = 0;
+        fields >> kb;
+        return kb * 1024;
+    }
+    return 0;
+}
+
+} // namespace taxi
@@ -0,0 +1,343 @@
+#include "taxi/IngestPipeline.hpp"
+#include "taxi/BoundedQueue.hpp"
+#include "taxi/Compression.hpp"
+#include "taxi/FileSource.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace taxi {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ms_between(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+// Open file descriptors, closed on scope exit.  Compressed inputs are read
+// through a decompressing FileSource instead of their descriptor.
+struct InputFiles {
+    std::vector<int>                         fds;
+    std::vector<std::unique_ptr<FileSource>> sources;
+    std::vector<std::string_view>            pending;   // undelivered source bytes
+    ~InputFiles() {
+        for (int fd : fds) ::close(fd);
+    }
+
+    // read(2) semantics for input f (decompressed if needed).
+    ssize_t read(std::size_t f, char* dst, std::size_t n) {
+        if (!sources[f]) return ::read(fds[f], dst, n);
+        if (pending[f].empty()) pending[f] = sources[f]->next();
+        const std::size_t k = std::min(n, pending[f].size());
+        std::memcpy(dst, pending[f].data(), k);
+        pending[f].remove_prefix(k);
+        return static_cast<ssize_t>(k);
+    }
+};
+
+// Bytes [begin, len) of pool buffer `buf` are whole CSV lines of input `file`.
+struct Batch {
+    std::size_t seq   = 0;
+    int         buf   = -1;
+    std::size_t begin = 0;
+    std::size_t len   = 0;
+    std::size_t file  = 0;
+};
+
+template <typename Table>
+struct Parsed {
+    std::size_t      seq = 0;
+    Table            rows;
+    CsvReader::Stats stats;
+};
+
+// @p empty is a part buffer storing the columns to parse (@p columns).
+template <typename Table, typename Append>
+IngestPipeline::Report run_pipeline(const std::vector<std::string>& paths,
+                                    const IngestPipeline::Options& opts,
+                                    Table& out, const Table& empty,
+                                    ColumnSet columns, Append append) {
+    const auto wall_start = Clock::now();
+
+    // Open everything up front so a bad path fails before any thread starts.
+    InputFiles files;
+    for (const auto& path : paths) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("IngestPipeline: cannot open file: " + path);
+        }
+        files.fds.push_back(fd);
+#if defined(POSIX_FADV_SEQUENTIAL)
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        // Decompression runs in the reader stage, overlapped with parsing.
+        files.sources.push_back(file_compression(path) != Compression::None
+                                    ? FileSource::open(path, FileSource::Backend::Buffered)
+                                    : nullptr);
+        files.pending.emplace_back();
+    }
+
+    const int         parsers   = std::max(1, opts.parser_threads);
+    const std::size_t depth     = std::max<std::size_t>(2, opts.queue_depth);
+    const std::size_t buf_bytes = std::max<std::size_t>(1024, opts.buffer_bytes);
+
+    // Buffer pool: the reader can be at most n_bufs batches ahead of the
+    // parsers, which bounds memory no matter how large the input is.
+    const int n_bufs = static_cast<int>(depth) + parsers;
+    std::vector<std::unique_ptr<char[]>> pool(n_bufs);
+    for (auto& b : pool) b = std::make_unique_for_overwrite<char[]>(buf_bytes);
+
+    BoundedQueue<int>           free_q(static_cast<std::size_t>(n_bufs));
+    BoundedQueue<Batch>         work_q(depth);
+    BoundedQueue<Parsed<Table>> parsed_q(depth);
+    for (int b = 0; b < n_bufs; ++b) free_q.push(b);
+
+    // Reorder window: batch seq is queued only once seq < placed + window.
+    // Parsers hand their buffer back before the batch is placed, so without
+    // it one slow batch would let the reorder map below grow unbounded.
+    const std::size_t window = static_cast<std::size_t>(n_bufs);
+    std::atomic<std::size_t> placed{0};
+
+    IngestPipeline::Report report;
+    report.reader.threads = 1;
+    report.parser.threads = parsers;
+    report.placer.threads = 1;
+
+    std::string reader_error;
+    std::size_t batches = 0;
+
+    // First exception of any stage.  fail() stops every stage: the queues
+    // close, and blocked pushes and waits give up once `failed` is set.
+    std::mutex          error_mu;
+    std::exception_ptr  error;
+    std::atomic<bool>   failed{false};
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard<std::mutex> lock(error_mu);
+            if (!error) error = e;
+        }
+        failed.store(true, std::memory_order_release);
+        free_q.close();
+        work_q.close();
+        parsed_q.close();
+    };
+
+    // Written by the reader from each file's header before that file's
+    // first batch is queued; the queue hand-off publishes it to parsers.
+    std::vector<ColumnMap> column_maps(paths.size(), ColumnMap::tlc_default());
+
+    // ---- Stage 1: reader ----------------------------------------------------
+    // One thread reads the files back to back: they share one disk, and
+    // batches of consecutive files are parsed concurrently anyway.
+    std::thread reader([&]() {
+        double busy = 0.0, idle = 0.0;
+        std::vector<char> carry;   // partial last line of the previous batch
+        std::size_t seq = 0;
+
+        try {
+            for (std::size_t f = 0; f < files.fds.size() && reader_error.empty() &&
+                                    !failed.load(std::memory_order_acquire); ++f) {
+                bool at_file_start = true;
+                bool eof = false;
+                while (!eof && !failed.load(std::memory_order_acquire)) {
+                    auto t0 = Clock::now();
+                    int b = -1;
+                    if (!free_q.pop(b)) break;   // closed: the pipeline failed
+                    auto t1 = Clock::now();
+                    idle += ms_between(t0, t1);
+
+                    char* buf = pool[b].get();
+                    std::size_t n = carry.size();
+                    if (n > 0) std::memcpy(buf, carry.data(), n);
+                    carry.clear();
+                    try {
+                        while (n < buf_bytes) {
+                            const ssize_t r = files.read(f, buf + n, buf_bytes - n);
+                            if (r < 0) { reader_error = "read failed: " + paths[f]; break; }
+                            if (r == 0) { eof = true; break; }
+                            n += static_cast<std::size_t>(r);
+                        }
+                    } catch (const std::exception& e) {
+                        reader_error = e.what();
+                    }
+                    if (!reader_error.empty()) break;
+
+                    std::size_t begin = 0;
+                    if (at_file_start) {   // map and drop this file's header row
+                        const void* nl = std::memchr(buf, '\n', n);
+                        if (!nl && !eof) { reader_error = "header longer than buffer: " + paths[f]; break; }
+                        begin = nl ? static_cast<std::size_t>(static_cast<const char*>(nl) - buf) + 1 : n;
+                        column_maps[f] = ColumnMap::from_header(std::string_view(buf, begin));
+                        at_file_start = false;
+                    }
+
+                    // Cut after the last newline; the tail goes to the next batch.
+                    std::size_t cut = n;
+                    if (!eof) {
+                        const std::string_view body(buf + begin, n - begin);
+                        const auto nl = body.rfind('\n');
+                        if (nl == std::string_view::npos) {
+                            reader_error = "line longer than buffer: " + paths[f];
+                            break;
+                        }
+                        cut = begin + nl + 1;
+                        carry.assign(buf + cut, buf + n);
+                    }
+                    auto t2 = Clock::now();
+                    busy += ms_between(t1, t2);
+
+                    if (cut > begin) {
+                        for (unsigned spins = 0;
+                             seq >= placed.load(std::memory_order_acquire) + window &&
+                             !failed.load(std::memory_order_acquire);
+                             ++spins) {
+                            if (spins >= 64) std::this_thread::yield();
+                        }
+                        if (!work_q.push(Batch{seq++, b, begin, cut, f}, failed)) break;
+                    } else {
+                        free_q.push(b);
+                    }
+                    idle += ms_between(t2, Clock::now());
+                }
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        batches = seq;
+        report.reader.busy_ms = busy;
+        report.reader.idle_ms = idle;
+        work_q.close();
+    });
+
+    // ---- Stage 2: parser pool -----------------------------------------------
+    std::atomic<int>    parsers_left{parsers};
+    std::vector<double> parser_busy(parsers, 0.0), parser_idle(parsers, 0.0);
+    std::vector<std::thread> parser_threads;
+    parser_threads.reserve(parsers);
+    for (int t = 0; t < parsers; ++t) {
+        parser_threads.emplace_back([&, t]() {
+            Batch batch;
+            try {
+                for (;;) {
+                    auto t0 = Clock::now();
+                    const bool got = work_q.pop(batch);
+                    auto t1 = Clock::now();
+                    parser_idle[t] += ms_between(t0, t1);
+                    if (!got || failed.load(std::memory_order_acquire)) break;
+
+                    Parsed<Table> parsed;
+                    parsed.seq  = batch.seq;
+                    parsed.rows = empty;
+                    CsvReader reader = CsvReader::from_bytes(
+                        std::string_view(pool[batch.buf].get() + batch.begin,
+                                         batch.len - batch.begin),
+                        column_maps[batch.file], columns);
+                    TripRecord rec;
+                    while (reader.read_next(rec)) {
+                        parsed.rows.push_back(rec);
+                    }
+                    parsed.stats = reader.get_stats();
+                    free_q.push(batch.buf);   // never blocks: sized for the pool
+                    auto t2 = Clock::now();
+                    parser_busy[t] += ms_between(t1, t2);
+
+                    if (!parsed_q.push(std::move(parsed), failed)) break;
+                    parser_idle[t] += ms_between(t2, Clock::now());
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            if (parsers_left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                parsed_q.close();
+            }
+        });
+    }
+
+    // ---- Stage 3: placer (this thread) --------------------------------------
+    // Batches finish out of order; hold early ones until their turn so the
+    // output keeps file order.  The reorder window caps `pending`.
+    try {
+        double busy = 0.0, idle = 0.0;
+        std::map<std::size_t, Parsed<Table>> pending;
+        std::size_t next = 0;
+        Parsed<Table> parsed;
+        for (;;) {
+            auto t0 = Clock::now();
+            const bool got = parsed_q.pop(parsed);
+            auto t1 = Clock::now();
+            idle += ms_between(t0, t1);
+            if (!got || failed.load(std::memory_order_acquire)) break;
+
+            const std::size_t seq = parsed.seq;
+            pending.emplace(seq, std::move(parsed));
+            for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+                append(out, it->second.rows);
+                report.stats += it->second.stats;
+                pending.erase(it);
+                placed.store(++next, std::memory_order_release);
+            }
+            busy += ms_between(t1, Clock::now());
+        }
+        report.placer.busy_ms = busy;
+        report.placer.idle_ms = idle;
+    } catch (...) {
+        fail(std::current_exception());
+    }
+
+    reader.join();
+    for (auto& t : parser_threads) t.join();
+
+    if (error) std::rethrow_exception(error);
+    if (!reader_error.empty()) {
+        throw std::runtime_error("IngestPipeline: " + reader_error);
+    }
+
+    for (int t = 0; t < parsers; ++t) {
+        report.parser.busy_ms += parser_busy[t];
+        report.parser.idle_ms += parser_idle[t];
+    }
+    report.batches = batches;
+    for (int fd : files.fds) {
+        const off_t size = ::lseek(fd, 0, SEEK_END);
+        if (size > 0) report.bytes_read += static_cast<std::size_t>(size);
+    }
+    report.wall_ms = ms_between(wall_start, Clock::now());
+    return report;
+}
+
+} // namespace
+
+IngestPipeline::Report IngestPipeline::load(const std::vector<std::string>& paths,
+                                            TripDataSoA& out) const {
+    return run_pipeline<TripDataSoA>(paths, opts_, out, TripDataSoA(out.columns()),
+                                     out.columns(),
+        [](TripDataSoA& dst, const TripDataSoA& rows) {
+            const std::size_t at = dst.size();
+            dst.resize_for_overwrite(at + rows.size());
+            dst.assign_rows(at, rows);
+        });
+}
+
+IngestPipeline::Report IngestPipeline::load(const std::vector<std::string>& paths,
+                                            TripRecords& out) const {
+    return run_pipeline<TripRecords>(paths, opts_, out, {}, ColumnSet::all(),
+        [](TripRecords& dst, const TripRecords& rows) {
+            dst.insert(dst.end(), rows.begin(), rows.end());
+        });
+}
+
+} // namespace taxi
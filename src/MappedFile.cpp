@@ -0,0 +1,104 @@
+#include "taxi/MappedFile.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace taxi {
+
+MappedFile::MappedFile(const std::string& path, Mode mode) {
+    if (!open(path, mode)) {
+        throw std::runtime_error("MappedFile: cannot map file: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      open_(std::exchange(other.open_, false)),
+      mode_(other.mode_) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+        mode_ = other.mode_;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path, Mode mode) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    const auto len = static_cast<std::size_t>(st.st_size);
+    if (len > 0) {
+        const int prot = mode == Mode::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* p = ::mmap(nullptr, len, prot, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        data_ = static_cast<const char*>(p);
+    }
+    // The mapping keeps its own reference to the file; the descriptor is
+    // no longer needed.
+    ::close(fd);
+
+    size_ = len;
+    open_ = true;
+    mode_ = mode;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+void MappedFile::advise_sequential() const {
+    if (data_ != nullptr) {
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::advise(const void* p, std::size_t bytes, Access access) const {
+    if (data_ == nullptr || bytes == 0) return;
+    static const std::uintptr_t page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<std::uintptr_t>(p) & ~(page - 1);
+    const auto end   = reinterpret_cast<std::uintptr_t>(p) + bytes;
+    int advice = MADV_NORMAL;
+    switch (access) {
+        case Access::Normal:     advice = MADV_NORMAL;     break;
+        case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+        case Access::Random:     advice = MADV_RANDOM;     break;
+        case Access::WillNeed:   advice = MADV_WILLNEED;   break;
+        case Access::DontNeed:   advice = MADV_DONTNEED;   break;
+    }
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+}
+
+} // namespace taxi
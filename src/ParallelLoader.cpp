@@ -1,90 +1,309 @@
 #include "taxi/ParallelLoader.hpp"
-#include "taxi/BenchmarkRunner.hpp"
+#include "taxi/MappedFile.hpp"
+#include "taxi/Compression.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <fstream>
 #include <stdexcept>
 #include <thread>
 #include <vector>
 
 namespace taxi {
 
-ParallelLoader::Result ParallelLoader::load(const std::string& path,
-                                             int num_threads)
-{
-    if (num_threads < 1) num_threads = 1;
+namespace {
 
-    // ---- 1. Measure total file size ----------------------------------------
-    std::ifstream probe(path, std::ios::in | std::ios::ate);
-    if (!probe.is_open()) {
-        throw std::runtime_error("ParallelLoader: cannot open file: " + path);
-    }
-    const std::int64_t file_size = static_cast<std::int64_t>(probe.tellg());
-    probe.close();
+// Run fn(tid, item) for item in [0, n_items) on a pool of num_threads
+// threads.  Items are claimed one at a time from a shared atomic cursor, so
+// a thread held up by one slow item simply claims fewer of the rest.
+template <typename Fn>
+void run_pool(int num_threads, std::size_t n_items, Fn&& fn) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](int tid) {
+        for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+             i < n_items;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            fn(tid, i);
+        }
+    };
 
-    if (file_size <= 0) {
-        throw std::runtime_error("ParallelLoader: empty or unreadable file: " + path);
+    if (num_threads <= 1) {
+        worker(0);
+        return;
     }
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    for (auto& t : threads) t.join();
+}
+
+// One work unit: whole lines of one file plus that file's column layout.
+struct Morsel {
+    std::string_view bytes;
+    const ColumnMap* columns = nullptr;
+};
 
-    // Clamp threads so we never spawn more threads than bytes (degenerate files)
-    num_threads = static_cast<int>(
-        std::min(static_cast<std::int64_t>(num_threads), file_size));
-
-    // ---- 2. Compute byte ranges --------------------------------------------
-    // Each chunk gets an equal slice of the file.  Actual line boundaries are
-    // handled inside CsvReader::load_chunk: when byte_start > 0 it discards
-    // the partial line at the start of the chunk (which the previous chunk
-    // already read in full).
-    std::vector<std::int64_t> starts(num_threads);
-    std::vector<std::int64_t> ends(num_threads);
-
-    const std::int64_t chunk_size = file_size / num_threads;
-    for (int i = 0; i < num_threads; ++i) {
-        starts[i] = static_cast<std::int64_t>(i) * chunk_size;
-        ends[i]   = (i == num_threads - 1)
-                        ? file_size - 1
-                        : starts[i] + chunk_size - 1;
+// Cut one file's whole-line blocks into morsels.  The header is the first
+// line of the first block; it is read into @p columns, which the morsels
+// point to and which must outlive them.
+void cut_morsels(std::vector<std::string_view> blocks, std::size_t morsel_bytes,
+                 ColumnMap& columns, std::vector<Morsel>& morsels) {
+    if (blocks.empty()) return;
+    const auto header_end = blocks.front().find('\n');
+    columns = ColumnMap::from_header(blocks.front().substr(0, header_end));
+    blocks.front().remove_prefix(header_end == std::string_view::npos
+                                     ? blocks.front().size() : header_end + 1);
+
+    for (std::string_view bytes : blocks) {
+        if (bytes.empty()) continue;
+        const auto bounds = ParallelLoader::split_morsels(bytes, morsel_bytes);
+        for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+            morsels.push_back({bytes.substr(bounds[i], bounds[i + 1] - bounds[i]), &columns});
+        }
     }
+}
+
+// Never spawn more threads than there is work.
+int clamp_threads(int num_threads, std::size_t n_items) {
+    if (num_threads < 1) num_threads = 1;
+    return static_cast<int>(std::min(static_cast<std::size_t>(num_threads),
+                                     std::max<std::size_t>(n_items, 1)));
+}
 
-    // ---- 3. Spawn threads --------------------------------------------------
-    std::vector<std::thread>                threads(num_threads);
-    std::vector<std::vector<TripRecord>>    partial_records(num_threads);
-    std::vector<CsvReader::Stats>           partial_stats(num_threads);
+// Upper bound on the rows in a morsel: its line count.
+std::size_t count_lines(std::string_view m) {
+    if (m.empty()) return 0;
+    return static_cast<std::size_t>(std::count(m.begin(), m.end(), '\n'))
+         + (m.back() != '\n' ? 1 : 0);
+}
 
-    auto wall_start = std::chrono::steady_clock::now();
+template <typename R>
+void copy_stats(const std::vector<CsvReader::Stats>& per_thread, R& result) {
+    CsvReader::Stats totals;
+    for (const auto& s : per_thread) totals += s;
+    result.total_rows_read        = totals.rows_read;
+    result.total_rows_parsed      = totals.rows_parsed_ok;
+    result.total_rows_discarded   = totals.rows_discarded;
+    result.timestamp_cache_hits   = totals.timestamp_cache_hits;
+    result.timestamp_cache_misses = totals.timestamp_cache_misses;
+}
 
-    for (int i = 0; i < num_threads; ++i) {
-        threads[i] = std::thread([&, i]() {
-            partial_records[i] = CsvReader::load_chunk(
-                path, starts[i], ends[i], partial_stats[i]);
+// An empty part buffer storing the same columns as @p out.
+TripRecords empty_like(const TripRecords&) { return {}; }
+TripDataSoA empty_like(const TripDataSoA& out) { return TripDataSoA(out.columns()); }
+
+ColumnSet columns_of(const TripRecords&) { return ColumnSet::all(); }
+ColumnSet columns_of(const TripDataSoA& out) { return out.columns(); }
+
+// Extend @p out to @p n rows without writing them: the place threads
+// overwrite every new row, so nothing is zero-filled on this thread first.
+void resize_for_overwrite(TripRecords& out, std::size_t n) { out.resize(n); }
+void resize_for_overwrite(TripDataSoA& out, std::size_t n) { out.resize_for_overwrite(n); }
+
+// Parse every morsel and place its rows at their final offset in @p out.
+//
+// Works for any row container with reserve/size/push_back(TripRecord) and a
+// resize_for_overwrite() overload above (TripRecords, TripDataSoA); @p place
+// copies one morsel's rows into @p out at a given offset.  Only the columns
+// @p out stores are parsed.  Morsels are processed in waves of
+// 4 x num_threads: parse into thread-local buffers, prefix-sum the row
+// counts, then place all buffers in parallel.  @p out is reserved once per
+// call from a line count, so it never reallocates within a call and nothing
+// is ever concatenated; its new rows are first written (and first touched)
+// by the place threads, never zero-filled serially.
+template <typename Table, typename Place>
+void parse_in_waves(const std::vector<Morsel>& morsels, int num_threads,
+                    Table& out, std::vector<CsvReader::Stats>& partial_stats,
+                    Place place) {
+    // ---- 1. Upper bound on rows: count lines per morsel in parallel --------
+    // Pages beyond the rows actually kept are never touched.
+    std::vector<std::size_t> lines(morsels.size());
+    run_pool(num_threads, morsels.size(), [&](int, std::size_t m) {
+        lines[m] = count_lines(morsels[m].bytes);
+    });
+    std::size_t max_rows = out.size();
+    for (auto n : lines) max_rows += n;
+    out.reserve(max_rows);
+
+    // ---- 2. Waves: parse -> prefix sum -> place ----------------------------
+    // Only one wave of thread-local buffers exists at a time, so peak memory
+    // is the final table plus a few morsels' worth of rows.
+    const std::size_t wave = 4 * static_cast<std::size_t>(num_threads);
+    std::vector<Table>       parts(std::min(wave, morsels.size()), empty_like(out));
+    std::vector<std::size_t> offsets(parts.size());
+
+    std::size_t rows = out.size();
+    for (std::size_t w = 0; w < morsels.size(); w += wave) {
+        const std::size_t k = std::min(wave, morsels.size() - w);
+
+        run_pool(num_threads, k, [&](int tid, std::size_t i) {
+            Table& part = parts[i];
+            part.reserve(lines[w + i]);
+            const Morsel& m = morsels[w + i];
+            CsvReader reader = CsvReader::from_bytes(m.bytes, *m.columns, columns_of(out));
+            TripRecord rec;
+            while (reader.read_next(rec)) {
+                part.push_back(rec);
+            }
+            partial_stats[tid] += reader.get_stats();
+        });
+
+        // Exclusive prefix sum of row counts = each morsel's first row.
+        for (std::size_t i = 0; i < k; ++i) {
+            offsets[i] = rows;
+            rows += parts[i].size();
+        }
+        resize_for_overwrite(out, rows);   // within the reserved capacity: no reallocation
+
+        run_pool(num_threads, k, [&](int, std::size_t i) {
+            place(out, offsets[i], parts[i]);
+            parts[i] = empty_like(out);   // free the buffers before the next wave
         });
     }
+}
 
-    // ---- 4. Join and merge -------------------------------------------------
-    for (auto& t : threads) t.join();
+// Load @p paths in order into @p out, one group of morsels at a time.
+//
+// Uncompressed files are mapped and their morsels queued; the mappings are
+// backed by the page cache, so any number of them can be pending at once.
+// A compressed file is decompressed into memory (members / frames in
+// parallel), parsed and freed before the next file is decompressed, so at
+// most one file's decoded text is alive at a time.  Queued morsels are
+// parsed first to keep rows in file order.  @return the number of morsels.
+template <typename Table, typename Place>
+std::size_t load_files(const std::vector<std::string>& paths, std::size_t morsel_bytes,
+                       int num_threads, Table& out,
+                       std::vector<CsvReader::Stats>& partial_stats, int& threads_used,
+                       Place place) {
+    std::vector<MappedFile> maps;
+    maps.reserve(paths.size());
+    std::vector<ColumnMap> column_maps(paths.size(), ColumnMap::tlc_default());
+    std::vector<Morsel>    pending;
+    std::size_t            n_morsels = 0;
 
-    auto wall_end = std::chrono::steady_clock::now();
+    auto flush = [&] {
+        if (pending.empty()) return;
+        const int t = clamp_threads(num_threads, pending.size());
+        threads_used = std::max(threads_used, t);
+        parse_in_waves(pending, t, out, partial_stats, place);
+        n_morsels += pending.size();
+        pending.clear();
+    };
 
+    for (std::size_t f = 0; f < paths.size(); ++f) {
+        const std::string& path = paths[f];
+        MappedFile map;
+        if (!map.open(path)) {
+            throw std::runtime_error("ParallelLoader: cannot open file: " + path);
+        }
+        if (map.size() == 0) {
+            throw std::runtime_error("ParallelLoader: empty or unreadable file: " + path);
+        }
+        map.advise_sequential();
+
+        const Compression c = detect_compression(map.view());
+        if (c == Compression::None) {
+            maps.push_back(std::move(map));
+            cut_morsels({maps.back().view()}, morsel_bytes, column_maps[f], pending);
+            continue;
+        }
+
+        flush();
+        const DecodedText text = decompress_parallel(map.view(), c, num_threads, path);
+        map = MappedFile();   // the compressed mapping is not needed once decoded
+        cut_morsels(text.blocks(), morsel_bytes, column_maps[f], pending);
+        flush();              // text is freed at the end of this iteration
+    }
+    flush();
+    return n_morsels;
+}
+
+} // namespace
+
+std::vector<std::size_t> ParallelLoader::split_morsels(std::string_view bytes,
+                                                       std::size_t morsel_bytes)
+{
+    if (morsel_bytes == 0) morsel_bytes = kDefaultMorselBytes;
+
+    std::vector<std::size_t> bounds;
+    bounds.reserve(bytes.size() / morsel_bytes + 2);
+    bounds.push_back(0);
+
+    std::size_t pos = 0;
+    while (bytes.size() - pos > morsel_bytes) {
+        // Cut after the newline that ends the line holding the target byte.
+        const auto nl = bytes.find('\n', pos + morsel_bytes - 1);
+        if (nl == std::string_view::npos || nl + 1 >= bytes.size()) break;
+        pos = nl + 1;
+        bounds.push_back(pos);
+    }
+    bounds.push_back(bytes.size());
+    return bounds;
+}
+
+ParallelLoader::Result ParallelLoader::load(const std::string& path,
+                                             int num_threads,
+                                             std::size_t morsel_bytes)
+{
+    return load(std::vector<std::string>{path}, num_threads, morsel_bytes);
+}
+
+ParallelLoader::Result ParallelLoader::load(const std::vector<std::string>& paths,
+                                             int num_threads,
+                                             std::size_t morsel_bytes)
+{
+    auto wall_start = std::chrono::steady_clock::now();
+
+    // Map every file once and cut newline-aligned morsels.  All threads read
+    // the same page-cache pages; no per-thread ifstream, seek or tellg.
+    if (num_threads < 1) num_threads = 1;
     Result result;
-    result.threads_used  = num_threads;
-    result.load_time_ms  =
+    result.threads_used = 1;
+
+    // Threads place their rows straight into result.records (morsel order
+    // == file order, so the output matches a serial load).
+    std::vector<CsvReader::Stats> partial_stats(num_threads);
+    result.morsels = load_files(paths, morsel_bytes, num_threads, result.records,
+                                partial_stats, result.threads_used,
+                                [](TripRecords& out, std::size_t offset,
+                                   const TripRecords& part) {
+                                    std::copy(part.begin(), part.end(),
+                                              out.begin() + static_cast<std::ptrdiff_t>(offset));
+                                });
+    copy_stats(partial_stats, result);
+
+    auto wall_end = std::chrono::steady_clock::now();
+    result.load_time_ms =
         std::chrono::duration<double, std::milli>(wall_end - wall_start).count();
 
-    // Pre-size the output vector to avoid repeated reallocation during merge
-    std::size_t total = 0;
-    for (int i = 0; i < num_threads; ++i) total += partial_records[i].size();
-    result.records.reserve(total);
+    return result;
+}
 
-    for (int i = 0; i < num_threads; ++i) {
-        result.records.insert(result.records.end(),
-                              partial_records[i].begin(),
-                              partial_records[i].end());
+ParallelLoader::SoAResult ParallelLoader::load_soa(const std::vector<std::string>& paths,
+                                                    int num_threads,
+                                                    std::size_t morsel_bytes,
+                                                    ColumnSet columns)
+{
+    auto wall_start = std::chrono::steady_clock::now();
 
-        result.total_rows_read      += partial_stats[i].rows_read;
-        result.total_rows_parsed    += partial_stats[i].rows_parsed_ok;
-        result.total_rows_discarded += partial_stats[i].rows_discarded;
-    }
+    if (num_threads < 1) num_threads = 1;
+    SoAResult result;
+    result.data         = TripDataSoA(columns);
+    result.threads_used = 1;
+
+    std::vector<CsvReader::Stats> partial_stats(num_threads);
+    result.morsels = load_files(paths, morsel_bytes, num_threads, result.data,
+                                partial_stats, result.threads_used,
+                                [](TripDataSoA& out, std::size_t offset, const TripDataSoA& part) {
+                                    out.assign_rows(offset, part);
+                                });
+    copy_stats(partial_stats, result);
+
+    auto wall_end = std::chrono::steady_clock::now();
+    result.load_time_ms =
+        std::chrono::duration<double, std::milli>(wall_end - wall_start).count();
 
     return result;
 }
@@ -0,0 +1,250 @@
+#include "taxi/PartitionedDataset.hpp"
+#include "taxi/TimestampDecoder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace taxi {
+
+namespace {
+
+constexpr std::int64_t kSecondsPerDay = 86400;
+
+// First second of month key @p month.
+std::int64_t month_start(int month)
+{
+    const int y = month >= 0 ? month / 12 : (month - 11) / 12;
+    return days_from_civil(y, month - y * 12 + 1, 1) * kSecondsPerDay;
+}
+
+} // namespace
+
+int PartitionedDataset::month_of(std::int64_t ts)
+{
+    const std::int64_t days = ts >= 0 ? ts / kSecondsPerDay
+                                      : (ts - kSecondsPerDay + 1) / kSecondsPerDay;
+    int y, m, d;
+    civil_from_days(days, y, m, d);
+    return y * 12 + (m - 1);
+}
+
+PartitionedDataset::Partition::Partition(int m, TripDataSoA&& rows)
+    : month(m), offset(0), min_pickup(0), max_pickup(0),
+      data(std::move(rows)), engine(data)
+{
+    const auto ts = data.pickup_timestamp.span();
+    if (!ts.empty()) {
+        const auto [lo, hi] = std::minmax_element(ts.begin(), ts.end());
+        min_pickup = *lo;
+        max_pickup = *hi;
+    }
+}
+
+PartitionedDataset PartitionedDataset::from_soa(TripDataSoA&& soa)
+{
+    PartitionedDataset out;
+    out.add(std::move(soa));
+    return out;
+}
+
+void PartitionedDataset::add(TripDataSoA&& rows)
+{
+    if (!rows.columns().has(Column::PickupTimestamp))
+        throw std::runtime_error("PartitionedDataset::add: rows have no pickup_timestamp");
+    if (parts_.empty())
+        columns_ = rows.columns();
+    else if (rows.columns() != columns_)
+        throw std::runtime_error("PartitionedDataset::add: rows store other columns than the dataset");
+    const std::size_t n = rows.size();
+    if (n == 0) return;
+
+    // Month of every row.  Rows are mostly in time order, so the bounds of
+    // the last month seen usually answer without any date arithmetic.
+    std::vector<int> month(n);
+    std::int64_t lo = 1, hi = 0;
+    int cur = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::int64_t t = rows.pickup_timestamp[i];
+        if (t < lo || t >= hi) {
+            cur = month_of(t);
+            lo  = month_start(cur);
+            hi  = month_start(cur + 1);
+        }
+        month[i] = cur;
+    }
+    std::vector<int> months(month);
+    std::sort(months.begin(), months.end());
+    months.erase(std::unique(months.begin(), months.end()), months.end());
+    std::vector<std::uint32_t> part(n);
+    for (std::size_t i = 0; i < n; ++i)
+        part[i] = static_cast<std::uint32_t>(
+            std::lower_bound(months.begin(), months.end(), month[i]) - months.begin());
+    month = {};
+
+    auto tables = TripDataSoA::split(std::move(rows), part, months.size());
+    for (std::size_t k = 0; k < months.size(); ++k) {
+        auto at = std::lower_bound(parts_.begin(), parts_.end(), months[k],
+                                   [](const auto& p, int m) { return p->month < m; });
+        if (at == parts_.end() || (*at)->month != months[k]) {
+            parts_.insert(at, std::make_unique<Partition>(months[k], std::move(tables[k])));
+            continue;
+        }
+        // An existing month: a new partition holding both, to be indexed.
+        const TripDataSoA& old = (*at)->data;
+        TripDataSoA merged(columns_);
+        merged.resize(old.size() + tables[k].size());
+        merged.assign_rows(0, old);
+        merged.assign_rows(old.size(), tables[k]);
+        tables[k] = TripDataSoA();
+        *at = std::make_unique<Partition>(months[k], std::move(merged));
+    }
+    renumber();
+}
+
+void PartitionedDataset::renumber()
+{
+    rows_ = 0;
+    for (auto& p : parts_) {
+        p->offset = rows_;
+        rows_ += p->data.size();
+    }
+}
+
+double PartitionedDataset::build_indexes()
+{
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::vector<Partition*> todo;
+    for (auto& p : parts_)
+        if (!p->engine.indexes_built()) todo.push_back(p.get());
+
+    // One partition per thread; a lone one keeps the engine's own parallelism.
+    const auto count = static_cast<std::ptrdiff_t>(todo.size());
+    #pragma omp parallel for schedule(dynamic, 1) if (count > 1)
+    for (std::ptrdiff_t i = 0; i < count; ++i)
+        todo[i]->engine.build_indexes();
+
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+std::pair<const PartitionedDataset::Partition*, std::size_t>
+PartitionedDataset::locate(std::size_t row) const
+{
+    if (row >= rows_)
+        throw std::runtime_error("PartitionedDataset::locate: row " + std::to_string(row) +
+                                 " of " + std::to_string(rows_));
+    auto it = std::upper_bound(parts_.begin(), parts_.end(), row,
+                               [](std::size_t r, const auto& p) { return r < p->offset; });
+    const Partition* p = std::prev(it)->get();
+    return {p, row - p->offset};
+}
+
+std::vector<const PartitionedDataset::Partition*>
+PartitionedDataset::overlapping(std::int64_t start, std::int64_t end) const
+{
+    std::vector<const Partition*> out;
+    for (const auto& p : parts_)
+        if (p->min_pickup <= end && p->max_pickup >= start) out.push_back(p.get());
+    return out;
+}
+
+std::vector<const PartitionedDataset::Partition*> PartitionedDataset::all() const
+{
+    std::vector<const Partition*> out;
+    for (const auto& p : parts_) out.push_back(p.get());
+    return out;
+}
+
+template <typename Run>
+auto PartitionedDataset::fan_out(const std::vector<const Partition*>& parts, Run run)
+{
+    // Each partition's query runs on one thread (nested regions are
+    // serialised); a single partition runs alone with its parallel scan.
+    std::vector<decltype(run(parts.front()->engine))> results(parts.size());
+    const auto count = static_cast<std::ptrdiff_t>(parts.size());
+    #pragma omp parallel for schedule(dynamic, 1) if (count > 1)
+    for (std::ptrdiff_t i = 0; i < count; ++i)
+        results[i] = run(parts[i]->engine);
+    return results;
+}
+
+SoAQueryResult PartitionedDataset::concat(const std::vector<const Partition*>& parts,
+                                          const std::vector<SoAQueryResult>& results)
+{
+    SoAQueryResult out;
+    std::size_t total = 0;
+    for (const auto& r : results) total += r.indices.size();
+    out.indices.reserve(total);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        out.scanned += results[i].scanned;
+        for (std::size_t row : results[i].indices)
+            out.indices.push_back(parts[i]->offset + row);
+    }
+    return out;
+}
+
+// ============================================================================
+// Queries: Q1, Q5 and Q6 only reach the months they overlap
+// ============================================================================
+
+SoAQueryResult PartitionedDataset::search_by_time(const TimeRangeQuery& q) const
+{
+    const auto parts = overlapping(q.start_time, q.end_time);
+    return concat(parts, fan_out(parts, [&](const SoAQueryEngine& e) {
+        return e.search_by_time(q);
+    }));
+}
+
+SoAQueryResult PartitionedDataset::search_by_distance(const NumericRangeQuery& q) const
+{
+    const auto parts = all();
+    return concat(parts, fan_out(parts, [&](const SoAQueryEngine& e) {
+        return e.search_by_distance(q);
+    }));
+}
+
+SoAQueryResult PartitionedDataset::search_by_fare(const NumericRangeQuery& q) const
+{
+    const auto parts = all();
+    return concat(parts, fan_out(parts, [&](const SoAQueryEngine& e) {
+        return e.search_by_fare(q);
+    }));
+}
+
+SoAQueryResult PartitionedDataset::search_by_location(const IntRangeQuery& q) const
+{
+    const auto parts = all();
+    return concat(parts, fan_out(parts, [&](const SoAQueryEngine& e) {
+        return e.search_by_location(q);
+    }));
+}
+
+SoAQueryResult PartitionedDataset::search_combined(const CombinedQuery& q) const
+{
+    const auto parts = overlapping(q.time_range.start_time, q.time_range.end_time);
+    return concat(parts, fan_out(parts, [&](const SoAQueryEngine& e) {
+        return e.search_combined(q);
+    }));
+}
+
+AggregationResult PartitionedDataset::aggregate_fare_by_time(const TimeRangeQuery& q) const
+{
+    const auto parts = overlapping(q.start_time, q.end_time);
+    AggregationResult result;
+    // Partial sums added in month order: the same total for any thread count.
+    for (const auto& r : fan_out(parts, [&](const SoAQueryEngine& e) {
+             return e.aggregate_fare_by_time(q);
+         })) {
+        result.sum   += r.sum;
+        result.count += r.count;
+    }
+    if (result.count > 0)
+        result.avg = result.sum / static_cast<double>(result.count);
+    return result;
+}
+
+} // namespace taxi
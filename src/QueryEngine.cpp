@@ -7,10 +7,12 @@
 
 namespace taxi {
 
-QueryEngine::QueryEngine(const std::vector<TripRecord>& data)
+template <typename Record>
+BasicQueryEngine<Record>::BasicQueryEngine(std::span<const Record> data)
     : data_(data) {}
 
-double QueryEngine::build_indexes() {
+template <typename Record>
+double BasicQueryEngine<Record>::build_indexes() {
     auto start = std::chrono::steady_clock::now();
     time_index_.build(data_);
     auto end = std::chrono::steady_clock::now();
@@ -18,8 +20,9 @@ double QueryEngine::build_indexes() {
 }
 
 // Query 1: Time range — uses TimeIndex for O(log N) lookup
-QueryResult QueryEngine::search_by_time(const TimeRangeQuery& q) const {
-    QueryResult result;
+template <typename Record>
+auto BasicQueryEngine<Record>::search_by_time(const TimeRangeQuery& q) const -> Result {
+    Result result;
 
     if (time_index_.is_built()) {
         auto [lo_, hi_] = time_index_.lookup(data_, q.start_time, q.end_time);
@@ -35,7 +38,7 @@ QueryResult QueryEngine::search_by_time(const TimeRangeQuery& q) const {
         } else {
             #pragma omp parallel
             {
-                std::vector<const TripRecord*> local;
+                std::vector<const Record*> local;
 #if defined(_OPENMP)
                 local.reserve((hi - lo) / omp_get_num_threads());
 #else
@@ -57,7 +60,7 @@ QueryResult QueryEngine::search_by_time(const TimeRangeQuery& q) const {
         result.scanned = data_.size();
         #pragma omp parallel
         {
-            std::vector<const TripRecord*> local;
+            std::vector<const Record*> local;
 #if defined(_OPENMP)
             local.reserve(data_.size() / (10 * omp_get_num_threads()));
 #else
@@ -83,13 +86,14 @@ QueryResult QueryEngine::search_by_time(const TimeRangeQuery& q) const {
 }
 
 // Query 2: Distance range — parallel linear scan
-QueryResult QueryEngine::search_by_distance(const NumericRangeQuery& q) const {
-    QueryResult result;
+template <typename Record>
+auto BasicQueryEngine<Record>::search_by_distance(const NumericRangeQuery& q) const -> Result {
+    Result result;
     result.scanned = data_.size();
 
     #pragma omp parallel
     {
-        std::vector<const TripRecord*> local;
+        std::vector<const Record*> local;
 #if defined(_OPENMP)
         local.reserve(data_.size() / (10 * omp_get_num_threads()));
 #else
@@ -114,13 +118,14 @@ QueryResult QueryEngine::search_by_distance(const NumericRangeQuery& q) const {
 }
 
 // Query 3: Fare range — parallel linear scan
-QueryResult QueryEngine::search_by_fare(const NumericRangeQuery& q) const {
-    QueryResult result;
+template <typename Record>
+auto BasicQueryEngine<Record>::search_by_fare(const NumericRangeQuery& q) const -> Result {
+    Result result;
     result.scanned = data_.size();
 
     #pragma omp parallel
     {
-        std::vector<const TripRecord*> local;
+        std::vector<const Record*> local;
 #if defined(_OPENMP)
         local.reserve(data_.size() / (10 * omp_get_num_threads()));
 #else
@@ -145,13 +150,14 @@ QueryResult QueryEngine::search_by_fare(const NumericRangeQuery& q) const {
 }
 
 // Query 4: Location filter — parallel linear scan on PULocationID
-QueryResult QueryEngine::search_by_location(const IntRangeQuery& q) const {
-    QueryResult result;
+template <typename Record>
+auto BasicQueryEngine<Record>::search_by_location(const IntRangeQuery& q) const -> Result {
+    Result result;
     result.scanned = data_.size();
 
     #pragma omp parallel
     {
-        std::vector<const TripRecord*> local;
+        std::vector<const Record*> local;
 #if defined(_OPENMP)
         local.reserve(data_.size() / (10 * omp_get_num_threads()));
 #else
@@ -177,8 +183,9 @@ QueryResult QueryEngine::search_by_location(const IntRangeQuery& q) const {
 
 // Query 5: Combined — time + distance + passenger count
 // Uses TimeIndex to narrow window, then parallel-filters.
-QueryResult QueryEngine::search_combined(const CombinedQuery& q) const {
-    QueryResult result;
+template <typename Record>
+auto BasicQueryEngine<Record>::search_combined(const CombinedQuery& q) const -> Result {
+    Result result;
 
     if (time_index_.is_built()) {
         auto [lo_, hi_] = time_index_.lookup(
@@ -189,7 +196,7 @@ QueryResult QueryEngine::search_combined(const CombinedQuery& q) const {
 
         #pragma omp parallel
         {
-            std::vector<const TripRecord*> local;
+            std::vector<const Record*> local;
 #if defined(_OPENMP)
             local.reserve((hi - lo) / (10 * omp_get_num_threads()));
 #else
@@ -216,7 +223,7 @@ QueryResult QueryEngine::search_combined(const CombinedQuery& q) const {
         result.scanned = data_.size();
         #pragma omp parallel
         {
-            std::vector<const TripRecord*> local;
+            std::vector<const Record*> local;
 #if defined(_OPENMP)
             local.reserve(data_.size() / (20 * omp_get_num_threads()));
 #else
@@ -247,7 +254,8 @@ QueryResult QueryEngine::search_combined(const CombinedQuery& q) const {
 
 // Query 6: Aggregation — sum/avg of fare_amount over a time window
 // Uses reduction for thread-safe accumulation.
-AggregationResult QueryEngine::aggregate_fare_by_time(const TimeRangeQuery& q) const {
+template <typename Record>
+AggregationResult BasicQueryEngine<Record>::aggregate_fare_by_time(const TimeRangeQuery& q) const {
     AggregationResult result;
 
     if (time_index_.is_built()) {
@@ -285,4 +293,7 @@ AggregationResult QueryEngine::aggregate_fare_by_time(const TimeRangeQuery& q) c
     return result;
 }
 
+template class BasicQueryEngine<TripRecord>;
+template class BasicQueryEngine<TripHot>;
+
 } // namespace taxi
@@ -0,0 +1,105 @@
+#include "taxi/RadixSort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace taxi {
+
+namespace {
+
+// Digits of up to 11 bits: 2048 counters per thread stay in L1, and a
+// 25-bit key span (a year of seconds) sorts in three passes, not four.
+constexpr unsigned    kMaxDigitBits = 11;
+constexpr std::size_t kMaxBuckets   = std::size_t{1} << kMaxDigitBits;
+
+// Below this many rows one thread sorts: a team costs more than it saves.
+constexpr std::size_t kParallelRows = std::size_t{1} << 16;
+
+template <typename K>
+void radix_sort_impl(HugeVector<KeyRow<K>>& pairs, unsigned key_bits)
+{
+    const std::size_t n = pairs.size();
+    if (n < 2 || key_bits == 0) return;
+
+    // Equal-width digits: 25 bits sort as 9 + 9 + 7, not 11 + 11 + 3.
+    const unsigned    passes     = (key_bits + kMaxDigitBits - 1) / kMaxDigitBits;
+    const unsigned    digit_bits = (key_bits + passes - 1) / passes;
+    const std::size_t buckets    = std::size_t{1} << digit_bits;
+    const K           digit_mask = static_cast<K>(buckets - 1);
+
+    int max_threads = 1;
+#if defined(_OPENMP)
+    if (n >= kParallelRows) max_threads = omp_get_max_threads();
+#endif
+    // counts[t][d]: rows of thread t's slice with digit d, then where
+    // thread t writes its next row with digit d.
+    std::vector<std::array<std::size_t, kMaxBuckets>> counts(static_cast<std::size_t>(max_threads));
+
+    HugeVector<KeyRow<K>> scratch;
+    scratch.resize(n);   // not zero-filled: every pass writes all of it
+    KeyRow<K>* src = pairs.data();
+    KeyRow<K>* dst = scratch.data();
+
+    for (unsigned shift = 0; shift < key_bits; shift += digit_bits) {
+        bool skip = false;
+        #pragma omp parallel num_threads(max_threads)
+        {
+            int team = 1, t = 0;
+#if defined(_OPENMP)
+            team = omp_get_num_threads();   // 1 when nested in another region
+            t    = omp_get_thread_num();
+#endif
+            const std::size_t lo = n * static_cast<std::size_t>(t) / static_cast<std::size_t>(team);
+            const std::size_t hi = n * static_cast<std::size_t>(t + 1) / static_cast<std::size_t>(team);
+            auto& count = counts[static_cast<std::size_t>(t)];
+            std::fill_n(count.begin(), buckets, std::size_t{0});
+            for (std::size_t i = lo; i < hi; ++i)
+                ++count[(src[i].key >> shift) & digit_mask];
+
+            #pragma omp barrier
+            #pragma omp single
+            {
+                // Digit-major, thread-minor exclusive prefix sum: keeps the
+                // order of equal digits, so the sort is stable.
+                std::size_t next = 0;
+                for (std::size_t d = 0; d < buckets; ++d) {
+                    const std::size_t first = next;
+                    for (int u = 0; u < team; ++u) {
+                        const std::size_t c = counts[static_cast<std::size_t>(u)][d];
+                        counts[static_cast<std::size_t>(u)][d] = next;
+                        next += c;
+                    }
+                    if (next - first == n) skip = true;   // one digit for every key
+                }
+            }
+
+            if (!skip) {
+                for (std::size_t i = lo; i < hi; ++i)
+                    dst[count[(src[i].key >> shift) & digit_mask]++] = src[i];
+            }
+        }
+        if (!skip) std::swap(src, dst);
+    }
+
+    if (src != pairs.data()) pairs.swap(scratch);
+}
+
+} // namespace
+
+void radix_sort(HugeVector<KeyRow<std::uint32_t>>& pairs, unsigned key_bits)
+{
+    radix_sort_impl(pairs, key_bits);
+}
+
+void radix_sort(HugeVector<KeyRow<std::uint64_t>>& pairs, unsigned key_bits)
+{
+    radix_sort_impl(pairs, key_bits);
+}
+
+} // namespace taxi
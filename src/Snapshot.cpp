@@ -0,0 +1,545 @@
+#include "taxi/Snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace taxi {
+
+namespace {
+
+constexpr char          kMagic[8]    = {'T', 'A', 'X', 'I', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t kByteOrder   = 0x01020304;
+constexpr std::uint64_t kAlign       = 4096;
+constexpr std::uint32_t kTimeIndexId = 0xFFFF;            ///< section id of the time index
+constexpr std::size_t   kIoBytes     = std::size_t{64} << 20;   ///< per read()/write() call
+
+static_assert(sizeof(std::size_t) == 8, "time index is stored as u64 row ids");
+
+struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t rows;
+    std::uint64_t column_bits;
+    std::uint64_t meta_bytes;
+    std::uint64_t meta_checksum;
+    std::uint64_t file_bytes;
+    std::uint64_t header_checksum;   ///< of every field above
+};
+static_assert(sizeof(Header) == 64, "snapshot header is 64 bytes");
+
+struct Section {
+    std::uint32_t id;          ///< Column index, or kTimeIndexId
+    std::uint32_t elem_bytes;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+    std::uint64_t checksum;
+};
+
+// ---- xxHash64 ---------------------------------------------------------------
+
+constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t P3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+inline std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline std::uint64_t load64(const unsigned char* p) {
+    std::uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline std::uint32_t load32(const unsigned char* p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline std::uint64_t xxh_round(std::uint64_t acc, std::uint64_t in) {
+    return rotl(acc + in * P2, 31) * P1;
+}
+
+inline std::uint64_t merge(std::uint64_t acc, std::uint64_t v) {
+    return (acc ^ xxh_round(0, v)) * P1 + P4;
+}
+
+// XXH64 with seed 0: four independent lanes over 32-byte stripes, so it
+// runs at memory bandwidth.
+std::uint64_t checksum(const void* data, std::size_t len) {
+    const auto* p   = static_cast<const unsigned char*>(data);
+    const auto* end = p + len;
+    std::uint64_t h;
+
+    if (len >= 32) {
+        std::uint64_t v1 = P1 + P2, v2 = P2, v3 = 0, v4 = 0 - P1;
+        const auto* limit = end - 32;
+        do {
+            v1 = xxh_round(v1, load64(p));
+            v2 = xxh_round(v2, load64(p + 8));
+            v3 = xxh_round(v3, load64(p + 16));
+            v4 = xxh_round(v4, load64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge(h, v1);
+        h = merge(h, v2);
+        h = merge(h, v3);
+        h = merge(h, v4);
+    } else {
+        h = P5;
+    }
+    h += len;
+
+    for (; p + 8 <= end; p += 8) h = rotl(h ^ xxh_round(0, load64(p)), 27) * P1 + P4;
+    if (p + 4 <= end) {
+        h = rotl(h ^ (load32(p) * P1), 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) h = rotl(h ^ (*p * P5), 11) * P1;
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+// ---- I/O --------------------------------------------------------------------
+
+class Fd {
+public:
+    explicit Fd(int fd = -1) : fd_(fd) {}
+    ~Fd() { if (fd_ >= 0) ::close(fd_); }
+    Fd(const Fd&) = delete;
+    Fd& operator=(const Fd&) = delete;
+
+    int get() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+[[noreturn]] void throw_errno(const char* what, const std::string& path) {
+    throw std::runtime_error(std::string("Snapshot: ") + what + " " + path + ": " +
+                             std::strerror(errno));
+}
+
+[[noreturn]] void throw_corrupt(const std::string& path, const std::string& why) {
+    throw std::runtime_error("Snapshot: " + path + ": " + why);
+}
+
+void write_at(int fd, const void* data, std::size_t len, std::uint64_t off,
+              const std::string& path) {
+    const auto* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t r = ::pwrite(fd, p, std::min(len, kIoBytes), static_cast<off_t>(off));
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("write failed:", path);
+        }
+        p += r;
+        off += static_cast<std::uint64_t>(r);
+        len -= static_cast<std::size_t>(r);
+    }
+}
+
+void read_at(int fd, void* data, std::size_t len, std::uint64_t off,
+             const std::string& path) {
+    auto* p = static_cast<char*>(data);
+    while (len > 0) {
+        const ssize_t r = ::pread(fd, p, std::min(len, kIoBytes), static_cast<off_t>(off));
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            throw_errno("read failed:", path);
+        }
+        if (r == 0) throw_corrupt(path, "truncated");
+        p += r;
+        off += static_cast<std::uint64_t>(r);
+        len -= static_cast<std::size_t>(r);
+    }
+}
+
+std::uint64_t align_up(std::uint64_t n) { return (n + kAlign - 1) & ~(kAlign - 1); }
+
+// ---- Metadata encoding ------------------------------------------------------
+
+class MetaWriter {
+public:
+    template <typename T>
+    void put(T v) {
+        const auto* p = reinterpret_cast<const char*>(&v);
+        buf_.insert(buf_.end(), p, p + sizeof(T));
+    }
+    void put(const std::string& s) {
+        put(static_cast<std::uint32_t>(s.size()));
+        buf_.insert(buf_.end(), s.begin(), s.end());
+    }
+    const std::vector<char>& bytes() const { return buf_; }
+
+private:
+    std::vector<char> buf_;
+};
+
+class MetaReader {
+public:
+    MetaReader(const std::vector<char>& buf, const std::string& path)
+        : buf_(buf), path_(path) {}
+
+    template <typename T>
+    T get() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, buf_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return v;
+    }
+    std::string get_string() {
+        const auto n = get<std::uint32_t>();
+        need(n);
+        std::string s(buf_.data() + pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+private:
+    void need(std::size_t n) const {
+        if (buf_.size() - pos_ < n) throw_corrupt(path_, "metadata is truncated");
+    }
+
+    const std::vector<char>& buf_;
+    const std::string&       path_;
+    std::size_t              pos_ = 0;
+};
+
+std::vector<char> encode_meta(const CsvReader::Stats& stats,
+                              const std::vector<Snapshot::SourceFile>& sources,
+                              const std::vector<Section>& sections) {
+    MetaWriter w;
+    w.put<std::uint64_t>(stats.rows_read);
+    w.put<std::uint64_t>(stats.rows_parsed_ok);
+    w.put<std::uint64_t>(stats.rows_discarded);
+    w.put<std::uint64_t>(stats.timestamp_cache_hits);
+    w.put<std::uint64_t>(stats.timestamp_cache_misses);
+    w.put(static_cast<std::uint32_t>(sources.size()));
+    for (const auto& s : sources) {
+        w.put(s.path);
+        w.put(s.size);
+        w.put(s.mtime_ns);
+    }
+    w.put(static_cast<std::uint32_t>(sections.size()));
+    for (const auto& s : sections) {
+        w.put(s.id);
+        w.put(s.elem_bytes);
+        w.put(s.offset);
+        w.put(s.bytes);
+        w.put(s.checksum);
+    }
+    return w.bytes();
+}
+
+std::uint64_t header_checksum(const Header& h) {
+    return checksum(&h, offsetof(Header, header_checksum));
+}
+
+// Header, metadata and section table of a snapshot, all validated: every
+// section lies inside the file and matches the next stored column (or is
+// the time index), so callers can copy sections without further checks.
+struct Layout {
+    std::uint64_t                     rows = 0;
+    ColumnSet                         columns;
+    CsvReader::Stats                  stats;
+    std::vector<Snapshot::SourceFile> sources;
+    std::vector<Section>              sections;
+};
+
+// read(dst, len, offset) copies bytes of the file; ranges are checked
+// against @p size before each call.
+template <typename Read>
+Layout read_layout(Read&& read, std::uint64_t size, const std::string& path) {
+    Header h{};
+    if (size < sizeof(h)) throw_corrupt(path, "not a snapshot (too small)");
+    read(&h, sizeof(h), 0);
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0)
+        throw_corrupt(path, "not a snapshot (bad magic)");
+    if (h.byte_order != kByteOrder)
+        throw_corrupt(path, "written on a machine of the other byte order");
+    if (h.version != Snapshot::kVersion)
+        throw_corrupt(path, "format version " + std::to_string(h.version) +
+                            ", this build reads " + std::to_string(Snapshot::kVersion));
+    if (header_checksum(h) != h.header_checksum)
+        throw_corrupt(path, "header checksum mismatch");
+    if (h.file_bytes != size || h.meta_bytes > size - sizeof(h))
+        throw_corrupt(path, "truncated (" + std::to_string(size) + " of " +
+                            std::to_string(h.file_bytes) + " bytes)");
+
+    std::vector<char> meta(h.meta_bytes);
+    read(meta.data(), meta.size(), sizeof(h));
+    if (checksum(meta.data(), meta.size()) != h.meta_checksum)
+        throw_corrupt(path, "metadata checksum mismatch");
+
+    Layout out;
+    out.rows = h.rows;
+    MetaReader r(meta, path);
+    out.stats.rows_read              = r.get<std::uint64_t>();
+    out.stats.rows_parsed_ok         = r.get<std::uint64_t>();
+    out.stats.rows_discarded         = r.get<std::uint64_t>();
+    out.stats.timestamp_cache_hits   = r.get<std::uint64_t>();
+    out.stats.timestamp_cache_misses = r.get<std::uint64_t>();
+    const auto n_sources = r.get<std::uint32_t>();
+    for (std::uint32_t i = 0; i < n_sources; ++i) {
+        Snapshot::SourceFile f;
+        f.path     = r.get_string();
+        f.size     = r.get<std::uint64_t>();
+        f.mtime_ns = r.get<std::int64_t>();
+        out.sources.push_back(std::move(f));
+    }
+    out.sections.resize(r.get<std::uint32_t>());
+    for (auto& s : out.sections) {
+        s.id         = r.get<std::uint32_t>();
+        s.elem_bytes = r.get<std::uint32_t>();
+        s.offset     = r.get<std::uint64_t>();
+        s.bytes      = r.get<std::uint64_t>();
+        s.checksum   = r.get<std::uint64_t>();
+    }
+
+    for (std::size_t c = 0; c < kColumnCount; ++c)
+        if (h.column_bits & (std::uint64_t{1} << c))
+            out.columns = out.columns | ColumnSet{static_cast<Column>(c)};
+    if (out.columns.bits() != h.column_bits) throw_corrupt(path, "unknown columns");
+
+    // Element sizes of the stored columns, in section order.
+    const auto cols = TripDataSoA(out.columns).column_bytes();
+    std::size_t next_col = 0;
+    for (const auto& s : out.sections) {
+        std::uint64_t elem = 8;
+        if (s.id != kTimeIndexId) {
+            if (next_col == cols.size() ||
+                static_cast<std::uint32_t>(cols[next_col].column) != s.id)
+                throw_corrupt(path, "unexpected section " + std::to_string(s.id));
+            elem = cols[next_col++].elem_bytes;
+        }
+        if (s.elem_bytes != elem || s.bytes != h.rows * elem || s.offset % kAlign != 0 ||
+            s.offset > size || s.bytes > size - s.offset)
+            throw_corrupt(path, "bad section " + std::to_string(s.id));
+    }
+    if (next_col != cols.size()) throw_corrupt(path, "missing column sections");
+    return out;
+}
+
+Snapshot::Contents contents_of(Layout& layout, std::uint64_t bytes) {
+    Snapshot::Contents out;
+    out.stats   = layout.stats;
+    out.sources = std::move(layout.sources);
+    out.bytes   = bytes;
+    return out;
+}
+
+void check_time_index(const RowIndex& index, const std::string& path) {
+    const std::size_t rows = index.size();
+    for (std::size_t row : index)
+        if (row >= rows) throw_corrupt(path, "time index row out of range");
+}
+
+} // namespace
+
+std::vector<Snapshot::SourceFile> Snapshot::fingerprint(const std::vector<std::string>& paths)
+{
+    std::vector<SourceFile> out;
+    out.reserve(paths.size());
+    for (const auto& p : paths) {
+        SourceFile f{p, 0, 0};
+        struct stat st{};
+        if (::stat(p.c_str(), &st) == 0) {
+            f.size     = static_cast<std::uint64_t>(st.st_size);
+            f.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                         st.st_mtim.tv_nsec;
+        }
+        out.push_back(std::move(f));
+    }
+    return out;
+}
+
+std::uint64_t Snapshot::save(const std::string& path, const TripDataSoA& data,
+                             const RowIndex& time_index,
+                             const CsvReader::Stats& stats,
+                             const std::vector<SourceFile>& sources)
+{
+    if (!time_index.empty() && time_index.size() != data.size())
+        throw std::runtime_error("Snapshot: time index has " +
+                                 std::to_string(time_index.size()) + " rows, data has " +
+                                 std::to_string(data.size()));
+
+    // Section table first: its size fixes where the sections start.
+    struct Payload { const char* data; Section section; };
+    std::vector<Payload> payloads;
+    for (const auto& c : data.column_bytes()) {
+        payloads.push_back({c.data, {static_cast<std::uint32_t>(c.column),
+                                     static_cast<std::uint32_t>(c.elem_bytes), 0,
+                                     data.size() * c.elem_bytes, 0}});
+    }
+    if (!time_index.empty()) {
+        payloads.push_back({reinterpret_cast<const char*>(time_index.data()),
+                            {kTimeIndexId, 8, 0, time_index.size() * 8, 0}});
+    }
+    std::vector<Section> sections;
+    for (const auto& p : payloads) sections.push_back(p.section);
+    const std::uint64_t meta_bytes = encode_meta(stats, sources, sections).size();
+
+    std::uint64_t off = align_up(sizeof(Header) + meta_bytes);
+    for (auto& p : payloads) {
+        p.section.offset   = off;
+        p.section.checksum = checksum(p.data, p.section.bytes);
+        off = align_up(off + p.section.bytes);
+    }
+    const std::uint64_t file_bytes = off;
+
+    sections.clear();
+    for (const auto& p : payloads) sections.push_back(p.section);
+    const std::vector<char> meta = encode_meta(stats, sources, sections);
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version       = kVersion;
+    h.byte_order    = kByteOrder;
+    h.rows          = data.size();
+    h.column_bits   = data.columns().bits();
+    h.meta_bytes    = meta.size();
+    h.meta_checksum = checksum(meta.data(), meta.size());
+    h.file_bytes    = file_bytes;
+    h.header_checksum = header_checksum(h);
+
+    // Write beside the target and rename over it once complete.
+    const std::string tmp = path + ".tmp";
+    {
+        Fd fd(::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if (fd.get() < 0) throw_errno("cannot create", tmp);
+        try {
+            for (const auto& p : payloads)
+                write_at(fd.get(), p.data, p.section.bytes, p.section.offset, tmp);
+            write_at(fd.get(), meta.data(), meta.size(), sizeof(Header), tmp);
+            // Header last: a file cut short never carries a valid one.
+            write_at(fd.get(), &h, sizeof(h), 0, tmp);
+            if (::ftruncate(fd.get(), static_cast<off_t>(file_bytes)) != 0)
+                throw_errno("cannot size", tmp);
+            if (::fsync(fd.get()) != 0) throw_errno("fsync failed:", tmp);
+        } catch (...) {
+            ::unlink(tmp.c_str());
+            throw;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        const int err = errno;
+        ::unlink(tmp.c_str());
+        errno = err;
+        throw_errno("cannot rename to", path);
+    }
+    return file_bytes;
+}
+
+Snapshot::Contents Snapshot::load(const std::string& path, bool verify)
+{
+    Fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0) throw_errno("cannot open", path);
+    struct stat st{};
+    if (::fstat(fd.get(), &st) != 0) throw_errno("cannot stat", path);
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    Layout layout = read_layout([&](void* dst, std::size_t len, std::uint64_t off) {
+        read_at(fd.get(), dst, len, off, path);
+    }, size, path);
+
+    Contents out = contents_of(layout, size);
+    out.data = TripDataSoA(layout.columns);
+    out.data.resize_for_overwrite(layout.rows);   // every byte is read below
+
+    // Destination of every section: the column vectors, then the index.
+    auto cols = out.data.column_bytes();
+    std::size_t next_col = 0;
+    for (const auto& s : layout.sections) {
+        char* dst = nullptr;
+        if (s.id == kTimeIndexId) {
+            out.time_index.resize(layout.rows);
+            dst = reinterpret_cast<char*>(out.time_index.data());
+        } else {
+            dst = cols[next_col++].data;
+        }
+        read_at(fd.get(), dst, s.bytes, s.offset, path);
+        if (verify && checksum(dst, s.bytes) != s.checksum)
+            throw_corrupt(path, "checksum mismatch in section " + std::to_string(s.id));
+    }
+    check_time_index(out.time_index, path);
+    return out;
+}
+
+Snapshot::Contents Snapshot::map(const std::string& path, bool verify)
+{
+    // Header, metadata and index are pread: touching them through the
+    // mapping would make the kernel read around them into the columns.
+    Fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0) throw_errno("cannot open", path);
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path, MappedFile::Mode::CopyOnWrite)) throw_errno("cannot map", path);
+    const char* base = file->data();
+
+    Layout layout = read_layout([&](void* dst, std::size_t len, std::uint64_t off) {
+        read_at(fd.get(), dst, len, off, path);
+    }, file->size(), path);
+
+    Contents out = contents_of(layout, file->size());
+    std::array<std::uint64_t, kColumnCount> offsets{};
+    for (const auto& s : layout.sections) {
+        if (s.id == kTimeIndexId) {
+            out.time_index.resize(layout.rows);
+            read_at(fd.get(), out.time_index.data(), s.bytes, s.offset, path);
+            if (verify && checksum(out.time_index.data(), s.bytes) != s.checksum)
+                throw_corrupt(path, "checksum mismatch in section " + std::to_string(s.id));
+        } else {
+            if (verify && checksum(base + s.offset, s.bytes) != s.checksum)
+                throw_corrupt(path, "checksum mismatch in section " + std::to_string(s.id));
+            offsets[s.id] = s.offset;
+        }
+    }
+    check_time_index(out.time_index, path);
+    out.data = TripDataSoA(layout.columns);
+    out.data.map_columns(std::move(file), layout.rows, offsets);
+    return out;
+}
+
+bool Snapshot::is_snapshot(const std::string& path)
+{
+    Fd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    char magic[sizeof(kMagic)];
+    return fd.get() >= 0 &&
+           ::pread(fd.get(), magic, sizeof(magic), 0) == static_cast<ssize_t>(sizeof(magic)) &&
+           std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+bool Snapshot::is_stale(const Contents& snapshot)
+{
+    for (const auto& was : snapshot.sources) {
+        struct stat st{};
+        if (::stat(was.path.c_str(), &st) != 0) continue;   // archived / moved
+        if (fingerprint({was.path}).front() != was) return true;
+    }
+    return false;
+}
+
+} // namespace taxi
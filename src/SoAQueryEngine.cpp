@@ -11,12 +11,15 @@
 
 #include "taxi/SoAQueryEngine.hpp"
 #include "taxi/TripDataSoA.hpp"
+#include "taxi/CompactSoA.hpp"
 #include "taxi/CsvReader.hpp"
+#include "taxi/RadixSort.hpp"
 
 #include <algorithm>
 #include <chrono>
-#include <numeric>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 
 #if defined(_OPENMP)
 #include <omp.h>
@@ -24,52 +27,228 @@
 
 namespace taxi {
 
+namespace {
+
+constexpr std::int64_t kSecondsPerDay = 86400;
+
+// Day number (UTC) of epoch seconds @p t, rounding down before 1970 too.
+inline std::int64_t pickup_day(std::int64_t t)
+{
+    return (t >= 0 ? t : t - (kSecondsPerDay - 1)) / kSecondsPerDay;
+}
+
+} // namespace
+
+// ============================================================================
+// TripDataSoA — column bookkeeping
+// ============================================================================
+
+template <typename Fn>
+void TripDataSoA::for_each_column(Fn&& fn)
+{
+    // fn(column vector member, matching TripRecord member), stored columns
+    // only; the Column is passed too if fn takes a third argument.
+    auto visit = [&](Column c, auto vec, auto field) {
+        if (!columns_.has(c)) return;
+        if constexpr (std::is_invocable_v<Fn&, decltype(vec), decltype(field), Column>) {
+            fn(vec, field, c);
+        } else {
+            fn(vec, field);
+        }
+    };
+    visit(Column::VendorId,             &TripDataSoA::vendor_id,             &TripRecord::vendor_id);
+    visit(Column::PickupTimestamp,      &TripDataSoA::pickup_timestamp,      &TripRecord::pickup_timestamp);
+    visit(Column::DropoffTimestamp,     &TripDataSoA::dropoff_timestamp,     &TripRecord::dropoff_timestamp);
+    visit(Column::PassengerCount,       &TripDataSoA::passenger_count,       &TripRecord::passenger_count);
+    visit(Column::TripDistance,         &TripDataSoA::trip_distance,         &TripRecord::trip_distance);
+    visit(Column::RateCodeId,           &TripDataSoA::rate_code_id,          &TripRecord::rate_code_id);
+    visit(Column::StoreAndFwdFlag,      &TripDataSoA::store_and_fwd_flag,    &TripRecord::store_and_fwd_flag);
+    visit(Column::PuLocationId,         &TripDataSoA::pu_location_id,        &TripRecord::pu_location_id);
+    visit(Column::DoLocationId,         &TripDataSoA::do_location_id,        &TripRecord::do_location_id);
+    visit(Column::PaymentType,          &TripDataSoA::payment_type,          &TripRecord::payment_type);
+    visit(Column::FareAmount,           &TripDataSoA::fare_amount,           &TripRecord::fare_amount);
+    visit(Column::Extra,                &TripDataSoA::extra,                 &TripRecord::extra);
+    visit(Column::MtaTax,               &TripDataSoA::mta_tax,               &TripRecord::mta_tax);
+    visit(Column::TipAmount,            &TripDataSoA::tip_amount,            &TripRecord::tip_amount);
+    visit(Column::TollsAmount,          &TripDataSoA::tolls_amount,          &TripRecord::tolls_amount);
+    visit(Column::ImprovementSurcharge, &TripDataSoA::improvement_surcharge, &TripRecord::improvement_surcharge);
+    visit(Column::TotalAmount,          &TripDataSoA::total_amount,          &TripRecord::total_amount);
+}
+
+void TripDataSoA::reserve(std::size_t n)
+{
+    for_each_column([&](auto vec, auto) { (this->*vec).reserve(n); });
+}
+
+void TripDataSoA::resize(std::size_t n)
+{
+    for_each_column([&](auto vec, auto) { (this->*vec).resize(n); });
+    rows_       = n;
+    clustering_ = TimeClustering::None;
+}
+
+void TripDataSoA::resize_for_overwrite(std::size_t n)
+{
+    for_each_column([&](auto vec, auto) { (this->*vec).resize_for_overwrite(n); });
+    rows_       = n;
+    clustering_ = TimeClustering::None;
+}
+
+void TripDataSoA::push_back(const TripRecord& r)
+{
+    for_each_column([&](auto vec, auto field) { (this->*vec).push_back(r.*field); });
+    ++rows_;
+    clustering_ = TimeClustering::None;
+}
+
+std::vector<TripDataSoA::ColumnBytes<char>> TripDataSoA::column_bytes()
+{
+    std::vector<ColumnBytes<char>> out;
+    for_each_column([&](auto vec, auto, Column c) {
+        auto& v = this->*vec;
+        out.push_back({c, sizeof(v[0]), reinterpret_cast<char*>(v.data())});
+    });
+    return out;
+}
+
+std::vector<TripDataSoA::ColumnBytes<const char>> TripDataSoA::column_bytes() const
+{
+    // for_each_column() is non-const; only const members are touched here.
+    std::vector<ColumnBytes<const char>> out;
+    const_cast<TripDataSoA*>(this)->for_each_column([&](auto vec, auto, Column c) {
+        const auto& v = this->*vec;
+        out.push_back({c, sizeof(v[0]), reinterpret_cast<const char*>(v.data())});
+    });
+    return out;
+}
+
+void TripDataSoA::map_columns(std::shared_ptr<const MappedFile> file, std::size_t rows,
+                              const std::array<std::uint64_t, kColumnCount>& offsets)
+{
+    for_each_column([&](auto vec, auto, Column c) {
+        auto& v = this->*vec;
+        using T = typename std::remove_reference_t<decltype(v)>::value_type;
+        const std::uint64_t off = offsets[static_cast<std::size_t>(c)];
+        if (file->mutable_data() == nullptr || off > file->size() ||
+            rows > (file->size() - off) / sizeof(T) || off % alignof(T) != 0)
+            throw std::runtime_error("map_columns: column " + std::string(column_name(c)) +
+                                     " does not fit the mapping");
+        v = ColumnData<T>(file, reinterpret_cast<T*>(file->mutable_data() + off), rows);
+    });
+    rows_       = rows;
+    clustering_ = TimeClustering::None;
+}
+
+void TripDataSoA::drop_columns(ColumnSet cols)
+{
+    for_each_column([&](auto vec, auto, Column c) {
+        if (cols.has(c)) this->*vec = {};
+    });
+    columns_ = columns_ - cols;
+}
+
+std::vector<TripDataSoA> TripDataSoA::split(TripDataSoA&& src,
+                                            std::span<const std::uint32_t> part,
+                                            std::size_t parts)
+{
+    if (part.size() != src.size())
+        throw std::runtime_error("TripDataSoA::split: " + std::to_string(part.size()) +
+                                 " partition ids for " + std::to_string(src.size()) + " rows");
+    std::vector<std::size_t> rows(parts, 0);
+    for (std::uint32_t p : part) ++rows[p];
+
+    std::vector<TripDataSoA> out;
+    out.reserve(parts);
+    for (std::size_t p = 0; p < parts; ++p) {
+        out.emplace_back(src.columns());
+        out.back().resize(rows[p]);
+    }
+    src.for_each_column([&](auto vec, auto, Column c) {
+        std::vector<std::size_t> next(parts, 0);
+        const auto& from = src.*vec;
+        for (std::size_t i = 0; i < part.size(); ++i)
+            (out[part[i]].*vec)[next[part[i]]++] = from[i];
+        src.drop_columns({c});
+    });
+    src.rows_ = 0;
+    return out;
+}
+
+void TripDataSoA::cluster_by_time(TimeClustering order)
+{
+    if (order == TimeClustering::None) return;
+    const bool by_location = order == TimeClustering::DayLocation;
+    if (!columns_.has(Column::PickupTimestamp) ||
+        (by_location && !columns_.has(Column::PuLocationId)))
+        throw std::runtime_error("cluster_by_time: pickup_timestamp" +
+                                 std::string(by_location ? " and pu_location_id" : "") +
+                                 " must be stored");
+
+    const std::size_t n = rows_;
+    const std::int64_t* ts = pickup_timestamp.data();
+    RowIndex perm;
+    perm.resize(n);   // not zero-filled: the sort writes it
+    radix_sort_rows(n, [ts](std::size_t i) { return ts[i]; }, perm.data());
+
+    if (by_location) {
+        // Stable: re-sorting the time order by (day, location) keeps rows of
+        // one day and zone in time order.  The key packs both in one int64.
+        const int* loc = pu_location_id.data();
+        const auto [lo_it, hi_it] = std::minmax_element(loc, loc + n);
+        const std::int64_t loc_min  = n ? *lo_it : 0;
+        const std::int64_t loc_span = n ? std::int64_t{*hi_it} - loc_min + 1 : 1;
+        const std::size_t* by_time = perm.data();
+        RowIndex pos;
+        pos.resize(n);
+        radix_sort_rows(n, [=](std::size_t i) {
+            const std::size_t row = by_time[i];
+            return pickup_day(ts[row]) * loc_span + (loc[row] - loc_min);
+        }, pos.data());
+        RowIndex rows;
+        rows.resize(n);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < n; ++i) rows[i] = by_time[pos[i]];
+        perm = std::move(rows);
+    }
+
+    // Gather a column at a time: the peak is one extra column.
+    const std::size_t* from = perm.data();
+    for_each_column([&](auto vec, auto) {
+        auto& col = this->*vec;
+        std::remove_reference_t<decltype(col)> out;
+        out.resize_for_overwrite(n);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < n; ++i) out[i] = col[from[i]];
+        col = std::move(out);
+    });
+    clustering_ = order;
+}
+
+void TripDataSoA::assign_rows(std::size_t offset, const TripDataSoA& src)
+{
+    for_each_column([&](auto vec, auto) {
+        const auto& from = src.*vec;
+        std::copy(from.begin(), from.end(),
+                  (this->*vec).begin() + static_cast<std::ptrdiff_t>(offset));
+    });
+}
+
 // ============================================================================
 // TripDataSoA::from_aos — AoS → SoA conversion
 // ============================================================================
 
-TripDataSoA TripDataSoA::from_aos(const std::vector<TripRecord>& records)
+TripDataSoA TripDataSoA::from_aos(std::span<const TripRecord> records)
 {
     TripDataSoA soa;
     const std::size_t n = records.size();
 
-    // Pre-allocate all parallel arrays in one pass to avoid reallocations.
-    soa.vendor_id.reserve(n);
-    soa.pickup_timestamp.reserve(n);
-    soa.dropoff_timestamp.reserve(n);
-    soa.passenger_count.reserve(n);
-    soa.trip_distance.reserve(n);
-    soa.rate_code_id.reserve(n);
-    soa.store_and_fwd_flag.reserve(n);
-    soa.pu_location_id.reserve(n);
-    soa.do_location_id.reserve(n);
-    soa.payment_type.reserve(n);
-    soa.fare_amount.reserve(n);
-    soa.extra.reserve(n);
-    soa.mta_tax.reserve(n);
-    soa.tip_amount.reserve(n);
-    soa.tolls_amount.reserve(n);
-    soa.improvement_surcharge.reserve(n);
-    soa.total_amount.reserve(n);
-
-    for (const auto& r : records) {
-        soa.vendor_id.push_back(r.vendor_id);
-        soa.pickup_timestamp.push_back(r.pickup_timestamp);
-        soa.dropoff_timestamp.push_back(r.dropoff_timestamp);
-        soa.passenger_count.push_back(r.passenger_count);
-        soa.trip_distance.push_back(r.trip_distance);
-        soa.rate_code_id.push_back(r.rate_code_id);
-        soa.store_and_fwd_flag.push_back(r.store_and_fwd_flag);
-        soa.pu_location_id.push_back(r.pu_location_id);
-        soa.do_location_id.push_back(r.do_location_id);
-        soa.payment_type.push_back(r.payment_type);
-        soa.fare_amount.push_back(r.fare_amount);
-        soa.extra.push_back(r.extra);
-        soa.mta_tax.push_back(r.mta_tax);
-        soa.tip_amount.push_back(r.tip_amount);
-        soa.tolls_amount.push_back(r.tolls_amount);
-        soa.improvement_surcharge.push_back(r.improvement_surcharge);
-        soa.total_amount.push_back(r.total_amount);
+    // Size the columns without zeroing them, then fill them from the OpenMP
+    // threads: each thread first-touches the pages of the rows it will scan.
+    soa.resize_for_overwrite(n);
+
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < n; ++i) {
+        soa.for_each_column([&](auto vec, auto field) { (soa.*vec)[i] = records[i].*field; });
     }
 
     return soa;
@@ -80,55 +259,29 @@ TripDataSoA TripDataSoA::from_aos(const std::vector<TripRecord>& records)
 // ============================================================================
 
 TripDataSoA TripDataSoA::from_csv(const std::vector<std::string>& paths,
-                                   std::size_t reserve_count)
+                                   std::size_t reserve_count,
+                                   ColumnSet columns,
+                                   ReadMode mode,
+                                   CsvReader::Stats* stats)
 {
-    TripDataSoA soa;
+    TripDataSoA soa(columns);
 
     if (reserve_count > 0) {
-        soa.vendor_id.reserve(reserve_count);
-        soa.pickup_timestamp.reserve(reserve_count);
-        soa.dropoff_timestamp.reserve(reserve_count);
-        soa.passenger_count.reserve(reserve_count);
-        soa.trip_distance.reserve(reserve_count);
-        soa.rate_code_id.reserve(reserve_count);
-        soa.store_and_fwd_flag.reserve(reserve_count);
-        soa.pu_location_id.reserve(reserve_count);
-        soa.do_location_id.reserve(reserve_count);
-        soa.payment_type.reserve(reserve_count);
-        soa.fare_amount.reserve(reserve_count);
-        soa.extra.reserve(reserve_count);
-        soa.mta_tax.reserve(reserve_count);
-        soa.tip_amount.reserve(reserve_count);
-        soa.tolls_amount.reserve(reserve_count);
-        soa.improvement_surcharge.reserve(reserve_count);
-        soa.total_amount.reserve(reserve_count);
+        soa.reserve(reserve_count);
     }
 
+    CsvReader::Stats total;
     for (const auto& path : paths) {
-        CsvReader reader(path);
+        CsvReader reader(path, mode, columns);
         if (!reader.is_open())
             throw std::runtime_error("from_csv: cannot open " + path);
         TripRecord r;
         while (reader.read_next(r)) {
-            soa.vendor_id.push_back(r.vendor_id);
-            soa.pickup_timestamp.push_back(r.pickup_timestamp);
-            soa.dropoff_timestamp.push_back(r.dropoff_timestamp);
-            soa.passenger_count.push_back(r.passenger_count);
-            soa.trip_distance.push_back(r.trip_distance);
-            soa.rate_code_id.push_back(r.rate_code_id);
-            soa.store_and_fwd_flag.push_back(r.store_and_fwd_flag);
-            soa.pu_location_id.push_back(r.pu_location_id);
-            soa.do_location_id.push_back(r.do_location_id);
-            soa.payment_type.push_back(r.payment_type);
-            soa.fare_amount.push_back(r.fare_amount);
-            soa.extra.push_back(r.extra);
-            soa.mta_tax.push_back(r.mta_tax);
-            soa.tip_amount.push_back(r.tip_amount);
-            soa.tolls_amount.push_back(r.tolls_amount);
-            soa.improvement_surcharge.push_back(r.improvement_surcharge);
-            soa.total_amount.push_back(r.total_amount);
+            soa.push_back(r);
         }
+        total += reader.get_stats();
     }
+    if (stats) *stats = total;
 
     return soa;
 }
@@ -140,55 +293,235 @@ TripDataSoA TripDataSoA::from_csv(const std::vector<std::string>& paths,
 SoAQueryEngine::SoAQueryEngine(const TripDataSoA& data)
     : data_(data) {}
 
+SoAQueryEngine::SoAQueryEngine(const CompactTripDataSoA& data)
+    : data_(data.wide), compact_(&data) {}
+
 double SoAQueryEngine::build_indexes()
 {
     auto t0 = std::chrono::steady_clock::now();
 
+    // Rows already in time order: time ranges are row slices, no index.
+    clustered_ = data_.time_clustering();
+    if (clustered_ != TimeClustering::None) {
+        time_sorted_idx_ = RowIndex();
+        build_zone_maps();
+        indexed_ = true;
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(t1 - t0).count();
+    }
+
+    // Not zero-filled (RowIndex): the sort writes every row id, in
+    // parallel, which is also the first touch of the index's pages.
     const std::size_t n = data_.size();
     time_sorted_idx_.resize(n);
-    std::iota(time_sorted_idx_.begin(), time_sorted_idx_.end(), 0);
 
-    // Sort by pickup_timestamp — accesses only the int64 array (cache-friendly).
-    const auto* ts = data_.pickup_timestamp.data();
-    std::sort(time_sorted_idx_.begin(), time_sorted_idx_.end(),
-              [ts](std::size_t a, std::size_t b) {
-                  return ts[a] < ts[b];
-              });
+    // Parallel radix sort of (pickup_timestamp, row) pairs; the column is
+    // read front to back, twice.  Start reading a mapped one in now.
+    // Encoded timestamps decode as base[i >> 10] + offset[i].
+    data_.pickup_timestamp.advise(Access::WillNeed);
+    with_pickup([&](auto ts) {
+        radix_sort_rows(n, [ts](std::size_t i) -> std::int64_t { return ts[i]; },
+                        time_sorted_idx_.data());
+    });
+    build_zone_maps();
 
     indexed_ = true;
     auto t1 = std::chrono::steady_clock::now();
     return std::chrono::duration<double, std::milli>(t1 - t0).count();
 }
 
-// Binary search over the sorted index: returns [lo, hi) range of positions.
-std::pair<std::size_t, std::size_t>
-SoAQueryEngine::time_lookup(std::int64_t start, std::int64_t end) const
+void SoAQueryEngine::restore_indexes(RowIndex time_index)
 {
-    const auto* ts  = data_.pickup_timestamp.data();
-    const auto* idx = time_sorted_idx_.data();
-    const std::size_t n = time_sorted_idx_.size();
+    if (time_index.size() != data_.size())
+        throw std::runtime_error("restore_indexes: index has " +
+                                 std::to_string(time_index.size()) + " rows, data has " +
+                                 std::to_string(data_.size()));
+    time_sorted_idx_ = std::move(time_index);
+    clustered_       = TimeClustering::None;
+    build_zone_maps();
+    indexed_ = true;
+}
+
+namespace {
 
-    // Lower bound: first position i where ts[idx[i]] >= start
+// [lo, hi) of the positions i < n with start <= key(i) <= end, for key(i)
+// non-decreasing in i.
+template <typename KeyAt>
+std::pair<std::size_t, std::size_t>
+key_bounds(std::size_t n, KeyAt key, std::int64_t start, std::int64_t end)
+{
+    // Lower bound: first position i where key(i) >= start
     std::size_t lo = 0, hi_b = n;
     while (lo < hi_b) {
         std::size_t mid = lo + (hi_b - lo) / 2;
-        if (ts[idx[mid]] < start) lo = mid + 1;
-        else                      hi_b = mid;
+        if (key(mid) < start) lo = mid + 1;
+        else                  hi_b = mid;
     }
     const std::size_t range_lo = lo;
 
-    // Upper bound: first position i where ts[idx[i]] > end
+    // Upper bound: first position i where key(i) > end
     std::size_t hi = n;
     lo = range_lo;
     while (lo < hi) {
         std::size_t mid = lo + (hi - lo) / 2;
-        if (ts[idx[mid]] <= end) lo = mid + 1;
-        else                     hi = mid;
+        if (key(mid) <= end) lo = mid + 1;
+        else                 hi = mid;
     }
 
     return {range_lo, lo};
 }
 
+} // namespace
+
+// Binary search over the sorted index: returns [lo, hi) range of positions.
+std::pair<std::size_t, std::size_t>
+SoAQueryEngine::time_lookup(std::int64_t start, std::int64_t end) const
+{
+    // ~2 log N scattered probes: read-ahead around each would be wasted.
+    data_.pickup_timestamp.advise(Access::Random);
+    const auto* idx = time_sorted_idx_.data();
+    const std::size_t n = time_sorted_idx_.size();
+
+    return with_pickup([&](auto ts) {
+        return key_bounds(n, [&](std::size_t i) -> std::int64_t { return ts[idx[i]]; },
+                          start, end);
+    });
+}
+
+// Binary search over the clustered pickup column itself: a range of rows.
+std::pair<std::size_t, std::size_t>
+SoAQueryEngine::time_slice(std::int64_t start, std::int64_t end) const
+{
+    data_.pickup_timestamp.advise(Access::Random);
+    const std::size_t n = data_.size();
+
+    return with_pickup([&](auto ts) {
+        if (slice_exact())
+            return key_bounds(n, [&](std::size_t i) -> std::int64_t { return ts[i]; },
+                              start, end);
+        // By day, then location: only the day is in row order.
+        return key_bounds(n, [&](std::size_t i) { return pickup_day(ts[i]); },
+                          pickup_day(start), pickup_day(end));
+    });
+}
+
+namespace {
+
+// Q1 kernel, and Q2 - Q4 without zones: rows with lo <= col[i] <= hi.
+template <typename T>
+void scan_range(const T* col, std::size_t n, T lo, T hi, SoAQueryResult& result)
+{
+    #pragma omp parallel
+    {
+        std::vector<std::size_t> local;
+#if defined(_OPENMP)
+        local.reserve(n / (10 * omp_get_num_threads()));
+#else
+        local.reserve(n / 10);
+#endif
+        #pragma omp for nowait schedule(static)
+        for (std::size_t i = 0; i < n; ++i) {
+            if (col[i] >= lo && col[i] <= hi)
+                local.push_back(i);
+        }
+
+        #pragma omp critical
+        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    }
+}
+
+// Q2 / Q3 / Q4 kernel: scan_range pruned by the column's zones, which hold
+// the same values as doubles and are matched against [zlo, zhi].  Only rows
+// of undecided blocks are read and counted in result.scanned.
+template <typename T>
+void scan_zones(const T* col, std::size_t n, T lo, T hi,
+                std::span<const Zone> zones, double zlo, double zhi,
+                SoAQueryResult& result)
+{
+    if (zones.empty()) {
+        scan_range(col, n, lo, hi, result);
+        result.scanned = n;
+        return;
+    }
+    const auto blocks = static_cast<std::ptrdiff_t>(zones.size());
+    std::size_t scanned = 0;
+
+    #pragma omp parallel reduction(+ : scanned)
+    {
+        std::vector<std::size_t> local;
+        #pragma omp for nowait schedule(static)
+        for (std::ptrdiff_t b = 0; b < blocks; ++b) {
+            const ZoneMatch m = zone_match(zones[b], zlo, zhi);
+            if (m == ZoneMatch::None) continue;
+            const std::size_t first = static_cast<std::size_t>(b) << ZoneMap::kBlockShift;
+            const std::size_t last  = std::min(n, first + ZoneMap::kBlockRows);
+            if (m == ZoneMatch::All) {
+                for (std::size_t i = first; i < last; ++i) local.push_back(i);
+                continue;
+            }
+            scanned += last - first;
+            for (std::size_t i = first; i < last; ++i) {
+                if (col[i] >= lo && col[i] <= hi)
+                    local.push_back(i);
+            }
+        }
+
+        #pragma omp critical
+        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    }
+    result.scanned = scanned;
+}
+
+// Q1 kernel over block-encoded timestamps: blocks outside the range are
+// skipped from their min / max, the rest filtered on 4-byte offsets.
+void scan_time_blocks(const TimestampColumn::Reader& ts, std::size_t n,
+                      const TimeRangeQuery& q, SoAQueryResult& result)
+{
+    const auto blocks = static_cast<std::ptrdiff_t>(ts.blocks);
+
+    #pragma omp parallel
+    {
+        std::vector<std::size_t> local;
+        #pragma omp for nowait schedule(static)
+        for (std::ptrdiff_t b = 0; b < blocks; ++b) {
+            std::uint32_t lo, hi;
+            if (!ts.block_range(b, q.start_time, q.end_time, lo, hi)) continue;
+            const std::size_t first = static_cast<std::size_t>(b) << TimestampColumn::kBlockShift;
+            const std::size_t last  = std::min(n, first + TimestampColumn::kBlockRows);
+            for (std::size_t i = first; i < last; ++i) {
+                if (ts.offsets[i] >= lo && ts.offsets[i] <= hi)
+                    local.push_back(i);
+            }
+        }
+
+        #pragma omp critical
+        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    }
+}
+
+// Q1 / Q5 kernel over a time-clustered table: rows lo .. hi-1 with
+// match(row), read stride-1.
+template <typename Match>
+void scan_slice(std::size_t lo, std::size_t hi, Match match, SoAQueryResult& result)
+{
+    result.scanned = hi - lo;
+
+    #pragma omp parallel
+    {
+        std::vector<std::size_t> local;
+        #pragma omp for nowait schedule(static)
+        for (std::size_t i = lo; i < hi; ++i) {
+            if (match(i))
+                local.push_back(i);
+        }
+
+        #pragma omp critical
+        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    }
+}
+
+} // namespace
+
 // ============================================================================
 // Query 1: Time range — O(log N) via sorted index, then parallel gather
 // ============================================================================
@@ -197,6 +530,26 @@ SoAQueryResult SoAQueryEngine::search_by_time(const TimeRangeQuery& q) const
 {
     SoAQueryResult result;
 
+    if (clustered_ != TimeClustering::None) {
+        // The rows of the range are a slice: no index, no gather.
+        auto [lo, hi] = time_slice(q.start_time, q.end_time);
+        if (slice_exact()) {
+            result.scanned = hi - lo;
+            result.indices.resize(hi - lo);
+            std::size_t* out = result.indices.data();
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = lo; i < hi; ++i) out[i - lo] = i;
+            return result;
+        }
+        data_.pickup_timestamp.advise(Access::Sequential);
+        const std::int64_t start = q.start_time, end = q.end_time;
+        with_pickup([&](auto ts) {
+            scan_slice(lo, hi, [=](std::size_t i) { return ts[i] >= start && ts[i] <= end; },
+                       result);
+        });
+        return result;
+    }
+
     if (indexed_) {
         auto [lo, hi] = time_lookup(q.start_time, q.end_time);
         result.scanned = hi - lo;
@@ -229,26 +582,14 @@ SoAQueryResult SoAQueryEngine::search_by_time(const TimeRangeQuery& q) const
         // Fallback: full linear scan over the pickup_timestamp array only.
         const std::size_t n = data_.size();
         result.scanned = n;
-        const auto* ts = data_.pickup_timestamp.data();
-
-        #pragma omp parallel
-        {
-            std::vector<std::size_t> local;
-#if defined(_OPENMP)
-            local.reserve(n / (10 * omp_get_num_threads()));
-#else
-            local.reserve(n / 10);
-#endif
-            #pragma omp for nowait schedule(static)
-            for (std::size_t i = 0; i < n; ++i) {
-                if (ts[i] >= q.start_time && ts[i] <= q.end_time)
-                    local.push_back(i);
-            }
-
-            #pragma omp critical
-            result.indices.insert(result.indices.end(),
-                                  local.begin(), local.end());
-        }
+        data_.pickup_timestamp.advise(Access::Sequential);
+
+        with_pickup([&](auto ts) {
+            if constexpr (std::is_same_v<decltype(ts), TimestampColumn::Reader>)
+                scan_time_blocks(ts, n, q, result);
+            else
+                scan_range(ts, n, q.start_time, q.end_time, result);
+        });
     }
 
     return result;
@@ -261,67 +602,44 @@ SoAQueryResult SoAQueryEngine::search_by_time(const TimeRangeQuery& q) const
 SoAQueryResult SoAQueryEngine::search_by_distance(const NumericRangeQuery& q) const
 {
     SoAQueryResult result;
-    const std::size_t n  = data_.size();
-    result.scanned       = n;
+    const std::size_t n = data_.size();
 
     // Pointer to contiguous double array — compiler can use SIMD (AVX2/AVX-512).
-    const double* dist = data_.trip_distance.data();
-    const double  lo   = q.min_val;
-    const double  hi   = q.max_val;
-
-    #pragma omp parallel
-    {
-        std::vector<std::size_t> local;
-#if defined(_OPENMP)
-        local.reserve(n / (10 * omp_get_num_threads()));
-#else
-        local.reserve(n / 10);
-#endif
-        #pragma omp for nowait schedule(static)
-        for (std::size_t i = 0; i < n; ++i) {
-            if (dist[i] >= lo && dist[i] <= hi)
-                local.push_back(i);
-        }
-
-        #pragma omp critical
-        result.indices.insert(result.indices.end(), local.begin(), local.end());
-    }
-
+    // Only this column is touched; a mapped one is read ahead front to back.
+    data_.trip_distance.advise(Access::Sequential);
+    scan_zones(data_.trip_distance.data(), n, q.min_val, q.max_val,
+               zones_.zones(Column::TripDistance), q.min_val, q.max_val, result);
     return result;
 }
 
 // ============================================================================
-// Query 3: Fare (total_amount) range — contiguous double[] scan
+// Query 3: Fare (total_amount) range — contiguous double[] (or cents) scan
 // ============================================================================
 
 SoAQueryResult SoAQueryEngine::search_by_fare(const NumericRangeQuery& q) const
 {
     SoAQueryResult result;
-    const std::size_t n  = data_.size();
-    result.scanned       = n;
-
-    const double* amt = data_.total_amount.data();
-    const double  lo  = q.min_val;
-    const double  hi  = q.max_val;
-
-    #pragma omp parallel
-    {
-        std::vector<std::size_t> local;
-#if defined(_OPENMP)
-        local.reserve(n / (10 * omp_get_num_threads()));
-#else
-        local.reserve(n / 10);
-#endif
-        #pragma omp for nowait schedule(static)
-        for (std::size_t i = 0; i < n; ++i) {
-            if (amt[i] >= lo && amt[i] <= hi)
-                local.push_back(i);
-        }
-
-        #pragma omp critical
-        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    const std::size_t n     = data_.size();
+    const auto        zones = zones_.zones(Column::TotalAmount);
+
+    if (compact_) {
+        // Cents compare as int32: twice the lanes of a double compare, with
+        // the bounds rounded so that exactly the same rows match.
+        compact_->total_amount.visit([&](auto amt) {
+            if constexpr (std::is_integral_v<typename decltype(amt)::value_type>) {
+                std::int32_t lo, hi;
+                if (cents_range(q.min_val, q.max_val, lo, hi))
+                    scan_zones(amt.data(), n, lo, hi, zones, q.min_val, q.max_val, result);
+            } else {
+                scan_zones(amt.data(), n, q.min_val, q.max_val, zones, q.min_val, q.max_val, result);
+            }
+        });
+        return result;
     }
 
+    data_.total_amount.advise(Access::Sequential);
+    scan_zones(data_.total_amount.data(), n, q.min_val, q.max_val,
+               zones, q.min_val, q.max_val, result);
     return result;
 }
 
@@ -333,31 +651,24 @@ SoAQueryResult SoAQueryEngine::search_by_fare(const NumericRangeQuery& q) const
 SoAQueryResult SoAQueryEngine::search_by_location(const IntRangeQuery& q) const
 {
     SoAQueryResult result;
-    const std::size_t n  = data_.size();
-    result.scanned       = n;
-
-    const int* loc = data_.pu_location_id.data();
-    const int  lo  = q.min_val;
-    const int  hi  = q.max_val;
-
-    #pragma omp parallel
-    {
-        std::vector<std::size_t> local;
-#if defined(_OPENMP)
-        local.reserve(n / (10 * omp_get_num_threads()));
-#else
-        local.reserve(n / 10);
-#endif
-        #pragma omp for nowait schedule(static)
-        for (std::size_t i = 0; i < n; ++i) {
-            if (loc[i] >= lo && loc[i] <= hi)
-                local.push_back(i);
-        }
-
-        #pragma omp critical
-        result.indices.insert(result.indices.end(), local.begin(), local.end());
+    const std::size_t n     = data_.size();
+    const auto        zones = zones_.zones(Column::PuLocationId);
+
+    if (compact_) {
+        // Compare in the column's own type: a uint16_t scan moves half the
+        // bytes of an int one.  A range outside the type matches nothing.
+        compact_->pu_location_id.visit([&](auto loc) {
+            using T = typename decltype(loc)::value_type;
+            T lo, hi;
+            if (narrow_range(q.min_val, q.max_val, lo, hi))
+                scan_zones(loc.data(), n, lo, hi, zones, q.min_val, q.max_val, result);
+        });
+        return result;
     }
 
+    data_.pu_location_id.advise(Access::Sequential);
+    scan_zones(data_.pu_location_id.data(), n, q.min_val, q.max_val,
+               zones, q.min_val, q.max_val, result);
     return result;
 }
 
@@ -367,21 +678,62 @@ SoAQueryResult SoAQueryEngine::search_by_location(const IntRangeQuery& q) const
 // ============================================================================
 
 SoAQueryResult SoAQueryEngine::search_combined(const CombinedQuery& q) const
+{
+    const int pax_lo = q.passenger_range.min_val;
+    const int pax_hi = q.passenger_range.max_val;
+    if (!compact_) {
+        const bool gather = indexed_ && clustered_ == TimeClustering::None;
+        data_.passenger_count.advise(gather ? Access::Normal : Access::Sequential);
+        const int* pax = data_.passenger_count.data();
+        return search_combined(q, [=](std::size_t row) {
+            return pax[row] >= pax_lo && pax[row] <= pax_hi;
+        });
+    }
+    // One pass over the packed codes (a few word ops per 64 rows) turns the
+    // passenger predicate into a bitmap; the row loop then tests one bit.
+    const SelectionBitmap sel = compact_->passenger_count.select(pax_lo, pax_hi);
+    return search_combined(q, [&sel](std::size_t row) { return selected(sel, row); });
+}
+
+template <typename PaxMatch>
+SoAQueryResult SoAQueryEngine::search_combined(const CombinedQuery& q, PaxMatch pax) const
 {
     SoAQueryResult result;
 
     const double* dist = data_.trip_distance.data();
-    const int*    pax  = data_.passenger_count.data();
     const auto*   idx  = time_sorted_idx_.data();
 
     const double  dist_lo = q.distance_range.min_val;
     const double  dist_hi = q.distance_range.max_val;
-    const int     pax_lo  = q.passenger_range.min_val;
-    const int     pax_hi  = q.passenger_range.max_val;
 
-    if (indexed_) {
+    if (clustered_ != TimeClustering::None) {
+        // A slice of rows: every column is read stride-1, as in a scan.
+        const std::int64_t start = q.time_range.start_time;
+        const std::int64_t end   = q.time_range.end_time;
+        auto [lo, hi] = time_slice(start, end);
+        const bool exact = slice_exact();
+        data_.pickup_timestamp.advise(exact ? Access::Normal : Access::Sequential);
+        data_.trip_distance.advise(Access::Sequential);
+        // By value: the bounds stay in registers across push_back().  An
+        // exact slice does not read the pickup column at all.
+        if (exact) {
+            scan_slice(lo, hi, [=](std::size_t i) {
+                return dist[i] >= dist_lo && dist[i] <= dist_hi && pax(i);
+            }, result);
+        } else {
+            with_pickup([&](auto ts) {
+                scan_slice(lo, hi, [=](std::size_t i) {
+                    return ts[i] >= start && ts[i] <= end &&
+                           dist[i] >= dist_lo && dist[i] <= dist_hi && pax(i);
+                }, result);
+            });
+        }
+    } else if (indexed_) {
         auto [lo, hi] = time_lookup(q.time_range.start_time, q.time_range.end_time);
         result.scanned = hi - lo;
+        // Gathers through the index: rows of a time window are mostly
+        // clustered in the files, so keep the default read-ahead.
+        data_.trip_distance.advise(Access::Normal);
 
         #pragma omp parallel
         {
@@ -394,8 +746,7 @@ SoAQueryResult SoAQueryEngine::search_combined(const CombinedQuery& q) const
             #pragma omp for nowait schedule(static)
             for (std::size_t i = lo; i < hi; ++i) {
                 std::size_t row = idx[i];
-                if (dist[row] >= dist_lo && dist[row] <= dist_hi &&
-                    pax[row]  >= pax_lo  && pax[row]  <= pax_hi)
+                if (dist[row] >= dist_lo && dist[row] <= dist_hi && pax(row))
                     local.push_back(row);
             }
 
@@ -406,29 +757,31 @@ SoAQueryResult SoAQueryEngine::search_combined(const CombinedQuery& q) const
     } else {
         const std::size_t n = data_.size();
         result.scanned      = n;
-        const auto* ts      = data_.pickup_timestamp.data();
+        data_.pickup_timestamp.advise(Access::Sequential);
+        data_.trip_distance.advise(Access::Sequential);
 
-        #pragma omp parallel
-        {
-            std::vector<std::size_t> local;
+        with_pickup([&](auto ts) {
+            #pragma omp parallel
+            {
+                std::vector<std::size_t> local;
 #if defined(_OPENMP)
-            local.reserve(n / (20 * omp_get_num_threads()));
+                local.reserve(n / (20 * omp_get_num_threads()));
 #else
-            local.reserve(n / 20);
+                local.reserve(n / 20);
 #endif
-            #pragma omp for nowait schedule(static)
-            for (std::size_t i = 0; i < n; ++i) {
-                if (ts[i]   >= q.time_range.start_time &&
-                    ts[i]   <= q.time_range.end_time   &&
-                    dist[i] >= dist_lo && dist[i] <= dist_hi &&
-                    pax[i]  >= pax_lo  && pax[i]  <= pax_hi)
-                    local.push_back(i);
-            }
+                #pragma omp for nowait schedule(static)
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (ts[i]   >= q.time_range.start_time &&
+                        ts[i]   <= q.time_range.end_time   &&
+                        dist[i] >= dist_lo && dist[i] <= dist_hi && pax(i))
+                        local.push_back(i);
+                }
 
-            #pragma omp critical
-            result.indices.insert(result.indices.end(),
-                                  local.begin(), local.end());
-        }
+                #pragma omp critical
+                result.indices.insert(result.indices.end(),
+                                      local.begin(), local.end());
+            }
+        });
     }
 
     return result;
@@ -441,41 +794,107 @@ SoAQueryResult SoAQueryEngine::search_combined(const CombinedQuery& q) const
 
 AggregationResult SoAQueryEngine::aggregate_fare_by_time(const TimeRangeQuery& q) const
 {
+    if (!compact_) {
+        // Index gather, as in Q5; otherwise a scan or a clustered slice.
+        const bool gather = indexed_ && clustered_ == TimeClustering::None;
+        data_.fare_amount.advise(gather ? Access::Normal : Access::Sequential);
+        return aggregate_fare_by_time(q, data_.fare_amount.data());
+    }
+    return compact_->fare_amount.visit([&](auto fare) {
+        return aggregate_fare_by_time(q, fare.data());
+    });
+}
+
+template <typename T>
+AggregationResult SoAQueryEngine::aggregate_fare_by_time(const TimeRangeQuery& q,
+                                                         const T* fare) const
+{
+    // Cents add up in int64: exact, so the sum is the same for any thread
+    // count or schedule.  Doubles round differently per partial sum.
+    using Sum = std::conditional_t<std::is_integral_v<T>, std::int64_t, double>;
+
     AggregationResult result;
-    const double* fare = data_.fare_amount.data();
     const auto*   idx  = time_sorted_idx_.data();
+    Sum           sum  = 0;
+
+    if (clustered_ != TimeClustering::None) {
+        // Stride-1 over the slice: a plain sum, or for whole days a select
+        // on the pickup time, which vectorises as well.
+        auto [lo, hi] = time_slice(q.start_time, q.end_time);
+        const std::int64_t start = q.start_time, end = q.end_time;
+        Sum         local_sum   = 0;
+        std::size_t local_count = 0;
 
-    if (indexed_) {
+        if (slice_exact()) {
+            #pragma omp parallel for reduction(+:local_sum) schedule(static)
+            for (std::size_t i = lo; i < hi; ++i) local_sum += fare[i];
+            local_count = hi - lo;
+        } else {
+            with_pickup([&](auto ts) {
+                #pragma omp parallel for reduction(+:local_sum,local_count) schedule(static)
+                for (std::size_t i = lo; i < hi; ++i) {
+                    const bool in = ts[i] >= start && ts[i] <= end;
+                    local_sum   += in ? fare[i] : Sum{0};
+                    local_count += in;
+                }
+            });
+        }
+        sum          = local_sum;
+        result.count = local_count;
+    } else if (indexed_) {
         auto [lo, hi] = time_lookup(q.start_time, q.end_time);
         result.count = hi - lo;
 
-        double local_sum = 0.0;
+        Sum local_sum = 0;
         // Reduction over fare_amount values accessed via sorted index.
         // The SIMD unit sees a gather pattern here; still parallelises well.
         #pragma omp parallel for reduction(+:local_sum) schedule(static)
         for (std::size_t i = lo; i < hi; ++i)
             local_sum += fare[idx[i]];
 
-        result.sum = local_sum;
+        sum = local_sum;
     } else {
         const std::size_t n = data_.size();
-        const auto* ts      = data_.pickup_timestamp.data();
+        data_.pickup_timestamp.advise(Access::Sequential);
 
-        double      local_sum   = 0.0;
+        Sum         local_sum   = 0;
         std::size_t local_count = 0;
 
-        #pragma omp parallel for reduction(+:local_sum,local_count) schedule(static)
-        for (std::size_t i = 0; i < n; ++i) {
-            if (ts[i] >= q.start_time && ts[i] <= q.end_time) {
-                // Access fare_amount[] — contiguous typed array.
-                local_sum += fare[i];
-                ++local_count;
+        with_pickup([&](auto ts) {
+            if constexpr (std::is_same_v<decltype(ts), TimestampColumn::Reader>) {
+                // Encoded: skip whole blocks, compare offsets in the rest.
+                const auto blocks = static_cast<std::ptrdiff_t>(ts.blocks);
+                #pragma omp parallel for reduction(+:local_sum,local_count) schedule(static)
+                for (std::ptrdiff_t b = 0; b < blocks; ++b) {
+                    std::uint32_t lo, hi;
+                    if (!ts.block_range(b, q.start_time, q.end_time, lo, hi)) continue;
+                    const std::size_t first = static_cast<std::size_t>(b) << TimestampColumn::kBlockShift;
+                    const std::size_t last  = std::min(n, first + TimestampColumn::kBlockRows);
+                    for (std::size_t i = first; i < last; ++i) {
+                        if (ts.offsets[i] >= lo && ts.offsets[i] <= hi) {
+                            local_sum += fare[i];
+                            ++local_count;
+                        }
+                    }
+                }
+            } else {
+                #pragma omp parallel for reduction(+:local_sum,local_count) schedule(static)
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (ts[i] >= q.start_time && ts[i] <= q.end_time) {
+                        // Access fare_amount[] — contiguous typed array.
+                        local_sum += fare[i];
+                        ++local_count;
+                    }
+                }
             }
-        }
-        result.sum   = local_sum;
+        });
+        sum          = local_sum;
         result.count = local_count;
     }
 
+    result.sum = std::is_integral_v<T> ? static_cast<double>(sum) / 100.0
+                                       : static_cast<double>(sum);
+
     if (result.count > 0)
         result.avg = result.sum / static_cast<double>(result.count);
 
@@ -1,26 +1,26 @@
 #include "taxi/TimeIndex.hpp"
+#include "taxi/HotColdTrips.hpp"
+#include "taxi/RadixSort.hpp"
 #include <algorithm>
-#include <numeric>
 
 namespace taxi {
 
-void TimeIndex::build(const std::vector<TripRecord>& records) {
+template <typename Record>
+void TimeIndex::build(std::span<const Record> records) {
     const std::size_t n = records.size();
-    indices_.resize(n);
+    indices_.resize(n);   // RowIndex: not zero-filled
 
-    std::iota(indices_.begin(), indices_.end(), std::size_t{0});
-
-    std::sort(indices_.begin(), indices_.end(),
-        [&records](std::size_t a, std::size_t b) {
-            return records[a].pickup_timestamp < records[b].pickup_timestamp;
-        }
-    );
+    // Parallel radix sort of (timestamp, row) pairs: the records are read
+    // twice, front to back, instead of at random for every comparison.
+    radix_sort_rows(n, [&records](std::size_t i) { return records[i].pickup_timestamp; },
+                    indices_.data());
 
     built_ = true;
 }
 
+template <typename Record>
 std::pair<std::size_t, std::size_t> TimeIndex::lookup(
-    const std::vector<TripRecord>& records,
+    std::span<const Record> records,
     std::int64_t start_time,
     std::int64_t end_time
 ) const {
@@ -48,4 +48,11 @@ std::pair<std::size_t, std::size_t> TimeIndex::lookup(
     };
 }
 
+template void TimeIndex::build(std::span<const TripRecord>);
+template void TimeIndex::build(std::span<const TripHot>);
+template std::pair<std::size_t, std::size_t>
+TimeIndex::lookup(std::span<const TripRecord>, std::int64_t, std::int64_t) const;
+template std::pair<std::size_t, std::size_t>
+TimeIndex::lookup(std::span<const TripHot>, std::int64_t, std::int64_t) const;
+
 } // namespace taxi
@@ -0,0 +1,95 @@
+#include "taxi/TripDataAoSoA.hpp"
+
+namespace taxi {
+
+namespace {
+
+// fn(TripTile member, TripRecord member, TripDataSoA member, Column) per field.
+template <typename Fn>
+void for_each_field(Fn&& fn)
+{
+    fn(&TripTile::vendor_id,             &TripRecord::vendor_id,
+       &TripDataSoA::vendor_id,             Column::VendorId);
+    fn(&TripTile::pickup_timestamp,      &TripRecord::pickup_timestamp,
+       &TripDataSoA::pickup_timestamp,      Column::PickupTimestamp);
+    fn(&TripTile::dropoff_timestamp,     &TripRecord::dropoff_timestamp,
+       &TripDataSoA::dropoff_timestamp,     Column::DropoffTimestamp);
+    fn(&TripTile::passenger_count,       &TripRecord::passenger_count,
+       &TripDataSoA::passenger_count,       Column::PassengerCount);
+    fn(&TripTile::trip_distance,         &TripRecord::trip_distance,
+       &TripDataSoA::trip_distance,         Column::TripDistance);
+    fn(&TripTile::rate_code_id,          &TripRecord::rate_code_id,
+       &TripDataSoA::rate_code_id,          Column::RateCodeId);
+    fn(&TripTile::store_and_fwd_flag,    &TripRecord::store_and_fwd_flag,
+       &TripDataSoA::store_and_fwd_flag,    Column::StoreAndFwdFlag);
+    fn(&TripTile::pu_location_id,        &TripRecord::pu_location_id,
+       &TripDataSoA::pu_location_id,        Column::PuLocationId);
+    fn(&TripTile::do_location_id,        &TripRecord::do_location_id,
+       &TripDataSoA::do_location_id,        Column::DoLocationId);
+    fn(&TripTile::payment_type,          &TripRecord::payment_type,
+       &TripDataSoA::payment_type,          Column::PaymentType);
+    fn(&TripTile::fare_amount,           &TripRecord::fare_amount,
+       &TripDataSoA::fare_amount,           Column::FareAmount);
+    fn(&TripTile::extra,                 &TripRecord::extra,
+       &TripDataSoA::extra,                 Column::Extra);
+    fn(&TripTile::mta_tax,               &TripRecord::mta_tax,
+       &TripDataSoA::mta_tax,               Column::MtaTax);
+    fn(&TripTile::tip_amount,            &TripRecord::tip_amount,
+       &TripDataSoA::tip_amount,            Column::TipAmount);
+    fn(&TripTile::tolls_amount,          &TripRecord::tolls_amount,
+       &TripDataSoA::tolls_amount,          Column::TollsAmount);
+    fn(&TripTile::improvement_surcharge, &TripRecord::improvement_surcharge,
+       &TripDataSoA::improvement_surcharge, Column::ImprovementSurcharge);
+    fn(&TripTile::total_amount,          &TripRecord::total_amount,
+       &TripDataSoA::total_amount,          Column::TotalAmount);
+}
+
+} // namespace
+
+void TripDataAoSoA::push_back(const TripRecord& r)
+{
+    const std::size_t lane = rows_ % kTileRows;
+    if (lane == 0) tiles.emplace_back();   // value-initialised: all zero
+    TripTile& tile = tiles.back();
+    for_each_field([&](auto tile_field, auto field, auto, Column) {
+        (tile.*tile_field)[lane] = r.*field;
+    });
+    ++rows_;
+}
+
+TripRecord TripDataAoSoA::record(std::size_t i) const
+{
+    const TripTile& tile = tiles[i / kTileRows];
+    const std::size_t lane = i % kTileRows;
+    TripRecord r;
+    for_each_field([&](auto tile_field, auto field, auto, Column) {
+        r.*field = (tile.*tile_field)[lane];
+    });
+    return r;
+}
+
+TripDataAoSoA TripDataAoSoA::from_aos(std::span<const TripRecord> records)
+{
+    TripDataAoSoA out;
+    out.reserve(records.size());
+    for (const auto& r : records) out.push_back(r);
+    return out;
+}
+
+TripDataAoSoA TripDataAoSoA::from_soa(const TripDataSoA& soa)
+{
+    TripDataAoSoA out;
+    const std::size_t n = soa.size();
+    out.tiles.resize((n + kTileRows - 1) / kTileRows);
+    out.rows_ = n;
+    // Column by column: each pass reads one SoA array front to back.
+    for_each_field([&](auto tile_field, auto, auto column, Column c) {
+        if (!soa.columns().has(c)) return;
+        const auto* src = (soa.*column).data();
+        for (std::size_t i = 0; i < n; ++i)
+            (out.tiles[i / kTileRows].*tile_field)[i % kTileRows] = src[i];
+    });
+    return out;
+}
+
+} // namespace taxi
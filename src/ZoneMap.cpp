@@ -0,0 +1,82 @@
+#include "taxi/ZoneMap.hpp"
+#include "taxi/TripDataSoA.hpp"
+#include "taxi/CompactSoA.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace taxi {
+
+ZoneMap ZoneMap::build(const TripDataSoA& data)
+{
+    ZoneMap map;
+    const std::size_t n = data.size();
+    auto add = [&](Column c, const auto& col) {
+        if (!data.columns().has(c) || col.is_mapped()) return;
+        const auto* v = col.data();
+        map.add(c, n, [v](std::size_t i) { return v[i]; });
+    };
+    add(Column::VendorId,             data.vendor_id);
+    add(Column::PickupTimestamp,      data.pickup_timestamp);
+    add(Column::DropoffTimestamp,     data.dropoff_timestamp);
+    add(Column::PassengerCount,       data.passenger_count);
+    add(Column::TripDistance,         data.trip_distance);
+    add(Column::RateCodeId,           data.rate_code_id);
+    add(Column::StoreAndFwdFlag,      data.store_and_fwd_flag);
+    add(Column::PuLocationId,         data.pu_location_id);
+    add(Column::DoLocationId,         data.do_location_id);
+    add(Column::PaymentType,          data.payment_type);
+    add(Column::FareAmount,           data.fare_amount);
+    add(Column::Extra,                data.extra);
+    add(Column::MtaTax,               data.mta_tax);
+    add(Column::TipAmount,            data.tip_amount);
+    add(Column::TollsAmount,          data.tolls_amount);
+    add(Column::ImprovementSurcharge, data.improvement_surcharge);
+    add(Column::TotalAmount,          data.total_amount);
+    return map;
+}
+
+ZoneMap ZoneMap::build(const CompactTripDataSoA& data)
+{
+    ZoneMap map = build(data.wide);
+    const std::size_t n = data.size();
+    const ColumnSet compact = data.columns() - data.wide.columns();
+
+    // Summaries are of the values, not of the encodings: money in dollars.
+    for (auto [c, col] : {std::pair{Column::VendorId,        &data.vendor_id},
+                          std::pair{Column::PassengerCount,  &data.passenger_count},
+                          std::pair{Column::RateCodeId,      &data.rate_code_id},
+                          std::pair{Column::PaymentType,     &data.payment_type},
+                          std::pair{Column::StoreAndFwdFlag, &data.store_and_fwd_flag}})
+        if (compact.has(c)) map.add(c, n, [col](std::size_t i) { return (*col)[i]; });
+
+    for (auto [c, col] : {std::pair{Column::PuLocationId, &data.pu_location_id},
+                          std::pair{Column::DoLocationId, &data.do_location_id}})
+        if (compact.has(c))
+            col->visit([&](auto v) { map.add(c, n, [v](std::size_t i) { return v[i]; }); });
+
+    for (auto [c, col] : {std::pair{Column::FareAmount,           &data.fare_amount},
+                          std::pair{Column::Extra,                &data.extra},
+                          std::pair{Column::MtaTax,               &data.mta_tax},
+                          std::pair{Column::TipAmount,            &data.tip_amount},
+                          std::pair{Column::TollsAmount,          &data.tolls_amount},
+                          std::pair{Column::ImprovementSurcharge, &data.improvement_surcharge},
+                          std::pair{Column::TotalAmount,          &data.total_amount}})
+        if (compact.has(c))
+            col->visit([&](auto v) {
+                if constexpr (std::is_integral_v<typename decltype(v)::value_type>)
+                    map.add(c, n, [v](std::size_t i) { return static_cast<double>(v[i]) / 100.0; });
+                else
+                    map.add(c, n, [v](std::size_t i) { return v[i]; });
+            });
+
+    if (compact.has(Column::PickupTimestamp))
+        data.pickup_timestamp.visit([&](auto ts) {
+            map.add(Column::PickupTimestamp, n, [ts](std::size_t i) { return ts[i]; });
+        });
+    if (compact.has(Column::DropoffTimestamp))
+        map.add(Column::DropoffTimestamp, n, [&data](std::size_t i) { return data.dropoff_at(i); });
+    return map;
+}
+
+} // namespace taxi
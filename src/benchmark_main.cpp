@@ -14,16 +14,69 @@
  *   --output <file>    Write metrics CSV to this path (e.g. results/bench.csv)
  *   --serial           Phase 1 baseline: 1 thread for load + queries
  *   --threads N        Phase 2 parallel: N threads for load + OMP queries
+ *   --columns <list>   With --soa-direct: load only these columns (TripRecord
+ *                      or TLC header names); queries needing others are skipped
+ *   --pipeline         Load through IngestPipeline (reader -> N parsers ->
+ *                      placer over bounded queues); prints per-stage busy/idle
+ *   --io <backend>     Serial loads: read with mmap (default), stream,
+ *                      buffered, pread or direct (io_uring + O_DIRECT).  The
+ *                      inputs are evicted from the page cache before each run;
+ *                      peak RSS and the input left cached are reported
+ *   --save-snapshot <file>
+ *                      With --soa-direct: after loading and indexing, write a
+ *                      binary snapshot (see Snapshot) to <file>
+ *   --map-snapshot     With a snapshot input: map its columns instead of
+ *                      reading them; they page in as queries touch them, and
+ *                      the MB paged in is printed after each query
+ *   --compact          With --soa-direct or a snapshot: store the code
+ *                      columns bit-packed or at the width they need, money as
+ *                      int32 cents and timestamps frame-of-reference encoded
+ *                      (CompactSoA); queries scan the compact columns, Q6
+ *                      summing cents exactly
+ *   --partition        With --soa-direct (not --compact): after the usual
+ *                      run, split the table into monthly PartitionedDataset
+ *                      partitions, index them and rerun the queries there
+ *                      (rows Q1_PART ... Q6_PART)
+ *   --hot-cold         AoS phases (not --soa / --soa-direct): after the usual
+ *                      run, split the records into HotColdTrips and rerun the
+ *                      queries over the 40-byte hot array (rows Q1_HOT ...)
+ *   --small-pages      Back the SoA columns and row indexes with 4 KB pages
+ *                      only (default: 2 MB huge pages, see HugePages.hpp)
+ *   --mem-counters     With --soa-direct: count minor page faults and (where
+ *                      the CPU exposes them) dTLB load misses per load, index
+ *                      build and query run (rows MEM_LOAD, MEM_Q1 ...)
+ *   --aosoa            AoS phases (not --soa / --soa-direct): after the usual
+ *                      run, convert the records to SoA and rerun the queries
+ *                      (rows Q1_SOA ...), then convert that to the tiled
+ *                      TripDataAoSoA and rerun them again (rows Q1_AOSOA ...):
+ *                      all three layouts in one CSV
+ *   --ingest-bench     Ingest micro-benchmarks only (CSV structural scan GB/s
+ *                      per SIMD kernel, stod vs from_chars field decoding);
+ *                      no dataset is loaded
  *
  * Multiple CSV files are concatenated into one dataset before querying.
+ * A snapshot file may be given instead of CSV files: it is restored (data,
+ * time index and parse stats) in place of parsing.  Both SoA paths record a
+ * COLD_START row: load + index time until the first query can run.
  * Example (all 4 years):
  *   taxi_bench_full data/2020.csv data/2021.csv data/2022.csv data/2023.csv --serial
  */
 
+#include "taxi/CompactSoA.hpp"
+#include "taxi/PartitionedDataset.hpp"
+#include "taxi/HotColdTrips.hpp"
+#include "taxi/AoSoAQueryEngine.hpp"
+#include "taxi/TripDataAoSoA.hpp"
+#include "taxi/CsvReader.hpp"
+#include "taxi/CsvScanner.hpp"
 #include "taxi/DatasetManager.hpp"
+#include "taxi/FieldDecoder.hpp"
+#include "taxi/IngestPipeline.hpp"
+#include "taxi/MappedFile.hpp"
 #include "taxi/ParallelLoader.hpp"
 #include "taxi/QueryEngine.hpp"
 #include "taxi/SoAQueryEngine.hpp"
+#include "taxi/Snapshot.hpp"
 #include "taxi/TripDataSoA.hpp"
 #include "taxi/QueryTypes.hpp"
 #include "taxi/BenchmarkRunner.hpp"
@@ -35,12 +88,22 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <unistd.h>
+
 #if defined(_OPENMP)
 #include <omp.h>
 #endif
@@ -82,6 +145,358 @@ static void set_omp_threads(int n) {
 #endif
 }
 
+// Parse "--columns pickup_timestamp,trip_distance,..." (TripRecord or TLC
+// header names).  pickup_timestamp is always added: the time range and the
+// SoA time index are derived from it.
+static bool parse_columns(const std::string& s, ColumnSet& out) {
+    out = ColumnSet{Column::PickupTimestamp};
+    std::istringstream ss(s);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        const auto col = column_from_name(token);
+        if (!col) {
+            std::cerr << "ERROR: unknown column in --columns: " << token << "\n";
+            return false;
+        }
+        out = out | ColumnSet{*col};
+    }
+    return true;
+}
+
+static bool parse_read_mode(const std::string& s, ReadMode& out) {
+    for (ReadMode m : {ReadMode::Mmap, ReadMode::Stream, ReadMode::Buffered,
+                       ReadMode::Pread, ReadMode::Direct}) {
+        if (s == read_mode_name(m)) { out = m; return true; }
+    }
+    std::cerr << "ERROR: unknown --io backend: " << s
+              << " (mmap, stream, buffered, pread, direct)\n";
+    return false;
+}
+
+static bool parse_clustering(const std::string& s, TimeClustering& out) {
+    if (s == "time")         { out = TimeClustering::Pickup;      return true; }
+    if (s == "day-location") { out = TimeClustering::DayLocation; return true; }
+    std::cerr << "ERROR: unknown --cluster order: " << s << " (time, day-location)\n";
+    return false;
+}
+
+// Drop the inputs' clean pages from the page cache so every timed load
+// starts cold and backends are compared on equal terms.
+static void evict_from_page_cache(const std::vector<std::string>& paths) {
+    for (const auto& p : paths) {
+        const int fd = ::open(p.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+// Bytes of the inputs resident in the page cache (mincore over a mapping).
+static std::size_t cached_input_bytes(const std::vector<std::string>& paths) {
+    const long page = ::sysconf(_SC_PAGESIZE);
+    std::size_t cached = 0;
+    for (const auto& p : paths) {
+        MappedFile m;
+        if (!m.open(p) || m.size() == 0) continue;
+        std::vector<unsigned char> vec((m.size() + page - 1) / page);
+        if (::mincore(const_cast<char*>(m.data()), m.size(), vec.data()) != 0) continue;
+        for (unsigned char v : vec) cached += (v & 1) ? page : 0;
+    }
+    return cached;
+}
+
+// Peak resident set size of this process so far, in MB.
+static double peak_rss_mb() {
+    rusage ru{};
+    ::getrusage(RUSAGE_SELF, &ru);
+    return static_cast<double>(ru.ru_maxrss) / 1024.0;   // Linux: KB
+}
+
+// Minor page faults of this process so far (all threads).
+static std::uint64_t minor_faults() {
+    rusage ru{};
+    ::getrusage(RUSAGE_SELF, &ru);
+    return static_cast<std::uint64_t>(ru.ru_minflt);
+}
+
+// User-mode dTLB load misses of the OpenMP threads: one perf_event_open
+// counter per thread of the pool, opened from that thread.  Unavailable
+// without a hardware PMU (most VMs) or under a strict perf_event_paranoid.
+class TlbMissCounter {
+public:
+    TlbMissCounter() {
+        std::vector<int> fds(static_cast<std::size_t>(omp_thread_count()), -1);
+        #pragma omp parallel num_threads(static_cast<int>(fds.size()))
+        {
+#if defined(_OPENMP)
+            fds[static_cast<std::size_t>(omp_get_thread_num())] = open_counter();
+#else
+            fds[0] = open_counter();
+#endif
+        }
+        fds_ = std::move(fds);
+        if (std::find(fds_.begin(), fds_.end(), -1) != fds_.end()) close_all();
+    }
+    ~TlbMissCounter() { close_all(); }
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    bool available() const { return !fds_.empty(); }
+
+    std::uint64_t read() const {
+        std::uint64_t total = 0;
+        for (int fd : fds_) {
+            std::uint64_t v = 0;
+            if (::read(fd, &v, sizeof v) == sizeof v) total += v;
+        }
+        return total;
+    }
+
+private:
+    static int open_counter() {
+        perf_event_attr attr{};
+        attr.size           = sizeof attr;
+        attr.type           = PERF_TYPE_HW_CACHE;
+        attr.config         = PERF_COUNT_HW_CACHE_DTLB
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    void close_all() {
+        for (int fd : fds_) if (fd >= 0) ::close(fd);
+        fds_.clear();
+    }
+
+    std::vector<int> fds_;
+};
+
+// Read backend of a --io load.  Recorded as an IO_<backend> row:
+// matches = MB of input left in the page cache, extra_val = peak RSS MB.
+static void report_io(ReadMode mode, const std::vector<std::string>& paths,
+                      const std::string& phase, std::size_t rows, const RunStats& timing,
+                      MetricsRecorder& recorder) {
+    const std::size_t cached = cached_input_bytes(paths);
+    const double rss = peak_rss_mb();
+    // Probe after measuring: opening a reader pulls in the first chunk.
+    const std::string backend = CsvReader(paths.front(), mode).io_backend();
+    std::size_t input_bytes = 0;
+    for (const auto& p : paths) {
+        MappedFile m;
+        if (m.open(p)) input_bytes += m.size();
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "  I/O backend    : " << backend << "\n"
+              << "  Input cached   : " << (cached >> 20) << " / " << (input_bytes >> 20)
+              << " MB after load\n"
+              << "  Peak RSS       : " << rss << " MB\n"
+              << std::setprecision(2);
+    recorder.record({phase, std::string("IO_") + read_mode_name(mode), rows, 1,
+                     timing, cached >> 20, rss});
+}
+
+// Columns each SoA query reads.
+static ColumnSet query_columns(const std::string& qid) {
+    if (qid == "Q2") return {Column::TripDistance};
+    if (qid == "Q3") return {Column::TotalAmount};
+    if (qid == "Q4") return {Column::PuLocationId};
+    if (qid == "Q5") return {Column::PickupTimestamp, Column::TripDistance, Column::PassengerCount};
+    if (qid == "Q6") return {Column::PickupTimestamp, Column::FareAmount};
+    return {Column::PickupTimestamp};
+}
+
+// Rows of a query result: records of an AoS engine, indices of the others.
+template <typename Record>
+static std::size_t result_rows(const BasicQueryResult<Record>& r) { return r.records.size(); }
+static std::size_t result_rows(const SoAQueryResult& r) { return r.indices.size(); }
+
+// Per-stage busy/idle of the last IngestPipeline run.  Recorded as
+// STAGE_<name> rows: avg_ms = busy, extra_val = idle ms, threads = stage width.
+static void report_stages(const IngestPipeline::Report& r, const std::string& phase,
+                          std::size_t rows, MetricsRecorder& recorder) {
+    const std::pair<const char*, const IngestPipeline::StageTimes*> stages[] = {
+        {"reader", &r.reader}, {"parser", &r.parser}, {"placer", &r.placer}};
+    std::cout << "  Pipeline       : " << r.batches << " batches, "
+              << std::setprecision(1) << r.wall_ms << " ms wall\n";
+    for (const auto& [name, st] : stages) {
+        std::cout << std::fixed << std::setprecision(1)
+                  << "    " << std::left << std::setw(7) << name << std::right
+                  << " x" << st->threads
+                  << "  busy " << std::setw(9) << st->busy_ms
+                  << " ms  idle " << std::setw(9) << st->idle_ms
+                  << " ms  util " << std::setprecision(0)
+                  << 100.0 * st->utilization() << "%\n";
+        RunStats t;
+        t.avg_ms = t.min_ms = t.max_ms = st->busy_ms;
+        t.stddev_ms = 0.0; t.runs = 1;
+        recorder.record({phase, std::string("STAGE_") + name, rows, st->threads,
+                         t, rows, st->idle_ms});
+    }
+    std::cout << std::setprecision(2);
+}
+
+// ---- ingest micro-benchmarks -----------------------------------------------
+
+// Map every input file and touch each page so the ingest micro-benchmarks
+// measure CPU work, not the disk.
+static std::vector<MappedFile> map_prefaulted(const std::vector<std::string>& paths,
+                                              std::size_t& total_bytes) {
+    std::vector<MappedFile> maps;
+    total_bytes = 0;
+    for (const auto& p : paths) {
+        maps.emplace_back(p);
+        total_bytes += maps.back().size();
+        volatile char sink = 0;
+        for (std::size_t i = 0; i < maps.back().size(); i += 4096)
+            sink = sink + maps.back().data()[i];
+    }
+    return maps;
+}
+
+// Structural scan throughput: index every input file in CsvReader-sized
+// blocks with each SIMD kernel the CPU supports.
+static void bench_scan(const std::vector<std::string>& paths, int num_runs,
+                       MetricsRecorder& recorder) {
+    std::size_t total_bytes = 0;
+    const std::vector<MappedFile> maps = map_prefaulted(paths, total_bytes);
+
+    const CsvScanner::Kernel kernels[] = {CsvScanner::Kernel::Scalar,
+                                          CsvScanner::Kernel::Sse42,
+                                          CsvScanner::Kernel::Avx2};
+    for (auto k : kernels) {
+        if (!CsvScanner::supported(k)) continue;
+        const std::string qid = std::string("SCAN_") + CsvScanner::name(k);
+        std::cout << "[" << qid << "] Scanning " << total_bytes << " bytes, "
+                  << num_runs << " iterations...\n";
+
+        CsvScanner scanner(k);
+        std::size_t separators = 0;
+        RunStats timing = BenchmarkRunner::time_n([&]() {
+            separators = 0;
+            for (const auto& m : maps) {
+                scanner.reset();
+                const std::string_view bytes = m.view();
+                for (std::size_t off = 0; off < bytes.size();
+                     off += CsvReader::kScanBlockBytes) {
+                    separators += scanner.scan(
+                        bytes.substr(off, CsvReader::kScanBlockBytes)).size();
+                }
+            }
+        }, num_runs);
+
+        const double gbps = timing.avg_ms > 0.0
+            ? (static_cast<double>(total_bytes) / 1e9) / (timing.avg_ms / 1000.0)
+            : 0.0;
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  avg " << timing.avg_ms
+                  << " ms  ±" << timing.stddev_ms
+                  << "  separators " << separators
+                  << "  " << std::setprecision(2) << gbps << " GB/s\n\n";
+
+        // dataset_size = bytes scanned, extra_val = GB/s
+        recorder.record({"Ingest", qid, total_bytes, 1, timing, separators, gbps});
+    }
+}
+
+// Walk every field of every mapped file (scanner-indexed, quotes and \r
+// stripped) and hand the numeric TLC columns to @p decode(column, field).
+template <typename Decode>
+static void for_each_numeric_field(const std::vector<MappedFile>& maps,
+                                   CsvScanner& scanner, Decode&& decode) {
+    // 0 VendorID, 3 passenger_count, 4 trip_distance, 5 RatecodeID,
+    // 7-8 PU/DO LocationID, 9 payment_type, 10-16 money columns
+    constexpr std::uint32_t kNumericCols = 0x1FFB9u;
+    for (const auto& m : maps) {
+        scanner.reset();
+        const std::string_view bytes = m.view();
+        for (std::size_t off = 0; off < bytes.size();
+             off += CsvReader::kScanBlockBytes) {
+            const std::string_view block = bytes.substr(off, CsvReader::kScanBlockBytes);
+            std::size_t start = 0, col = 0;
+            for (const std::uint32_t sep : scanner.scan(block)) {
+                if (col < 32 && ((kNumericCols >> col) & 1u)) {
+                    std::string_view f = block.substr(start, sep - start);
+                    if (!f.empty() && f.back() == '\r') f.remove_suffix(1);
+                    if (!f.empty() && f.front() == '"') f.remove_prefix(1);
+                    if (!f.empty() && f.back() == '"') f.remove_suffix(1);
+                    decode(col, f);
+                }
+                col = block[sep] == '\n' ? 0 : col + 1;
+                start = sep + 1;
+            }
+        }
+    }
+}
+
+// Numeric field decoding: the old std::stoi / std::stod path (a std::string
+// per field, exceptions on bad input) against FieldDecoder.  Both walk the
+// same scanner output, so the difference is the per-field conversion cost.
+// extra_val of the DECODE_from_chars row is the saved load time in ms.
+static void bench_decode(const std::vector<std::string>& paths, int num_runs,
+                         MetricsRecorder& recorder) {
+    std::size_t total_bytes = 0;
+    const std::vector<MappedFile> maps = map_prefaulted(paths, total_bytes);
+    CsvScanner scanner;
+
+    auto is_double_col = [](std::size_t col) { return col == 4 || col >= 10; };
+
+    std::size_t fields = 0;
+    double checksum = 0.0;
+    auto decode_stod = [&](std::size_t col, std::string_view f) {
+        ++fields;
+        const std::string s(f);
+        if (s.find_first_not_of(" \t") == std::string::npos) return;
+        try {
+            checksum += is_double_col(col) ? std::stod(s) : std::stoi(s);
+        } catch (const std::exception&) {
+        }
+    };
+    auto decode_fast = [&](std::size_t col, std::string_view f) {
+        ++fields;
+        if (col == 4) {
+            double v;
+            if (decode_double(f, v)) checksum += v;
+        } else if (col >= 10) {
+            double v;
+            if (decode_money(f, v)) checksum += v;
+        } else {
+            int v;
+            if (decode_int(f, v)) checksum += v;
+        }
+    };
+
+    RunStats base_timing, fast_timing;
+    std::cout << "[DECODE_stod] Decoding numeric fields, " << num_runs << " iterations...\n";
+    base_timing = BenchmarkRunner::time_n([&]() {
+        fields = 0;
+        for_each_numeric_field(maps, scanner, decode_stod);
+    }, num_runs);
+    const std::size_t base_fields = fields;
+    std::cout << std::fixed << std::setprecision(3)
+              << "  avg " << base_timing.avg_ms << " ms  ±" << base_timing.stddev_ms
+              << "  fields " << base_fields << "\n\n";
+
+    std::cout << "[DECODE_from_chars] Decoding numeric fields, " << num_runs << " iterations...\n";
+    fast_timing = BenchmarkRunner::time_n([&]() {
+        fields = 0;
+        for_each_numeric_field(maps, scanner, decode_fast);
+    }, num_runs);
+    std::cout << std::fixed << std::setprecision(3)
+              << "  avg " << fast_timing.avg_ms << " ms  ±" << fast_timing.stddev_ms
+              << "  fields " << fields << "\n";
+
+    const double delta_ms = base_timing.avg_ms - fast_timing.avg_ms;
+    std::cout << "  load time delta: " << delta_ms << " ms saved ("
+              << std::setprecision(2)
+              << (fast_timing.avg_ms > 0.0 ? base_timing.avg_ms / fast_timing.avg_ms : 0.0)
+              << "x)  [checksum " << checksum << "]\n\n";
+
+    // dataset_size = bytes, matches = fields decoded, extra_val = ms saved
+    recorder.record({"Ingest", "DECODE_stod", total_bytes, 1, base_timing, base_fields, 0.0});
+    recorder.record({"Ingest", "DECODE_from_chars", total_bytes, 1, fast_timing, fields, delta_ms});
+}
+
 static void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " <csv_file> [<csv_file2> ...] [options]\n\n"
               << "Options:\n"
@@ -91,8 +506,24 @@ static void print_usage(const char* prog) {
               << "  --serial          Phase 1: 1 thread for load + queries\n"
               << "  --threads N       Phase 2: N threads for load + OMP queries\n"
               << "  --soa             Phase 3: run queries on Object-of-Arrays layout\n"
+              << "  --soa-direct      Phase 3b: load SoA straight from CSV (parallel with --threads)\n"
+              << "  --columns <list>  With --soa-direct: load only these columns\n"
+              << "  --pipeline        Load via reader/parser/placer pipeline (per-stage busy/idle)\n"
+              << "  --io <backend>    Serial load I/O: mmap, stream, buffered, pread, direct\n"
+              << "  --save-snapshot <file>  With --soa-direct: save data + index as a snapshot\n"
+              << "  --map-snapshot    Map a snapshot input lazily instead of reading it\n"
+              << "  --compact         With --soa-direct: packed/u16 codes, int32-cents money, FOR timestamps\n"
+              << "  --partition       With --soa-direct: rerun the queries on monthly partitions\n"
+              << "  --cluster <order> With --soa-direct: reorder rows by time or day-location, no index\n"
+              << "  --hot-cold        AoS phases: rerun the queries on a hot/cold split AoS\n"
+              << "  --aosoa           AoS phases: rerun the queries on SoA and tiled AoSoA copies\n"
+              << "  --small-pages     4 KB pages for SoA columns (default: 2 MB huge pages)\n"
+              << "  --mem-counters    With --soa-direct: page faults + dTLB misses per load/query\n"
+              << "  --ingest-bench    Ingest micro-benchmarks only (scan GB/s, decode ms)\n"
               << "\nMultiple CSV files are concatenated before querying:\n"
-              << "  " << prog << " data/2020.csv data/2021.csv data/2022.csv data/2023.csv --serial\n";
+              << "  " << prog << " data/2020.csv data/2021.csv data/2022.csv data/2023.csv --serial\n"
+              << "\nA snapshot saved with --save-snapshot may replace the CSV files:\n"
+              << "  " << prog << " data/all.snap\n";
 }
 
 // ---- main -------------------------------------------------------------------
@@ -108,6 +539,21 @@ int main(int argc, char* argv[]) {
     bool        serial_mode     = false;
     bool        soa_mode        = false;
     bool        soa_direct_mode = false;
+    bool        ingest_bench    = false;
+    bool        pipeline_mode   = false;
+    ColumnSet   load_columns    = ColumnSet::all();
+    ReadMode    io_mode         = ReadMode::Mmap;
+    bool        io_set          = false;   // --io given: evict + report per run
+    std::string snapshot_path;             // positional snapshot instead of CSVs
+    std::string save_snapshot_path;
+    bool        map_snapshot    = false;   // map the snapshot's columns lazily
+    bool        compact_mode    = false;   // compact columns (CompactSoA)
+    bool        partition_mode  = false;   // also query monthly partitions
+    TimeClustering cluster_order = TimeClustering::None;   // --cluster: row order
+    bool        hot_cold_mode   = false;   // also query the hot/cold split AoS
+    bool        aosoa_mode      = false;   // also query SoA and AoSoA copies
+    bool        small_pages     = false;   // 4 KB pages for the SoA columns
+    bool        mem_counters    = false;   // page faults / dTLB misses per query
     int         num_threads  = -1;   // -1 = not set by user
 
     for (int i = 1; i < argc; ++i) {
@@ -125,9 +571,42 @@ int main(int argc, char* argv[]) {
             soa_mode = true;
         } else if (arg == "--soa-direct") {
             soa_direct_mode = true;
+        } else if (arg == "--columns" && i + 1 < argc) {
+            if (!parse_columns(argv[++i], load_columns)) return 1;
+        } else if (arg == "--pipeline") {
+            pipeline_mode = true;
+        } else if (arg == "--io" && i + 1 < argc) {
+            if (!parse_read_mode(argv[++i], io_mode)) return 1;
+            io_set = true;
+        } else if (arg == "--save-snapshot" && i + 1 < argc) {
+            save_snapshot_path = argv[++i];
+        } else if (arg == "--map-snapshot") {
+            map_snapshot = true;
+        } else if (arg == "--compact") {
+            compact_mode = true;
+        } else if (arg == "--partition") {
+            partition_mode = true;
+        } else if (arg == "--cluster" && i + 1 < argc) {
+            if (!parse_clustering(argv[++i], cluster_order)) return 1;
+        } else if (arg == "--hot-cold") {
+            hot_cold_mode = true;
+        } else if (arg == "--aosoa") {
+            aosoa_mode = true;
+        } else if (arg == "--small-pages") {
+            small_pages = true;
+        } else if (arg == "--mem-counters") {
+            mem_counters = true;
+        } else if (arg == "--ingest-bench") {
+            ingest_bench = true;
         } else if (arg == "--threads" && i + 1 < argc) {
             num_threads = std::atoi(argv[++i]);
             if (num_threads < 1) num_threads = 1;
+        } else if (arg[0] != '-' && Snapshot::is_snapshot(arg)) {
+            if (!snapshot_path.empty()) {
+                std::cerr << "ERROR: only one snapshot can be loaded\n";
+                return 1;
+            }
+            snapshot_path = arg;
         } else if (arg[0] != '-') {
             csv_paths.push_back(arg);   // positional: one or more CSV files
         } else {
@@ -137,6 +616,21 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!snapshot_path.empty()) {
+        if (!csv_paths.empty() || ingest_bench) {
+            std::cerr << "ERROR: a snapshot replaces the CSV inputs; give one or the other\n";
+            return 1;
+        }
+        // A snapshot always restores a SoA table; parsing options do not apply.
+        if (pipeline_mode || io_set || !load_columns.is_all() || soa_mode)
+            std::cerr << "WARNING: --pipeline, --io, --columns and --soa do not apply to a snapshot\n";
+        soa_direct_mode = true;
+        soa_mode        = false;
+        pipeline_mode   = false;
+        io_set          = false;
+        load_columns    = ColumnSet::all();
+        csv_paths       = {snapshot_path};
+    }
     if (csv_paths.empty()) { print_usage(argv[0]); return 1; }
     for (const auto& p : csv_paths) {
         if (!file_exists(p)) {
@@ -148,6 +642,48 @@ int main(int argc, char* argv[]) {
         std::cerr << "ERROR: --runs must be > 0\n";
         return 1;
     }
+    if (map_snapshot && snapshot_path.empty()) {
+        std::cerr << "WARNING: --map-snapshot needs a snapshot input; ignoring it\n";
+        map_snapshot = false;
+    }
+    if (!save_snapshot_path.empty() && !soa_direct_mode) {
+        std::cerr << "WARNING: --save-snapshot only applies with --soa-direct; ignoring it\n";
+        save_snapshot_path.clear();
+    }
+    if (compact_mode && !soa_direct_mode) {
+        std::cerr << "WARNING: --compact only applies with --soa-direct; ignoring it\n";
+        compact_mode = false;
+    }
+    if (cluster_order != TimeClustering::None && !soa_direct_mode) {
+        std::cerr << "WARNING: --cluster only applies with --soa-direct; ignoring it\n";
+        cluster_order = TimeClustering::None;
+    }
+    if (partition_mode && (!soa_direct_mode || compact_mode)) {
+        std::cerr << "WARNING: --partition only applies with --soa-direct and without --compact; ignoring it\n";
+        partition_mode = false;
+    }
+    if (hot_cold_mode && (soa_mode || soa_direct_mode)) {
+        std::cerr << "WARNING: --hot-cold only applies to the AoS phases; ignoring it\n";
+        hot_cold_mode = false;
+    }
+    if (aosoa_mode && (soa_mode || soa_direct_mode)) {
+        std::cerr << "WARNING: --aosoa only applies to the AoS phases; ignoring it\n";
+        aosoa_mode = false;
+    }
+    if (mem_counters && !soa_direct_mode) {
+        std::cerr << "WARNING: --mem-counters only applies with --soa-direct; ignoring it\n";
+        mem_counters = false;
+    }
+    if (small_pages) set_page_policy(PagePolicy::Small);
+    if (compact_mode && !save_snapshot_path.empty()) {
+        // Snapshots store the int columns at full width.
+        std::cerr << "WARNING: --save-snapshot does not apply with --compact; ignoring it\n";
+        save_snapshot_path.clear();
+    }
+    if (!load_columns.is_all() && !soa_direct_mode) {
+        std::cerr << "WARNING: --columns only applies with --soa-direct; loading all columns\n";
+        load_columns = ColumnSet::all();
+    }
 
     // Determine parallelism level
     // --serial / --threads 1 → Phase 1 serial
@@ -161,13 +697,26 @@ int main(int argc, char* argv[]) {
         set_omp_threads(1);
     }
 
+    if (io_set && (pipeline_mode || use_parallel_load || ingest_bench)) {
+        std::cerr << "WARNING: --io only applies to serial loads; ignoring it\n";
+        io_set  = false;
+        io_mode = ReadMode::Mmap;
+    }
+
     const int   omp_threads = omp_thread_count();
     const int   load_threads = use_parallel_load ? num_threads : 1;
+    // Pipeline parser width: --threads N, else every hardware thread.
+    IngestPipeline::Options pipe_opts;
+    pipe_opts.parser_threads = num_threads > 0
+        ? num_threads
+        : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
     const std::string base_phase = (load_threads == 1 && omp_threads == 1)
                                        ? "Phase1_serial"
                                        : "Phase2_parallel";
-    const std::string phase = soa_direct_mode ? "Phase3_soa_direct"
-                            : soa_mode        ? "Phase3_soa"
+    const std::string phase = ingest_bench           ? "Ingest"
+                            : !snapshot_path.empty() ? "Phase3_snapshot"
+                            : soa_direct_mode        ? "Phase3_soa_direct"
+                            : soa_mode               ? "Phase3_soa"
                             : base_phase;
 
     // ---- Resolve which queries to run ----
@@ -193,7 +742,9 @@ int main(int argc, char* argv[]) {
     std::cout << "================================================================\n"
               << "CMPE 275 Mini1 — Full Benchmark CLI  (" << phase << ")\n"
               << "================================================================\n";
-    if (csv_paths.size() == 1) {
+    if (!snapshot_path.empty()) {
+        std::cout << "Snapshot      : " << snapshot_path << "\n";
+    } else if (csv_paths.size() == 1) {
         std::cout << "CSV file      : " << csv_paths[0] << "\n";
     } else {
         std::cout << "CSV files     : " << csv_paths[0] << "\n";
@@ -202,11 +753,28 @@ int main(int argc, char* argv[]) {
     }
     std::cout << "Runs/query    : " << num_runs     << "\n"
               << "Queries       : " << query_spec   << "\n"
-              << "Load threads  : " << load_threads << "\n"
+              << "Load threads  : " << (pipeline_mode
+                                        ? "pipeline, " + std::to_string(pipe_opts.parser_threads) + " parser(s)"
+                                        : std::to_string(load_threads)) << "\n"
               << "Query threads : " << omp_threads  << "\n"
-              << "Layout        : " << (soa_direct_mode ? "SoA direct from CSV"
+              << "Layout        : " << (ingest_bench    ? "n/a (ingest micro-benchmarks)"
+                                    : map_snapshot    ? "SoA mapped from snapshot (lazy)"
+                                    : !snapshot_path.empty() ? "SoA restored from snapshot"
+                                    : soa_direct_mode ? "SoA direct from CSV"
                                     : soa_mode        ? "Object-of-Arrays (SoA from AoS)"
-                                    :                   "Array-of-Structs (AoS)") << "\n";
+                                    :                   "Array-of-Structs (AoS)")
+              << (compact_mode ? ", compact columns" : "") << "\n";
+    if (!load_columns.is_all()) {
+        std::cout << "Columns       :";
+        for (std::size_t c = 0; c < kColumnCount; ++c)
+            if (load_columns.has(static_cast<Column>(c)))
+                std::cout << " " << column_name(static_cast<Column>(c));
+        std::cout << "\n";
+    }
+    if (io_set)
+        std::cout << "Read backend  : " << read_mode_name(io_mode) << " (cold cache)\n";
+    if (!save_snapshot_path.empty())
+        std::cout << "Save snapshot : " << save_snapshot_path << "\n";
     if (!output_path.empty())
         std::cout << "Output        : " << output_path << "\n";
     std::cout << "================================================================\n\n";
@@ -218,17 +786,91 @@ int main(int argc, char* argv[]) {
         // across runs without re-timing manually.
         const auto phase_wall_start = std::chrono::steady_clock::now();
 
+        // ================================================================
+        // Ingest micro-benchmarks (no dataset load, no queries)
+        // ================================================================
+        if (ingest_bench) {
+            std::cout << "[Ingest] Best scan kernel on this CPU: "
+                      << CsvScanner::name(CsvScanner::detect()) << "\n\n";
+            bench_scan(csv_paths, num_runs, recorder);
+            bench_decode(csv_paths, num_runs, recorder);
+
+            std::cout << "\n=== Summary ===\n";
+            recorder.print_summary();
+            if (!output_path.empty()) {
+                recorder.write_csv(output_path);
+                std::cout << "\nMetrics written to: " << output_path << "\n";
+            }
+            std::cout << "\nDone.\n";
+            return 0;
+        }
+
         // ================================================================
         // Phase 3b: Direct CSV → SoA (no intermediate AoS)
         // ================================================================
         if (soa_direct_mode) {
-            std::cout << "[Load] Direct CSV → SoA load (serial, "
-                      << csv_paths.size() << " file(s))...\n";
+            const bool from_snapshot = !snapshot_path.empty();
+            if (from_snapshot) {
+                std::cout << (map_snapshot ? "[Load] Mapping SoA snapshot...\n"
+                                           : "[Load] Restoring SoA snapshot...\n");
+            } else {
+                std::cout << "[Load] Direct CSV → SoA load ("
+                          << (pipeline_mode ? "pipeline, " + std::to_string(pipe_opts.parser_threads) + " parsers"
+                              : use_parallel_load ? std::to_string(load_threads) + " threads"
+                                                  : std::string("serial"))
+                          << ", " << csv_paths.size() << " file(s))...\n";
+            }
 
             TripDataSoA soa;
+            IngestPipeline::Report pipe_report;
+            CsvReader::Stats load_stats;
+            RowIndex saved_index;                   // time index from the snapshot
+            std::vector<Snapshot::SourceFile> sources;   // fingerprints in the snapshot
+            bool stale = false;
+            std::uint64_t snapshot_bytes = 0;
+            const std::uint64_t load_faults_start = minor_faults();
             RunStats direct_timing = BenchmarkRunner::time_n([&]() {
-                soa = TripDataSoA::from_csv(csv_paths, 95000000);
+                if (from_snapshot) {
+                    soa = TripDataSoA();
+                    // Start from an empty page cache: the read load and
+                    // COLD_START are timed cold, and with --map-snapshot the
+                    // MB paged in by each query shows what it touched.
+                    evict_from_page_cache(csv_paths);
+                    auto snap = map_snapshot ? Snapshot::map(snapshot_path)
+                                             : Snapshot::load(snapshot_path);
+                    soa         = std::move(snap.data);
+                    saved_index = std::move(snap.time_index);
+                    load_stats  = snap.stats;
+                    stale       = Snapshot::is_stale(snap);
+                    sources     = std::move(snap.sources);
+                    snapshot_bytes = snap.bytes;
+                } else if (pipeline_mode) {
+                    soa = TripDataSoA(load_columns);
+                    pipe_report = IngestPipeline(pipe_opts).load(csv_paths, soa);
+                    load_stats  = pipe_report.stats;
+                } else if (use_parallel_load) {
+                    // Morsel-parallel parse into column buffers, placed by
+                    // prefix sum; columns are sized from a line count.
+                    soa = TripDataSoA();
+                    auto par = ParallelLoader::load_soa(csv_paths, load_threads,
+                                                        ParallelLoader::kDefaultMorselBytes,
+                                                        load_columns);
+                    soa = std::move(par.data);
+                    load_stats.rows_read              = par.total_rows_read;
+                    load_stats.rows_parsed_ok         = par.total_rows_parsed;
+                    load_stats.rows_discarded         = par.total_rows_discarded;
+                    load_stats.timestamp_cache_hits   = par.timestamp_cache_hits;
+                    load_stats.timestamp_cache_misses = par.timestamp_cache_misses;
+                } else {
+                    soa = TripDataSoA();
+                    if (io_set) evict_from_page_cache(csv_paths);
+                    soa = TripDataSoA::from_csv(csv_paths, 95000000, load_columns, io_mode,
+                                                &load_stats);
+                }
             }, num_runs);
+            const std::uint64_t load_faults = (minor_faults() - load_faults_start) / num_runs;
+            // A snapshot may hold a projection: skip the queries it cannot serve.
+            if (from_snapshot) load_columns = soa.columns();
 
             if (soa.size() == 0) {
                 std::cerr << "ERROR: no records loaded (soa-direct).\n";
@@ -240,92 +882,291 @@ int main(int argc, char* argv[]) {
                       << "  avg " << direct_timing.avg_ms
                       << " ms  ±" << direct_timing.stddev_ms
                       << "  min " << direct_timing.min_ms
-                      << "  max " << direct_timing.max_ms << " ms\n\n";
+                      << "  max " << direct_timing.max_ms << " ms\n";
+            if (from_snapshot) {
+                std::cout << "  Snapshot size  : " << (snapshot_bytes >> 20) << " MB, "
+                          << load_stats.rows_read << " CSV rows read at save time\n";
+                if (stale)
+                    std::cerr << "WARNING: a source CSV changed since the snapshot was taken\n";
+            }
+            if (pipeline_mode) report_stages(pipe_report, phase, soa.size(), recorder);
+            if (io_set) report_io(io_mode, csv_paths, phase, soa.size(), direct_timing, recorder);
+            std::cout << "\n";
 
-            recorder.record({phase, "LOAD", soa.size(), 1,
+            recorder.record({phase, "LOAD", soa.size(), load_threads,
                              direct_timing, soa.size(), 0.0});
 
-            // Compute time range directly from SoA pickup_timestamp array
-            std::int64_t min_ts = soa.pickup_timestamp[0];
-            std::int64_t max_ts = soa.pickup_timestamp[0];
-            for (auto t : soa.pickup_timestamp) {
-                if (t < min_ts) min_ts = t;
-                if (t > max_ts) max_ts = t;
-            }
-            const std::int64_t mid_ts = min_ts + (max_ts - min_ts) / 2;
             const std::size_t  dataset_size = soa.size();
 
-            std::cout << "[Index] Building SoA time index...\n";
-            SoAQueryEngine soa_engine(soa);
-            double idx_ms = soa_engine.build_indexes();
-            std::cout << std::fixed << std::setprecision(2)
-                      << "  Index build time: " << idx_ms << " ms\n\n";
-
-            for (const auto& qid : active_queries) {
-                std::cout << "[" << qid << "] Running " << num_runs
-                          << " iterations (SoA direct)...\n";
+            // --cluster: permute the columns into time order once, so time
+            // ranges are row slices; before --compact, which keeps the order.
+            if (cluster_order != TimeClustering::None) {
+                RunStats cluster_timing = BenchmarkRunner::time_n([&]() {
+                    soa.cluster_by_time(cluster_order);
+                }, 1);
+                const char* order = cluster_order == TimeClustering::Pickup ? "pickup time"
+                                                                            : "pickup day, PU location";
+                std::cout << std::fixed << std::setprecision(2)
+                          << "[Cluster] Rows ordered by " << order << " in "
+                          << cluster_timing.avg_ms << " ms\n\n";
+                // extra = 1 for time order, 2 for day + location
+                recorder.record({phase, "CLUSTER", dataset_size, omp_threads, cluster_timing,
+                                 dataset_size, static_cast<double>(cluster_order)});
+            }
 
-                RunStats    timing;
-                std::size_t matches = 0;
-                double      extra   = 0.0;
+            // --compact: re-encode the int code columns at their natural
+            // width, money as cents and timestamps frame-of-reference; the
+            // other columns move into compact.wide untouched.
+            CompactTripDataSoA compact;
+            if (compact_mode) {
+                std::size_t wide_bytes = 0;
+                for (const auto& c : soa.column_bytes()) wide_bytes += c.elem_bytes * soa.size();
+                RunStats compact_timing = BenchmarkRunner::time_n([&]() {
+                    compact = CompactTripDataSoA::from_soa(std::move(soa));
+                }, 1);
+                std::cout << std::fixed << std::setprecision(2)
+                          << "[Compact] " << (wide_bytes >> 20) << " MB -> "
+                          << (compact.bytes() >> 20) << " MB in "
+                          << compact_timing.avg_ms << " ms (";
+                const char* sep = "";
+                auto show = [&](Column c, const std::string& how) {
+                    if (!compact.columns().has(c)) return;
+                    std::cout << sep << column_name(c) << " " << how;
+                    sep = ", ";
+                };
+                for (auto [c, col] : {std::pair{Column::VendorId,        &compact.vendor_id},
+                                      std::pair{Column::PassengerCount,  &compact.passenger_count},
+                                      std::pair{Column::RateCodeId,      &compact.rate_code_id},
+                                      std::pair{Column::PaymentType,     &compact.payment_type},
+                                      std::pair{Column::StoreAndFwdFlag, &compact.store_and_fwd_flag}})
+                    show(c, std::to_string(col->bits()) + "b");
+                show(Column::PuLocationId, int_width_name(compact.pu_location_id.width()));
+                show(Column::DoLocationId, int_width_name(compact.do_location_id.width()));
+                show(Column::PickupTimestamp, compact.pickup_timestamp.is_encoded() ? "for32" : "i64");
+                show(Column::DropoffTimestamp,
+                     std::string("delta ") + compact.dropoff_timestamp.width_name());
+                show(Column::FareAmount,  compact.fare_amount.is_cents()  ? "cents" : "f64");
+                show(Column::TotalAmount, compact.total_amount.is_cents() ? "cents" : "f64");
+                std::cout << ")\n\n";
+                // matches = MB after compaction
+                recorder.record({phase, "COMPACT", dataset_size, 1, compact_timing,
+                                 compact.bytes() >> 20, static_cast<double>(wide_bytes >> 20)});
+            }
+            const TripDataSoA& table = compact_mode ? compact.wide : soa;
+
+            SoAQueryEngine soa_engine = compact_mode ? SoAQueryEngine(compact)
+                                                     : SoAQueryEngine(soa);
+            double idx_ms = 0.0;
+            const std::uint64_t index_faults_start = minor_faults();
+            if (!saved_index.empty()) {
+                std::cout << "[Index] Restoring SoA time index from snapshot...\n";
+                const auto t0 = std::chrono::steady_clock::now();
+                soa_engine.restore_indexes(std::move(saved_index));
+                idx_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - t0).count();
+            } else {
+                std::cout << "[Index] Building SoA time index...\n";
+                idx_ms = soa_engine.build_indexes();
+            }
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  Index build time: " << idx_ms << " ms"
+                      << " (zone maps: " << soa_engine.zone_map().bytes() / 1024.0 << " KB)\n";
+
+            // --mem-counters: page faults per load and for the index build,
+            // and how much of the heap ended up on huge pages.
+            std::optional<TlbMissCounter> tlb;
+            if (mem_counters) {
+                const std::uint64_t index_faults = minor_faults() - index_faults_start;
+                const HugePageStats hp = huge_page_stats();
+                const double huge_mb = static_cast<double>(anon_huge_page_bytes() >> 20);
+                std::cout << "  Pages          : " << (small_pages ? "4 KB" : "2 MB huge")
+                          << ", " << load_faults << " faults per load, "
+                          << index_faults << " for the index; " << huge_mb
+                          << " MB on THP (" << (hp.explicit_bytes >> 20)
+                          << " MB explicit)\n";
+                // MEM_LOAD: matches = faults per load, extra = MB on THP;
+                // MEM_INDEX: matches = faults of the index build.
+                recorder.record({phase, "MEM_LOAD", dataset_size, load_threads,
+                                 direct_timing, load_faults, huge_mb});
+                RunStats it;
+                it.avg_ms = it.min_ms = it.max_ms = idx_ms;
+                it.stddev_ms = 0.0; it.runs = 1;
+                recorder.record({phase, "MEM_INDEX", dataset_size, omp_threads,
+                                 it, index_faults, 0.0});
+                tlb.emplace();
+                if (!tlb->available())
+                    std::cout << "  dTLB counters  : unavailable (no PMU access)\n";
+            }
 
-                if (qid == "Q1") {
-                    TimeRangeQuery q{min_ts, mid_ts};
-                    SoAQueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.search_by_time(q);
-                    }, num_runs);
-                    matches = last.indices.size();
-                } else if (qid == "Q2") {
-                    NumericRangeQuery q{1.0, 5.0};
-                    SoAQueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.search_by_distance(q);
-                    }, num_runs);
-                    matches = last.indices.size();
-                } else if (qid == "Q3") {
-                    NumericRangeQuery q{10.0, 50.0};
-                    SoAQueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.search_by_fare(q);
-                    }, num_runs);
-                    matches = last.indices.size();
-                } else if (qid == "Q4") {
-                    IntRangeQuery q{100, 200};
-                    SoAQueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.search_by_location(q);
-                    }, num_runs);
-                    matches = last.indices.size();
-                } else if (qid == "Q5") {
-                    CombinedQuery q{{min_ts, mid_ts}, {0.0, 100.0}, {1, 6}};
-                    SoAQueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.search_combined(q);
-                    }, num_runs);
-                    matches = last.indices.size();
-                } else if (qid == "Q6") {
-                    TimeRangeQuery q{min_ts, max_ts};
-                    AggregationResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = soa_engine.aggregate_fare_by_time(q);
-                    }, num_runs);
-                    matches = last.count;
-                    extra   = last.avg;
+            // Time range from the ends of the sorted index (two reads, so a
+            // mapped pickup_timestamp column is not paged in just for this).
+            // A clustered table has no index: its first and last rows, or
+            // for day-location order a pass over the pickup column.
+            const auto& by_time = soa_engine.time_index();
+            auto pickup_at = [&](std::size_t row) {
+                return compact_mode ? compact.pickup_timestamp[row] : table.pickup_timestamp[row];
+            };
+            std::int64_t min_ts = 0, max_ts = 0;
+            if (!by_time.empty()) {
+                min_ts = pickup_at(by_time.front());
+                max_ts = pickup_at(by_time.back());
+            } else if (soa_engine.time_clustering() == TimeClustering::Pickup) {
+                min_ts = pickup_at(0);
+                max_ts = pickup_at(dataset_size - 1);
+            } else {
+                min_ts = max_ts = pickup_at(0);
+                for (std::size_t row = 1; row < dataset_size; ++row) {
+                    min_ts = std::min(min_ts, pickup_at(row));
+                    max_ts = std::max(max_ts, pickup_at(row));
                 }
+            }
+            const std::int64_t mid_ts = min_ts + (max_ts - min_ts) / 2;
 
-                std::cout << std::fixed << std::setprecision(3)
-                          << "  avg " << timing.avg_ms
-                          << " ms  ±" << timing.stddev_ms
-                          << "  min " << timing.min_ms
-                          << "  max " << timing.max_ms
-                          << "  matches " << matches;
-                if (qid == "Q6")
-                    std::cout << "  avg_fare $" << std::setprecision(2) << extra;
-                std::cout << "\n\n";
-
-                recorder.record({phase, qid, dataset_size,
-                                 omp_threads, timing, matches, extra});
+            // Cold start: from nothing in memory to the first query.
+            {
+                RunStats cs;
+                cs.avg_ms = direct_timing.avg_ms + idx_ms;
+                cs.min_ms = direct_timing.min_ms + idx_ms;
+                cs.max_ms = direct_timing.max_ms + idx_ms;
+                cs.stddev_ms = direct_timing.stddev_ms; cs.runs = direct_timing.runs;
+                std::cout << "  Cold start     : " << cs.avg_ms << " ms (load + index)\n";
+                recorder.record({phase, "COLD_START", dataset_size, load_threads,
+                                 cs, dataset_size, idx_ms});
+            }
+            if (!save_snapshot_path.empty()) {
+                std::uint64_t bytes = 0;
+                RunStats save_timing = BenchmarkRunner::time_n([&]() {
+                    bytes = Snapshot::save(save_snapshot_path, soa, soa_engine.time_index(),
+                                           load_stats,
+                                           from_snapshot ? sources
+                                                         : Snapshot::fingerprint(csv_paths));
+                }, 1);
+                std::cout << "  Snapshot saved : " << save_snapshot_path << " ("
+                          << (bytes >> 20) << " MB, " << save_timing.avg_ms << " ms)\n";
+                // matches = snapshot MB
+                recorder.record({phase, "SNAPSHOT_SAVE", soa.size(), 1,
+                                 save_timing, bytes >> 20, 0.0});
+            }
+            std::cout << "\n";
+
+            // The query suite, over the monolithic engine and (--partition)
+            // the monthly partitions.
+            auto run_queries = [&](const auto& engine, const char* layout,
+                                   const std::string& id_suffix) {
+                for (const auto& qid : active_queries) {
+                    if ((query_columns(qid) | load_columns) != load_columns) {
+                        std::cout << "[" << qid << "] Skipped: needs columns not loaded (--columns)\n\n";
+                        continue;
+                    }
+                    std::cout << "[" << qid << "] Running " << num_runs
+                              << " iterations (" << layout << ")...\n";
+
+                    RunStats    timing;
+                    std::size_t matches = 0;
+                    double      extra   = 0.0;
+                    const std::uint64_t faults_start = minor_faults();
+                    const std::uint64_t tlb_start    = tlb ? tlb->read() : 0;
+
+                    if (qid == "Q1") {
+                        TimeRangeQuery q{min_ts, mid_ts};
+                        SoAQueryResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_time(q);
+                        }, num_runs);
+                        matches = last.indices.size();
+                    } else if (qid == "Q2") {
+                        NumericRangeQuery q{1.0, 5.0};
+                        SoAQueryResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_distance(q);
+                        }, num_runs);
+                        matches = last.indices.size();
+                    } else if (qid == "Q3") {
+                        NumericRangeQuery q{10.0, 50.0};
+                        SoAQueryResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_fare(q);
+                        }, num_runs);
+                        matches = last.indices.size();
+                    } else if (qid == "Q4") {
+                        IntRangeQuery q{100, 200};
+                        SoAQueryResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_location(q);
+                        }, num_runs);
+                        matches = last.indices.size();
+                    } else if (qid == "Q5") {
+                        CombinedQuery q{{min_ts, mid_ts}, {0.0, 100.0}, {1, 6}};
+                        SoAQueryResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_combined(q);
+                        }, num_runs);
+                        matches = last.indices.size();
+                    } else if (qid == "Q6") {
+                        TimeRangeQuery q{min_ts, max_ts};
+                        AggregationResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.aggregate_fare_by_time(q);
+                        }, num_runs);
+                        matches = last.count;
+                        extra   = last.avg;
+                    }
+
+                    std::cout << std::fixed << std::setprecision(3)
+                              << "  avg " << timing.avg_ms
+                              << " ms  ±" << timing.stddev_ms
+                              << "  min " << timing.min_ms
+                              << "  max " << timing.max_ms
+                              << "  matches " << matches;
+                    if (qid == "Q6")
+                        std::cout << "  avg_fare $" << std::setprecision(2) << extra;
+                    if (map_snapshot)
+                        std::cout << "  paged in " << (cached_input_bytes(csv_paths) >> 20) << " MB";
+                    std::cout << "\n";
+                    if (tlb) {
+                        // Per timed run; dTLB misses are 0 when unavailable.
+                        const std::uint64_t faults = (minor_faults() - faults_start) / num_runs;
+                        const std::uint64_t misses = tlb->available()
+                            ? (tlb->read() - tlb_start) / num_runs : 0;
+                        std::cout << "  faults/run " << faults;
+                        if (tlb->available()) std::cout << "  dTLB misses/run " << misses;
+                        std::cout << "\n";
+                        recorder.record({phase, "MEM_" + qid + id_suffix, dataset_size,
+                                         omp_threads, timing, misses,
+                                         static_cast<double>(faults)});
+                    }
+                    std::cout << "\n";
+
+                    recorder.record({phase, qid + id_suffix, dataset_size,
+                                     omp_threads, timing, matches, extra});
+                }
+            };
+            run_queries(soa_engine, "SoA direct", "");
+
+            // --partition: split the table by pickup month, index each
+            // month (in parallel) and rerun the queries on the partitions.
+            if (partition_mode) {
+                PartitionedDataset parts;
+                RunStats split_timing = BenchmarkRunner::time_n([&]() {
+                    parts = PartitionedDataset::from_soa(std::move(soa));
+                }, 1);
+                const double part_idx_ms = parts.build_indexes();
+                std::cout << std::fixed << std::setprecision(2)
+                          << "[Partition] " << parts.partitions() << " months, split in "
+                          << split_timing.avg_ms << " ms, indexes built in "
+                          << part_idx_ms << " ms\n\n";
+                // matches = partitions, extra = index build ms
+                recorder.record({phase, "PARTITION", dataset_size, omp_threads, split_timing,
+                                 parts.partitions(), part_idx_ms});
+                run_queries(parts, "partitioned", "_PART");
+            }
+            if (map_snapshot) {
+                // matches = MB of the snapshot paged in by the whole run
+                RunStats none;
+                none.avg_ms = none.min_ms = none.max_ms = 0.0;
+                none.stddev_ms = 0.0; none.runs = 1;
+                recorder.record({phase, "PAGED_IN", dataset_size, omp_threads, none,
+                                 cached_input_bytes(csv_paths) >> 20, 0.0});
             }
 
             const auto   phase_wall_end  = std::chrono::steady_clock::now();
@@ -352,37 +1193,63 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        std::vector<TripRecord> records;
+        TripRecords records;
 
         // ================================================================
         // LOAD PHASE
         // ================================================================
-        if (use_parallel_load) {
+        if (pipeline_mode) {
+            // ---- Pipelined load: reader -> parsers -> placer ----
+            std::cout << "[Load] Pipelined CSV load (" << pipe_opts.parser_threads
+                      << " parser threads, " << csv_paths.size() << " file(s))...\n";
+
+            DatasetManager mgr;
+            IngestPipeline::Report pipe_report;
+            RunStats pipe_timing = BenchmarkRunner::time_n([&]() {
+                mgr.clear();
+                pipe_report = mgr.load_from_csv_pipelined(csv_paths, pipe_opts);
+            }, num_runs);
+
+            if (mgr.size() == 0) {
+                std::cerr << "ERROR: no records loaded (pipeline).\n";
+                return 1;
+            }
+            records = mgr.take_records();
+
+            auto ls = mgr.get_load_stats();
+            const CsvReader::Stats ts_cache{.timestamp_cache_hits   = ls.timestamp_cache_hits,
+                                            .timestamp_cache_misses = ls.timestamp_cache_misses};
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  Records loaded : " << records.size() << "\n"
+                      << "  Rows read      : " << ls.total_rows_read << "\n"
+                      << "  TS date cache  : "
+                      << 100.0 * ts_cache.timestamp_cache_hit_rate() << "% hit\n"
+                      << "  avg " << pipe_timing.avg_ms
+                      << " ms  ±" << pipe_timing.stddev_ms
+                      << "  min " << pipe_timing.min_ms
+                      << "  max " << pipe_timing.max_ms << " ms\n";
+            report_stages(pipe_report, "Pipeline", records.size(), recorder);
+            std::cout << "\n";
+
+            recorder.record({"Pipeline", "LOAD", records.size(),
+                             pipe_opts.parser_threads, pipe_timing, records.size(), 0.0});
+
+        } else if (use_parallel_load) {
             // ---- Phase 2: parallel load ----
             std::cout << "[Load] Parallel CSV load (" << load_threads
                       << " threads, " << csv_paths.size() << " file(s))...\n";
 
             // Time loading all CSV files over num_runs iterations.
-            // Each run clears and reloads all files so timing is consistent.
-            // Pre-reserve to avoid reallocation OOM spikes (e.g. 140M × 128 B ≈ 17.9 GB).
-            // macOS treats this as virtual memory — physical pages are faulted in lazily,
-            // allowing NVMe-backed swap to absorb datasets larger than physical RAM.
+            // Each run reloads all files so timing is consistent.  All files
+            // go through one ParallelLoader call: threads write straight into
+            // a single output vector sized from a line count, so there is no
+            // per-file result to concatenate and no 95M-row pre-reserve.
             ParallelLoader::Result par_result;
-            par_result.records.reserve(95000000);
             RunStats par_timing = BenchmarkRunner::time_n([&]() {
-                par_result.records.clear();
-                par_result.total_rows_read = par_result.total_rows_parsed
-                                           = par_result.total_rows_discarded = 0;
-                for (const auto& p : csv_paths) {
-                    auto chunk = ParallelLoader::load(p, load_threads);
-                    par_result.total_rows_read      += chunk.total_rows_read;
-                    par_result.total_rows_parsed    += chunk.total_rows_parsed;
-                    par_result.total_rows_discarded += chunk.total_rows_discarded;
-                    par_result.records.insert(par_result.records.end(),
-                        std::make_move_iterator(chunk.records.begin()),
-                        std::make_move_iterator(chunk.records.end()));
-                }
+                par_result = ParallelLoader::Result();   // free the previous run first
+                par_result = ParallelLoader::load(csv_paths, load_threads);
             }, num_runs);
+            const std::size_t morsels = par_result.morsels;
 
             if (par_result.records.empty()) {
                 std::cerr << "ERROR: no records loaded (parallel).\n";
@@ -393,11 +1260,17 @@ int main(int argc, char* argv[]) {
             double success_rate = par_result.total_rows_read > 0
                 ? 100.0 * par_result.total_rows_parsed / par_result.total_rows_read
                 : 0.0;
+            const CsvReader::Stats ts_cache{.timestamp_cache_hits   = par_result.timestamp_cache_hits,
+                                            .timestamp_cache_misses = par_result.timestamp_cache_misses};
 
             std::cout << std::fixed << std::setprecision(2)
                       << "  Records loaded : " << records.size() << "\n"
                       << "  Rows read      : " << par_result.total_rows_read << "\n"
+                      << "  Morsels        : " << morsels << " x ~"
+                      << (ParallelLoader::kDefaultMorselBytes >> 20) << " MB\n"
                       << "  Parse success  : " << success_rate << "%\n"
+                      << "  TS date cache  : "
+                      << 100.0 * ts_cache.timestamp_cache_hit_rate() << "% hit\n"
                       << "  avg " << par_timing.avg_ms
                       << " ms  ±" << par_timing.stddev_ms
                       << "  min " << par_timing.min_ms
@@ -417,8 +1290,9 @@ int main(int argc, char* argv[]) {
             mgr.reserve_if_needed(95000000);
             RunStats ser_timing = BenchmarkRunner::time_n([&]() {
                 mgr.clear();
+                if (io_set) evict_from_page_cache(csv_paths);
                 for (const auto& p : csv_paths)
-                    mgr.load_from_csv(p);   // DatasetManager appends on each call
+                    mgr.load_from_csv(p, io_mode);   // DatasetManager appends on each call
             }, num_runs);
 
             if (mgr.size() == 0) {
@@ -431,15 +1305,22 @@ int main(int argc, char* argv[]) {
             double success_rate = ls.total_rows_read > 0
                 ? 100.0 * ls.total_rows_parsed / ls.total_rows_read
                 : 0.0;
+            const CsvReader::Stats ts_cache{.timestamp_cache_hits   = ls.timestamp_cache_hits,
+                                            .timestamp_cache_misses = ls.timestamp_cache_misses};
 
             std::cout << std::fixed << std::setprecision(2)
                       << "  Records loaded : " << records.size() << "\n"
                       << "  Rows read      : " << ls.total_rows_read << "\n"
                       << "  Parse success  : " << success_rate << "%\n"
+                      << "  TS date cache  : "
+                      << 100.0 * ts_cache.timestamp_cache_hit_rate() << "% hit\n"
                       << "  avg " << ser_timing.avg_ms
                       << " ms  ±" << ser_timing.stddev_ms
                       << "  min " << ser_timing.min_ms
-                      << "  max " << ser_timing.max_ms << " ms\n\n";
+                      << "  max " << ser_timing.max_ms << " ms\n";
+            if (io_set) report_io(io_mode, csv_paths, "Phase1_serial", records.size(),
+                                  ser_timing, recorder);
+            std::cout << "\n";
 
             recorder.record({"Phase1_serial", "LOAD",
                              records.size(), 1,
@@ -474,7 +1355,7 @@ int main(int argc, char* argv[]) {
             TripDataSoA soa = TripDataSoA::from_aos(records);
             // Free the AoS vector immediately — it has been fully converted to SoA.
             // Without this, AoS (~4.8 GB) and SoA (~4.2 GB) coexist, causing OOM.
-            { std::vector<TripRecord>().swap(records); }
+            { TripRecords().swap(records); }
             double conv_end_ms = []() {
                 return std::chrono::duration<double, std::milli>(
                     std::chrono::steady_clock::now().time_since_epoch()).count();
@@ -571,76 +1452,142 @@ int main(int argc, char* argv[]) {
             std::cout << std::fixed << std::setprecision(2)
                       << "  Index build time: " << idx_ms << " ms\n\n";
 
-            for (const auto& qid : active_queries) {
-                std::cout << "[" << qid << "] Running " << num_runs
-                          << " iterations...\n";
-
-                RunStats    timing;
-                std::size_t matches = 0;
-                double      extra   = 0.0;
-
-                if (qid == "Q1") {
-                    TimeRangeQuery q{min_ts, mid_ts};
-                    QueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.search_by_time(q);
-                    }, num_runs);
-                    matches = last.records.size();
-
-                } else if (qid == "Q2") {
-                    NumericRangeQuery q{1.0, 5.0};
-                    QueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.search_by_distance(q);
-                    }, num_runs);
-                    matches = last.records.size();
-
-                } else if (qid == "Q3") {
-                    NumericRangeQuery q{10.0, 50.0};
-                    QueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.search_by_fare(q);
-                    }, num_runs);
-                    matches = last.records.size();
-
-                } else if (qid == "Q4") {
-                    IntRangeQuery q{100, 200};
-                    QueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.search_by_location(q);
-                    }, num_runs);
-                    matches = last.records.size();
-
-                } else if (qid == "Q5") {
-                    CombinedQuery q{{min_ts, mid_ts}, {0.0, 100.0}, {1, 6}};
-                    QueryResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.search_combined(q);
-                    }, num_runs);
-                    matches = last.records.size();
-
-                } else if (qid == "Q6") {
-                    TimeRangeQuery q{min_ts, max_ts};
-                    AggregationResult last;
-                    timing = BenchmarkRunner::time_n([&]() {
-                        last = engine.aggregate_fare_by_time(q);
-                    }, num_runs);
-                    matches = last.count;
-                    extra   = last.avg;
+            // The query suite, over the AoS engine, (--hot-cold) the hot
+            // array of the hot/cold split and (--aosoa) the SoA and AoSoA
+            // copies.
+            auto run_queries = [&](const auto& engine, const char* layout,
+                                   const std::string& id_suffix) {
+                for (const auto& qid : active_queries) {
+                    std::cout << "[" << qid << "] Running " << num_runs
+                              << " iterations" << layout << "...\n";
+
+                    RunStats    timing;
+                    std::size_t matches = 0;
+                    double      extra   = 0.0;
+
+                    if (qid == "Q1") {
+                        TimeRangeQuery q{min_ts, mid_ts};
+                        decltype(engine.search_by_time(q)) last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_time(q);
+                        }, num_runs);
+                        matches = result_rows(last);
+
+                    } else if (qid == "Q2") {
+                        NumericRangeQuery q{1.0, 5.0};
+                        decltype(engine.search_by_distance(q)) last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_distance(q);
+                        }, num_runs);
+                        matches = result_rows(last);
+
+                    } else if (qid == "Q3") {
+                        NumericRangeQuery q{10.0, 50.0};
+                        decltype(engine.search_by_fare(q)) last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_fare(q);
+                        }, num_runs);
+                        matches = result_rows(last);
+
+                    } else if (qid == "Q4") {
+                        IntRangeQuery q{100, 200};
+                        decltype(engine.search_by_location(q)) last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_by_location(q);
+                        }, num_runs);
+                        matches = result_rows(last);
+
+                    } else if (qid == "Q5") {
+                        CombinedQuery q{{min_ts, mid_ts}, {0.0, 100.0}, {1, 6}};
+                        decltype(engine.search_combined(q)) last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.search_combined(q);
+                        }, num_runs);
+                        matches = result_rows(last);
+
+                    } else if (qid == "Q6") {
+                        TimeRangeQuery q{min_ts, max_ts};
+                        AggregationResult last;
+                        timing = BenchmarkRunner::time_n([&]() {
+                            last = engine.aggregate_fare_by_time(q);
+                        }, num_runs);
+                        matches = last.count;
+                        extra   = last.avg;
+                    }
+
+                    std::cout << std::fixed << std::setprecision(3)
+                              << "  avg " << timing.avg_ms
+                              << " ms  ±" << timing.stddev_ms
+                              << "  min " << timing.min_ms
+                              << "  max " << timing.max_ms
+                              << "  matches " << matches;
+                    if (qid == "Q6")
+                        std::cout << "  avg_fare $" << std::setprecision(2) << extra;
+                    std::cout << "\n\n";
+
+                    recorder.record({phase, qid + id_suffix, dataset_size,
+                                     omp_threads, timing, matches, extra});
                 }
+            };
+            run_queries(engine, "", "");
+
+            // --hot-cold: split the records into 40-byte hot structs and the
+            // rest, and rerun the queries scanning only the hot array.
+            if (hot_cold_mode) {
+                HotColdTrips trips;
+                RunStats split_timing = BenchmarkRunner::time_n([&]() {
+                    trips = HotColdTrips::from_aos(records);
+                }, 1);
+                HotColdQueryEngine hot_engine(trips.hot);
+                const double hot_idx_ms = hot_engine.build_indexes();
+                std::cout << std::fixed << std::setprecision(2)
+                          << "[HotCold] " << sizeof(TripRecord) << " B records -> "
+                          << sizeof(TripHot) << " B hot + " << sizeof(TripCold)
+                          << " B cold, split in " << split_timing.avg_ms
+                          << " ms, index built in " << hot_idx_ms << " ms\n\n";
+                // matches = hot bytes per trip, extra = index build ms
+                recorder.record({phase, "HOT_COLD", dataset_size, 1, split_timing,
+                                 sizeof(TripHot), hot_idx_ms});
+                run_queries(hot_engine, " (hot/cold)", "_HOT");
+            }
 
-                std::cout << std::fixed << std::setprecision(3)
-                          << "  avg " << timing.avg_ms
-                          << " ms  ±" << timing.stddev_ms
-                          << "  min " << timing.min_ms
-                          << "  max " << timing.max_ms
-                          << "  matches " << matches;
-                if (qid == "Q6")
-                    std::cout << "  avg_fare $" << std::setprecision(2) << extra;
-                std::cout << "\n\n";
+            // --aosoa: the same queries on SoA and then on tiled AoSoA
+            // copies.  Each copy is made from the previous one, which is
+            // freed, so at most two layouts are in memory at a time.
+            if (aosoa_mode) {
+                TripDataSoA soa;
+                RunStats soa_timing = BenchmarkRunner::time_n([&]() {
+                    soa = TripDataSoA::from_aos(records);
+                }, 1);
+                { TripRecords().swap(records); }
+                {
+                    SoAQueryEngine soa_engine(soa);
+                    const double soa_idx_ms = soa_engine.build_indexes();
+                    std::cout << std::fixed << std::setprecision(2)
+                              << "[SoA] converted in " << soa_timing.avg_ms
+                              << " ms, index built in " << soa_idx_ms << " ms\n\n";
+                    // extra = index build ms
+                    recorder.record({phase, "TO_SOA", dataset_size, 1, soa_timing,
+                                     dataset_size, soa_idx_ms});
+                    run_queries(soa_engine, " (SoA)", "_SOA");
+                }
 
-                recorder.record({phase, qid, records.size(),
-                                 omp_threads, timing, matches, extra});
+                TripDataAoSoA tiles;
+                RunStats tile_timing = BenchmarkRunner::time_n([&]() {
+                    tiles = TripDataAoSoA::from_soa(soa);
+                }, 1);
+                soa = TripDataSoA();   // free the columns
+                AoSoAQueryEngine tile_engine(tiles);
+                const double tile_idx_ms = tile_engine.build_indexes();
+                std::cout << std::fixed << std::setprecision(2)
+                          << "[AoSoA] " << tiles.tiles.size() << " tiles of "
+                          << TripDataAoSoA::kTileRows << " rows (" << sizeof(TripTile)
+                          << " B), converted in " << tile_timing.avg_ms
+                          << " ms, index built in " << tile_idx_ms << " ms\n\n";
+                // matches = tiles, extra = index build ms
+                recorder.record({phase, "TO_AOSOA", dataset_size, 1, tile_timing,
+                                 tiles.tiles.size(), tile_idx_ms});
+                run_queries(tile_engine, " (AoSoA)", "_AOSOA");
             }
         }
 
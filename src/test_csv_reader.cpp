@@ -64,7 +64,11 @@ int main(int argc, char* argv[]) {
         std::cout << "  Success rate: " << std::fixed << std::setprecision(1)
                   << (stats.rows_read > 0 ? 
                       (100.0 * stats.rows_parsed_ok / stats.rows_read) : 0.0) 
-                  << "%\n\n";
+                  << "%\n";
+        std::cout << "  Timestamp date cache: " << stats.timestamp_cache_hits
+                  << " hits / " << stats.timestamp_cache_misses << " misses ("
+                  << std::fixed << std::setprecision(1)
+                  << 100.0 * stats.timestamp_cache_hit_rate() << "% hit)\n\n";
         
         if (records_parsed > 0) {
             std::cout << "✓ Parsing test successful!\n";
@@ -2,8 +2,10 @@
  * unit_tests.cpp — Basic unit tests for CMPE-275 Mini 1.
  *
  * No external test framework — uses assert() and reports pass/fail counts.
- * Tests cover: TripRecord, CsvReader, TripDataSoA, BenchmarkRunner,
- *              QueryEngine, and SoAQueryEngine.
+ * Tests cover: TripRecord, CsvReader, CsvScanner, FieldDecoder,
+ *              TimestampDecoder, ParallelLoader, IngestPipeline, ColumnMap,
+ *              FileSource, Compression, TripDataSoA, BenchmarkRunner, QueryEngine,
+ *              SoAQueryEngine, and Snapshot.
  *
  * Build:  cmake --build build --target unit_tests
  * Run:    ./build/bin/unit_tests
@@ -11,21 +13,59 @@
 
 #include "taxi/TripRecord.hpp"
 #include "taxi/CsvReader.hpp"
+#include "taxi/CsvScanner.hpp"
+#include "taxi/ColumnMap.hpp"
+#include "taxi/FileSource.hpp"
+#include "taxi/Compression.hpp"
+#include "taxi/FieldDecoder.hpp"
+#include "taxi/TimestampDecoder.hpp"
+#include "taxi/ParallelLoader.hpp"
+#include "taxi/BoundedQueue.hpp"
+#include "taxi/IngestPipeline.hpp"
+#include "taxi/DatasetManager.hpp"
 #include "taxi/TripDataSoA.hpp"
 #include "taxi/BenchmarkRunner.hpp"
 #include "taxi/QueryEngine.hpp"
 #include "taxi/SoAQueryEngine.hpp"
+#include "taxi/Snapshot.hpp"
+#include "taxi/CompactSoA.hpp"
+#include "taxi/NarrowColumn.hpp"
+#include "taxi/MoneyColumn.hpp"
+#include "taxi/TimestampColumn.hpp"
+#include "taxi/PackedColumn.hpp"
+#include "taxi/ZoneMap.hpp"
+#include "taxi/HugePages.hpp"
+#include "taxi/RadixSort.hpp"
+#include "taxi/TimeIndex.hpp"
+#include "taxi/PartitionedDataset.hpp"
+#include "taxi/HotColdTrips.hpp"
+#include "taxi/TripDataAoSoA.hpp"
+#include "taxi/AoSoAQueryEngine.hpp"
 #include "taxi/QueryTypes.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <filesystem>
+#include <iterator>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 static int passed = 0;
 static int failed = 0;
@@ -84,8 +124,9 @@ static taxi::TripRecord make_record(int vendor, int64_t pickup, int64_t dropoff,
     return r;
 }
 
-static std::string write_temp_csv(const std::string& content) {
-    auto path = std::filesystem::temp_directory_path() / "taxi_unit_test.csv";
+static std::string write_temp_csv(const std::string& content,
+                                  const std::string& name = "taxi_unit_test.csv") {
+    auto path = std::filesystem::temp_directory_path() / name;
     std::ofstream f(path);
     f << content;
     f.close();
@@ -214,6 +255,723 @@ void test_csv_reader_multiple_rows() {
     std::filesystem::remove(path);
 }
 
+void test_csv_reader_mmap_matches_stream() {
+    // TLC dumps quote every field; both read modes must agree field-for-field.
+    std::string csv =
+        "\"VendorID\",\"tpep_pickup_datetime\",\"tpep_dropoff_datetime\","
+        "\"passenger_count\",\"trip_distance\",\"RatecodeID\",\"store_and_fwd_flag\","
+        "\"PULocationID\",\"DOLocationID\",\"payment_type\",\"fare_amount\",\"extra\","
+        "\"mta_tax\",\"tip_amount\",\"tolls_amount\",\"improvement_surcharge\","
+        "\"total_amount\"\r\n"
+        "\"2\",\"2084 Nov 04 12:32:24 PM\",\"2084 Nov 04 12:47:41 PM\",\"1\",\"1.34\","
+        "\"1\",\"Y\",\"238\",\"236\",\"2\",\"10\",\"0\",\"0.5\",\"0\",\"0\",\"0.3\",\"10.8\"\r\n"
+        "\r\n"
+        "\"1\",\"2084 Nov 04 01:05:00 AM\",\"2084 Nov 04 01:10:00 AM\",\"3\",\"0.5\","
+        "\"1\",\"N\",\"100\",\"101\",\"1\",\"4.5\",\"0\",\"0.5\",\"1\",\"0\",\"0.3\",\"6.3\"";
+
+    auto path = write_temp_csv(csv);
+    taxi::CsvReader mapped(path, taxi::ReadMode::Mmap);
+    taxi::CsvReader streamed(path, taxi::ReadMode::Stream);
+    ASSERT_TRUE(mapped.mode() == taxi::ReadMode::Mmap);
+
+    taxi::TripRecord a{}, b{};
+    int count = 0;
+    while (mapped.read_next(a)) {
+        ASSERT_TRUE(streamed.read_next(b));
+        ASSERT_EQ(a.pickup_timestamp, b.pickup_timestamp);
+        ASSERT_EQ(a.pu_location_id, b.pu_location_id);
+        ASSERT_EQ(a.store_and_fwd_flag, b.store_and_fwd_flag);
+        ASSERT_NEAR(a.total_amount, b.total_amount, 1e-9);
+        ++count;
+    }
+    ASSERT_TRUE(!streamed.read_next(b));
+    ASSERT_EQ(count, 2);
+    ASSERT_EQ(mapped.get_stats().rows_read, 3u);       // blank line counted
+    ASSERT_EQ(mapped.get_stats().rows_discarded, 1u);
+    ASSERT_EQ(a.pu_location_id, 100);
+    ASSERT_NEAR(a.total_amount, 6.3, 0.001);
+
+    std::filesystem::remove(path);
+}
+
+void test_csv_reader_load_chunk_covers_every_row() {
+    // Every split point — including ones that land exactly on a line start —
+    // must hand each row to exactly one chunk.
+    std::string csv =
+        "VendorID,tpep_pickup_datetime,tpep_dropoff_datetime,passenger_count,"
+        "trip_distance,RatecodeID,store_and_fwd_flag,PULocationID,DOLocationID,"
+        "payment_type,fare_amount,extra,mta_tax,tip_amount,tolls_amount,"
+        "improvement_surcharge,total_amount\n";
+    for (int i = 0; i < 6; ++i) {
+        csv += "1,01/01/2021 08:00:00 AM,01/01/2021 08:15:00 AM,1,2.0,1,N,"
+             + std::to_string(10 + i) + ",75,1,10.00,0.00,0.50,1.00,0.00,0.30,11.80\n";
+    }
+
+    auto path = write_temp_csv(csv);
+    const auto size = static_cast<std::int64_t>(csv.size());
+    for (std::int64_t split = 1; split < size; ++split) {
+        taxi::CsvReader::Stats s1, s2;
+        auto first  = taxi::CsvReader::load_chunk(path, 0, split - 1, s1);
+        auto second = taxi::CsvReader::load_chunk(path, split, size - 1, s2);
+        ASSERT_EQ(first.size() + second.size(), 6u);
+        if (!first.empty() && !second.empty()) {
+            ASSERT_EQ(first.back().pu_location_id + 1, second.front().pu_location_id);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+// ── CsvScanner tests ─────────────────────────────────────────────────────────
+
+void test_csv_scanner_quoted_row() {
+    // Commas inside quotes are not structural; "" toggles twice.
+    const std::string row = "\"a,b\",\"c\"\"d\",e\n\"f\n";
+    taxi::CsvScanner scanner(taxi::CsvScanner::Kernel::Scalar);
+    auto seps = scanner.scan(row);
+    std::vector<std::uint32_t> got(seps.begin(), seps.end());
+    // ',' after "a,b" | ',' after "c""d" | '\n' | '\n' closing the stray quote
+    std::vector<std::uint32_t> expected{5, 12, 14, 17};
+    ASSERT_TRUE(got == expected);
+}
+
+void test_csv_scanner_kernels_agree() {
+    // Pseudo-random mix of structural bytes long enough to exercise full
+    // 64-byte SIMD blocks, carried quote state and the scalar tail.
+    std::string buf;
+    std::uint32_t x = 12345;
+    for (int i = 0; i < 5000; ++i) {
+        x = x * 1103515245u + 12345u;
+        const char alphabet[] = {'a', '1', ',', ',', '"', '\n', ' ', '.'};
+        buf += alphabet[(x >> 16) % 8];
+    }
+
+    taxi::CsvScanner ref(taxi::CsvScanner::Kernel::Scalar);
+    auto expected_span = ref.scan(buf);
+    std::vector<std::uint32_t> expected(expected_span.begin(), expected_span.end());
+
+    for (auto k : {taxi::CsvScanner::Kernel::Sse42, taxi::CsvScanner::Kernel::Avx2}) {
+        if (!taxi::CsvScanner::supported(k)) continue;
+        taxi::CsvScanner scanner(k);
+        auto got = scanner.scan(buf);
+        ASSERT_EQ(got.size(), expected.size());
+        ASSERT_TRUE(std::equal(got.begin(), got.end(), expected.begin()));
+    }
+}
+
+// ── FieldDecoder tests ──────────────────────────────────────────────────────
+
+void test_field_decoder_int_double() {
+    int i = -1;
+    ASSERT_TRUE(taxi::decode_int("238", i));
+    ASSERT_EQ(i, 238);
+    ASSERT_TRUE(taxi::decode_int(" +5", i));
+    ASSERT_EQ(i, 5);
+    ASSERT_TRUE(taxi::decode_int("3.5", i));   // numeric prefix, like strtol
+    ASSERT_EQ(i, 3);
+    i = 7;
+    ASSERT_TRUE(!taxi::decode_int("", i));
+    ASSERT_TRUE(!taxi::decode_int("abc", i));
+    ASSERT_TRUE(!taxi::decode_int("99999999999", i));   // overflows int
+    ASSERT_EQ(i, 7);   // untouched on failure
+
+    // Must be bit-identical to strtod, fast path and fallback alike.
+    for (const char* s : {"1.34", "-0.5", "0.1", "17.049999", "123456.789012345",
+                          "1e3", "0.30000000000000004"}) {
+        double d = 0.0;
+        ASSERT_TRUE(taxi::decode_double(s, d));
+        ASSERT_TRUE(d == std::strtod(s, nullptr));
+    }
+    double d = 42.0;
+    ASSERT_TRUE(!taxi::decode_double("", d));
+    ASSERT_TRUE(!taxi::decode_double("-", d));
+    ASSERT_NEAR(d, 42.0, 0.0);
+}
+
+void test_field_decoder_cents_money() {
+    std::int64_t c = 0;
+    ASSERT_TRUE(taxi::decode_cents("10.8", c));
+    ASSERT_EQ(c, 1080);
+    ASSERT_TRUE(taxi::decode_cents("10", c));
+    ASSERT_EQ(c, 1000);
+    ASSERT_TRUE(taxi::decode_cents("-2.50", c));
+    ASSERT_EQ(c, -250);
+    ASSERT_TRUE(taxi::decode_cents(".5", c));
+    ASSERT_EQ(c, 50);
+    ASSERT_TRUE(!taxi::decode_cents("1.234", c));   // never rounds
+    ASSERT_TRUE(!taxi::decode_cents("", c));
+    ASSERT_TRUE(taxi::decode_cents("999999999999999.99", c));   // 15 digits
+    ASSERT_EQ(c, 99999999999999999LL);
+    ASSERT_TRUE(!taxi::decode_cents("1000000000000000", c));    // 16 digits
+    ASSERT_TRUE(!taxi::decode_cents("99999999999999999999", c)); // no overflow
+
+    for (const char* s : {"18.30", "0.3", "-52.8", "7", "1.234", "0"}) {
+        double d = 0.0;
+        ASSERT_TRUE(taxi::decode_money(s, d));
+        ASSERT_TRUE(d == std::strtod(s, nullptr));
+    }
+    double d = 0.0;
+    ASSERT_TRUE(taxi::decode_money("-0.00", d));
+    ASSERT_TRUE(std::signbit(d));
+}
+
+// ── TimestampDecoder tests ──────────────────────────────────────────────────
+
+void test_days_from_civil_matches_year_loop() {
+    ASSERT_EQ(taxi::days_from_civil(1970, 1, 1), 0);
+    ASSERT_EQ(taxi::days_from_civil(2000, 3, 1), 11017);
+    ASSERT_EQ(taxi::days_from_civil(1969, 12, 31), -1);
+
+    // Reference: the year-by-year walk CsvReader used to do.
+    const int mdays[] = {31,28,31,30,31,30,31,31,30,31,30,31};
+    std::int64_t days = 0;
+    for (int y = 1970; y <= 2100; ++y) {
+        const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+        for (int m = 1; m <= 12; ++m) {
+            ASSERT_EQ(taxi::days_from_civil(y, m, 1), days);
+            days += mdays[m - 1] + (leap && m == 2 ? 1 : 0);
+        }
+    }
+}
+
+void test_timestamp_formats_agree() {
+    using taxi::TimestampFormat;
+    const char* iso   = "2084-11-04 12:32:24";
+    const char* slash = "11/04/2084 12:32:24 PM";
+    const char* named = "2084 Nov 04 12:32:24 PM";
+    ASSERT_TRUE(taxi::detect_timestamp_format(iso)   == TimestampFormat::Iso);
+    ASSERT_TRUE(taxi::detect_timestamp_format(slash) == TimestampFormat::UsSlash);
+    ASSERT_TRUE(taxi::detect_timestamp_format(named) == TimestampFormat::YearMonthName);
+
+    std::int64_t a = 0, b = 0, c = 0;
+    ASSERT_TRUE(taxi::decode_timestamp(iso, TimestampFormat::Iso, a));
+    ASSERT_TRUE(taxi::decode_timestamp(slash, TimestampFormat::UsSlash, b));
+    ASSERT_TRUE(taxi::decode_timestamp(named, TimestampFormat::YearMonthName, c));
+    ASSERT_EQ(a, taxi::days_from_civil(2084, 11, 4) * 86400 + 12 * 3600 + 32 * 60 + 24);
+    ASSERT_EQ(a, b);
+    ASSERT_EQ(a, c);
+
+    std::int64_t t = 0;
+    ASSERT_TRUE(taxi::decode_timestamp("01/01/2021 12:00:07 AM", TimestampFormat::UsSlash, t));
+    ASSERT_EQ(t, taxi::days_from_civil(2021, 1, 1) * 86400 + 7);
+    // Not fixed-width / out of range: left to CsvReader's tolerant path.
+    ASSERT_TRUE(!taxi::decode_timestamp("1/1/2021 1:00:07 AM", TimestampFormat::UsSlash, t));
+    ASSERT_TRUE(!taxi::decode_timestamp("2021-13-01 00:00:00", TimestampFormat::Iso, t));
+    ASSERT_TRUE(!taxi::decode_timestamp("2021 Foo 01 01:00:00 AM", TimestampFormat::YearMonthName, t));
+}
+
+void test_csv_reader_iso_timestamps() {
+    // ISO rows used to be misdetected as "YYYY Mon DD" and dropped.  The
+    // unpadded last row does not fit the sniffed layout and takes the
+    // tolerant path.
+    std::string csv =
+        "VendorID,tpep_pickup_datetime,tpep_dropoff_datetime,passenger_count,"
+        "trip_distance,RatecodeID,store_and_fwd_flag,PULocationID,DOLocationID,"
+        "payment_type,fare_amount,extra,mta_tax,tip_amount,tolls_amount,"
+        "improvement_surcharge,total_amount\n"
+        "1,2021-01-15 10:30:00,2021-01-15 22:45:00,2,3.5,1,N,100,200,1,15.00,"
+        "0.50,0.50,2.00,0.00,0.30,18.30\n"
+        "1,2021-1-15 9:05:00,2021-01-15 10:45:00,2,3.5,1,N,100,200,1,15.00,"
+        "0.50,0.50,2.00,0.00,0.30,18.30\n";
+
+    auto path = write_temp_csv(csv);
+    taxi::CsvReader reader(path);
+    const std::int64_t day = taxi::days_from_civil(2021, 1, 15) * 86400;
+
+    taxi::TripRecord rec{};
+    ASSERT_TRUE(reader.read_next(rec));
+    ASSERT_EQ(rec.pickup_timestamp, day + 10 * 3600 + 30 * 60);
+    ASSERT_EQ(rec.dropoff_timestamp, day + 22 * 3600 + 45 * 60);
+    ASSERT_TRUE(reader.read_next(rec));
+    ASSERT_EQ(rec.pickup_timestamp, day + 9 * 3600 + 5 * 60);
+    ASSERT_TRUE(!reader.read_next(rec));
+
+    std::filesystem::remove(path);
+}
+
+void test_date_cache_find_insert() {
+    taxi::DateCache cache;
+    std::int64_t days = -1;
+    ASSERT_TRUE(!cache.find("2021-01-15", days));
+    cache.insert("2021-01-15", 18642);
+    ASSERT_TRUE(cache.find("2021-01-15", days));
+    ASSERT_EQ(days, 18642);
+    ASSERT_TRUE(!cache.find("2021-01-16", days));
+    ASSERT_TRUE(!cache.find("2021-01-1", days));   // prefix of a key is not the key
+
+    // Fill well past the slot count: every lookup is either a miss or the
+    // exact value stored for that key, never another date's value.
+    for (int d = 0; d < 500; ++d) {
+        const std::string key = "2021-" + std::to_string(100 + d);
+        cache.insert(key, d);
+    }
+    for (int d = 0; d < 500; ++d) {
+        const std::string key = "2021-" + std::to_string(100 + d);
+        if (cache.find(key, days)) ASSERT_EQ(days, d);
+    }
+}
+
+void test_csv_reader_timestamp_cache_stats() {
+    std::string csv =
+        "VendorID,tpep_pickup_datetime,tpep_dropoff_datetime,passenger_count,"
+        "trip_distance,RatecodeID,store_and_fwd_flag,PULocationID,DOLocationID,"
+        "payment_type,fare_amount,extra,mta_tax,tip_amount,tolls_amount,"
+        "improvement_surcharge,total_amount\n"
+        "1,01/15/2021 10:30:00 AM,01/15/2021 10:45:00 AM,2,3.5,1,N,100,200,1,15.00,"
+        "0.50,0.50,2.00,0.00,0.30,18.30\n"
+        "1,01/15/2021 11:30:00 PM,01/16/2021 12:05:00 AM,2,3.5,1,N,100,200,1,15.00,"
+        "0.50,0.50,2.00,0.00,0.30,18.30\n";
+
+    auto path = write_temp_csv(csv);
+    taxi::CsvReader reader(path);
+    taxi::TripRecord rec{};
+    ASSERT_TRUE(reader.read_next(rec));
+    ASSERT_TRUE(reader.read_next(rec));
+    ASSERT_EQ(rec.dropoff_timestamp, taxi::days_from_civil(2021, 1, 16) * 86400 + 5 * 60);
+
+    // Two distinct dates decoded, the other two timestamps served from cache.
+    auto stats = reader.get_stats();
+    ASSERT_EQ(stats.timestamp_cache_misses, 2u);
+    ASSERT_EQ(stats.timestamp_cache_hits, 2u);
+    ASSERT_NEAR(stats.timestamp_cache_hit_rate(), 0.5, 1e-12);
+
+    std::filesystem::remove(path);
+}
+
+// ── ParallelLoader tests ────────────────────────────────────────────────────
+
+// Header + n data rows with PULocationID = 1..n (some rows longer than others).
+static std::string make_numbered_csv(int n) {
+    std::string csv =
+        "VendorID,tpep_pickup_datetime,tpep_dropoff_datetime,passenger_count,"
+        "trip_distance,RatecodeID,store_and_fwd_flag,PULocationID,DOLocationID,"
+        "payment_type,fare_amount,extra,mta_tax,tip_amount,tolls_amount,"
+        "improvement_surcharge,total_amount\n";
+    for (int i = 1; i <= n; ++i) {
+        csv += "1,01/01/2021 08:00:00 AM,01/01/2021 08:15:00 AM,1,"
+             + std::to_string(i % 7) + ".25,1,N," + std::to_string(i)
+             + ",75,1,10.00,0.00,0.50,1.00,0.00,0.30,11.80\n";
+    }
+    return csv;
+}
+
+void test_parallel_loader_split_morsels() {
+    const std::string body = make_numbered_csv(50).substr(200);
+    for (std::size_t m : {1u, 37u, 100u, 4096u}) {
+        auto b = taxi::ParallelLoader::split_morsels(body, m);
+        ASSERT_EQ(b.front(), 0u);
+        ASSERT_EQ(b.back(), body.size());
+        for (std::size_t i = 1; i + 1 < b.size(); ++i) {
+            ASSERT_TRUE(b[i] > b[i - 1]);
+            ASSERT_EQ(body[b[i] - 1], '\n');   // interior cuts start a line
+        }
+    }
+    ASSERT_EQ(taxi::ParallelLoader::split_morsels(body, 1u << 20).size(), 2u);
+}
+
+void test_parallel_loader_morsels_match_serial() {
+    auto path = write_temp_csv(make_numbered_csv(500));
+    for (int threads : {1, 3, 8}) {
+        // ~100-byte morsels: hundreds of work units shared by the pool.
+        auto r = taxi::ParallelLoader::load(path, threads, 100);
+        ASSERT_EQ(r.records.size(), 500u);
+        ASSERT_EQ(r.total_rows_read, 500u);
+        ASSERT_TRUE(r.morsels > 100);
+        for (std::size_t i = 0; i < r.records.size(); ++i) {
+            ASSERT_EQ(r.records[i].pu_location_id, static_cast<int>(i) + 1);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void test_parallel_loader_multi_file_single_output() {
+    auto path1 = write_temp_csv(make_numbered_csv(200));
+    auto path2 = path1 + ".2.csv";
+    { std::ofstream f(path2); f << make_numbered_csv(50); }
+
+    auto r = taxi::ParallelLoader::load(std::vector<std::string>{path1, path2}, 3, 120);
+    ASSERT_EQ(r.records.size(), 250u);
+    ASSERT_EQ(r.total_rows_read, 250u);
+    // Reserved once from the line count: no growth, no concatenation.
+    ASSERT_EQ(r.records.capacity(), 250u);
+    for (std::size_t i = 0; i < r.records.size(); ++i) {
+        const int expected = i < 200 ? static_cast<int>(i) + 1 : static_cast<int>(i) - 199;
+        ASSERT_EQ(r.records[i].pu_location_id, expected);
+    }
+    std::filesystem::remove(path1);
+    std::filesystem::remove(path2);
+}
+
+void test_parallel_loader_soa_matches_from_csv() {
+    // Two files, one with a malformed row, concatenated in order.
+    std::string second = make_numbered_csv(120);
+    second += "garbage,row\n";
+    auto path1 = write_temp_csv(make_numbered_csv(300));
+    auto path2 = path1 + ".2.csv";
+    { std::ofstream f(path2); f << second; }
+
+    const std::vector<std::string> paths{path1, path2};
+    auto serial = taxi::TripDataSoA::from_csv(paths);
+    ASSERT_EQ(serial.size(), 420u);
+    for (int threads : {1, 4}) {
+        auto r = taxi::ParallelLoader::load_soa(paths, threads, 150);
+        ASSERT_EQ(r.data.size(), serial.size());
+        ASSERT_EQ(r.total_rows_discarded, 1u);
+        ASSERT_TRUE(r.data.pu_location_id == serial.pu_location_id);
+        ASSERT_TRUE(r.data.pickup_timestamp == serial.pickup_timestamp);
+        ASSERT_TRUE(r.data.trip_distance == serial.trip_distance);
+        ASSERT_TRUE(r.data.total_amount == serial.total_amount);
+        ASSERT_TRUE(r.data.store_and_fwd_flag == serial.store_and_fwd_flag);
+    }
+    std::filesystem::remove(path1);
+    std::filesystem::remove(path2);
+}
+
+// ── IngestPipeline tests ─────────────────────────────────────────────────────
+
+void test_bounded_queue_mpmc() {
+    taxi::BoundedQueue<int> q(5);
+    ASSERT_EQ(q.capacity(), 8u);   // rounded up to a power of two
+    int v = 0;
+    for (int i = 0; i < 8; ++i) { v = i; ASSERT_TRUE(q.try_push(v)); }
+    v = 99;
+    ASSERT_TRUE(!q.try_push(v));   // full
+    std::atomic<bool> cancel{true};
+    ASSERT_TRUE(!q.push(99, cancel));   // full and cancelled: gives up
+    for (int i = 0; i < 8; ++i) { ASSERT_TRUE(q.try_pop(v)); ASSERT_EQ(v, i); }
+    ASSERT_TRUE(!q.try_pop(v));    // empty
+
+    // 3 producers x 3 consumers through a 4-slot queue: every value arrives once.
+    constexpr int kPer = 2000;
+    std::vector<std::atomic<int>> seen(3 * kPer);
+    std::vector<std::thread> producers, consumers;
+    for (int p = 0; p < 3; ++p)
+        producers.emplace_back([&, p]() { for (int i = 0; i < kPer; ++i) q.push(p * kPer + i); });
+    for (int c = 0; c < 3; ++c)
+        consumers.emplace_back([&]() { int x; while (q.pop(x)) seen[x].fetch_add(1); });
+    for (auto& t : producers) t.join();
+    q.close();
+    for (auto& t : consumers) t.join();
+    for (auto& n : seen) ASSERT_EQ(n.load(), 1);
+}
+
+void test_ingest_pipeline_matches_serial() {
+    std::string second = make_numbered_csv(120);
+    second += "garbage,row\n";
+    auto path1 = write_temp_csv(make_numbered_csv(300));
+    auto path2 = path1 + ".2.csv";
+    { std::ofstream f(path2); f << second; }
+    const std::vector<std::string> paths{path1, path2};
+    auto serial = taxi::TripDataSoA::from_csv(paths);
+
+    // 1 KB buffers and 2-deep queues: dozens of batches, lines split across
+    // buffers, and constant back-pressure on the reader.
+    taxi::IngestPipeline::Options opts;
+    opts.buffer_bytes = 1024;
+    opts.queue_depth  = 2;
+    for (int threads : {1, 3}) {
+        opts.parser_threads = threads;
+        taxi::TripDataSoA soa;
+        auto rep = taxi::IngestPipeline(opts).load(paths, soa);
+        ASSERT_EQ(soa.size(), serial.size());
+        ASSERT_TRUE(soa.pu_location_id == serial.pu_location_id);
+        ASSERT_TRUE(soa.pickup_timestamp == serial.pickup_timestamp);
+        ASSERT_TRUE(soa.total_amount == serial.total_amount);
+        ASSERT_EQ(rep.stats.rows_discarded, 1u);
+        ASSERT_EQ(rep.parser.threads, threads);
+        ASSERT_TRUE(rep.batches > 20);
+        ASSERT_TRUE(rep.reader.busy_ms + rep.reader.idle_ms > 0.0);
+    }
+
+    taxi::DatasetManager mgr;
+    opts.parser_threads = 2;
+    mgr.load_from_csv_pipelined(paths, opts);
+    ASSERT_EQ(mgr.size(), serial.size());
+    ASSERT_EQ(mgr.get_load_stats().total_rows_parsed, serial.size());
+    for (std::size_t i = 0; i < mgr.size(); ++i) {
+        ASSERT_EQ(mgr.records()[i].pu_location_id, serial.pu_location_id[i]);
+    }
+
+    bool threw = false;
+    try {
+        taxi::TripDataSoA sink;
+        taxi::IngestPipeline().load({path1, "/nonexistent/file.csv"}, sink);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    std::filesystem::remove(path1);
+    std::filesystem::remove(path2);
+}
+
+// ── ColumnMap tests ──────────────────────────────────────────────────────────
+
+// Green-taxi (lpep_) column order: reordered, plus columns TripRecord lacks.
+static const char* kGreenHeader =
+    "\"VendorID\",\"lpep_pickup_datetime\",\"lpep_dropoff_datetime\",\"store_and_fwd_flag\","
+    "\"RatecodeID\",\"PULocationID\",\"DOLocationID\",\"passenger_count\",\"trip_distance\","
+    "\"fare_amount\",\"extra\",\"mta_tax\",\"tip_amount\",\"tolls_amount\",\"ehail_fee\","
+    "\"improvement_surcharge\",\"total_amount\",\"payment_type\",\"trip_type\","
+    "\"congestion_surcharge\"\r\n";
+
+void test_column_map_from_header() {
+    using taxi::Column;
+    ASSERT_TRUE(taxi::column_from_name("PULocationID") == Column::PuLocationId);
+    ASSERT_TRUE(taxi::column_from_name("\"pickup_timestamp\"") == Column::PickupTimestamp);
+    ASSERT_TRUE(taxi::column_from_name("ratecodeid") == Column::RateCodeId);
+    ASSERT_TRUE(!taxi::column_from_name("airport_fee"));
+    ASSERT_EQ(taxi::column_name(Column::TotalAmount), std::string_view("total_amount"));
+
+    auto m = taxi::ColumnMap::from_header(kGreenHeader);
+    ASSERT_EQ(m.field_count, 20u);
+    ASSERT_EQ(m[Column::PickupTimestamp], 1);
+    ASSERT_EQ(m[Column::StoreAndFwdFlag], 3);
+    ASSERT_EQ(m[Column::PaymentType], 17);
+    ASSERT_EQ(m[Column::TotalAmount], 16);
+    ASSERT_TRUE(m.accepts(20) && !m.accepts(19) && !m.accepts(21));
+    ASSERT_EQ(m.field_mask({Column::VendorId, Column::PaymentType}), (1u << 17) | 1u);
+
+    // No timestamp columns: not a usable header, fixed positions instead.
+    auto d = taxi::ColumnMap::from_header("a,b,c");
+    ASSERT_EQ(d.field_count, 0u);
+    ASSERT_EQ(d[Column::TotalAmount], 16);
+    ASSERT_TRUE(d.accepts(17) && d.accepts(19) && !d.accepts(20));
+}
+
+void test_csv_reader_reordered_schema() {
+    std::string csv = kGreenHeader;
+    csv += "2,2021-01-01 00:15:56,2021-01-01 00:19:52,N,1,43,151,1,1.01,5.5,0.5,0.5,"
+           "0,0,,0.3,6.8,2,1,0\r\n";
+    csv += "2,2021-01-01 00:25:59,2021-01-01 00:34:44,N,1,166,239,1,2.53\r\n";   // short row
+    csv += "2,2021-01-01 00:45:57,2021-01-01 00:51:55,Y,1,41,42,2,1.12,6,0.5,0.5,"
+           "1.5,0,,0.3,8.8,1,1,0\r\n";
+    auto path = write_temp_csv(csv);
+
+    taxi::CsvReader reader(path);
+    ASSERT_EQ(reader.column_map().field_count, 20u);
+    taxi::TripRecord rec{};
+    ASSERT_TRUE(reader.read_next(rec));
+    ASSERT_EQ(rec.pu_location_id, 43);
+    ASSERT_EQ(rec.do_location_id, 151);
+    ASSERT_EQ(rec.passenger_count, 1);
+    ASSERT_NEAR(rec.trip_distance, 1.01, 1e-9);
+    ASSERT_NEAR(rec.total_amount, 6.8, 1e-9);
+    ASSERT_EQ(rec.payment_type, 2);
+    ASSERT_EQ(rec.dropoff_timestamp - rec.pickup_timestamp, 236);
+    ASSERT_TRUE(reader.read_next(rec));   // short row discarded
+    ASSERT_EQ(rec.pu_location_id, 41);
+    ASSERT_TRUE(rec.store_and_fwd_flag);
+    ASSERT_TRUE(!reader.read_next(rec));
+    ASSERT_EQ(reader.get_stats().rows_discarded, 1u);
+    std::filesystem::remove(path);
+}
+
+void test_soa_column_projection() {
+    using taxi::Column;
+    auto path1 = write_temp_csv(make_numbered_csv(300));
+    auto path2 = path1 + ".2.csv";
+    { std::ofstream f(path2); f << make_numbered_csv(40) << "garbage,row\n"; }
+    const std::vector<std::string> paths{path1, path2};
+    const taxi::ColumnSet cols{Column::PuLocationId, Column::FareAmount};
+
+    auto full = taxi::TripDataSoA::from_csv(paths);
+    auto check = [&](const taxi::TripDataSoA& p) {
+        ASSERT_TRUE(p.columns() == cols);
+        ASSERT_EQ(p.size(), full.size());
+        ASSERT_TRUE(p.pu_location_id == full.pu_location_id);
+        ASSERT_TRUE(p.fare_amount == full.fare_amount);
+        // Projected-out columns are never allocated, validation ones included.
+        ASSERT_EQ(p.pickup_timestamp.capacity(), 0u);
+        ASSERT_EQ(p.total_amount.capacity(), 0u);
+        ASSERT_EQ(p.vendor_id.capacity(), 0u);
+    };
+    check(taxi::TripDataSoA::from_csv(paths, 1000, cols));
+    check(taxi::ParallelLoader::load_soa(paths, 3, 200, cols).data);
+
+    taxi::IngestPipeline::Options opts;
+    opts.buffer_bytes = 1024;
+    taxi::TripDataSoA piped(cols);
+    taxi::IngestPipeline(opts).load(paths, piped);
+    check(piped);
+
+    std::filesystem::remove(path1);
+    std::filesystem::remove(path2);
+}
+
+// ── FileSource tests ─────────────────────────────────────────────────────────
+
+void test_file_source_backends_read_whole_file() {
+    using Backend = taxi::FileSource::Backend;
+    const std::string csv = make_numbered_csv(300);   // ~30 KB: several chunks
+    auto path = write_temp_csv(csv);
+
+    for (Backend b : {Backend::Buffered, Backend::Pread, Backend::Direct}) {
+        auto src = taxi::FileSource::open(path, b, 4096);
+        ASSERT_EQ(src->size(), csv.size());
+        std::string got;
+        for (auto chunk = src->next(); !chunk.empty(); chunk = src->next()) {
+            ASSERT_TRUE(chunk.size() <= 4096u);
+            got.append(chunk);
+        }
+        ASSERT_TRUE(got == csv);
+        ASSERT_TRUE(src->next().empty());   // stays at EOF
+    }
+
+    std::filesystem::remove(path);
+}
+
+void test_file_source_direct_short_read() {
+    // The first io_uring read ends mid-block; the rest of the chunk must be
+    // read back with O_DIRECT's aligned offsets, not fail with EINVAL.
+    const std::string csv = make_numbered_csv(300);
+    auto path = write_temp_csv(csv);
+
+    taxi::FileSource::set_short_first_read(1000);
+    auto src = taxi::FileSource::open(path, taxi::FileSource::Backend::Direct, 8192);
+    taxi::FileSource::set_short_first_read(0);
+    std::string got;
+    for (auto chunk = src->next(); !chunk.empty(); chunk = src->next()) got.append(chunk);
+    ASSERT_TRUE(got == csv);
+
+    std::filesystem::remove(path);
+}
+
+void test_csv_reader_read_modes_agree() {
+    // ~9 MB so rows straddle the 4 MB FileSource chunks; no final newline.
+    std::string csv = make_numbered_csv(100000);
+    csv.pop_back();
+    auto path = write_temp_csv(csv);
+
+    auto read_all = [&](taxi::ReadMode mode) {
+        taxi::CsvReader reader(path, mode);
+        ASSERT_TRUE(reader.is_open());
+        std::vector<taxi::TripRecord> rows;
+        taxi::TripRecord r;
+        while (reader.read_next(r)) rows.push_back(r);
+        ASSERT_EQ(reader.get_stats().rows_discarded, 0u);
+        return rows;
+    };
+
+    const auto expected = read_all(taxi::ReadMode::Mmap);
+    ASSERT_EQ(expected.size(), 100000u);
+    for (auto mode : {taxi::ReadMode::Stream, taxi::ReadMode::Buffered,
+                      taxi::ReadMode::Pread, taxi::ReadMode::Direct}) {
+        const auto rows = read_all(mode);
+        ASSERT_EQ(rows.size(), expected.size());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            ASSERT_EQ(rows[i].pu_location_id, expected[i].pu_location_id);
+            ASSERT_NEAR(rows[i].trip_distance, expected[i].trip_distance, 1e-9);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+// ── Compression tests ────────────────────────────────────────────────────────
+
+// One gzip member holding @p data in stored (uncompressed) deflate blocks,
+// so the tests can build .gz input without linking zlib themselves.
+static std::string gzip_stored(std::string_view data) {
+    std::uint32_t crc = ~0u;
+    for (unsigned char c : data) {
+        crc ^= c;
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    std::string out("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10);
+    auto put = [&](std::uint32_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) out += static_cast<char>((v >> (8 * i)) & 0xff);
+    };
+    std::size_t pos = 0;
+    do {
+        const std::size_t n = std::min<std::size_t>(data.size() - pos, 65535);
+        out += static_cast<char>(pos + n == data.size() ? 1 : 0);   // BFINAL, stored
+        put(static_cast<std::uint32_t>(n), 2);
+        put(static_cast<std::uint32_t>(~n & 0xffff), 2);
+        out.append(data.substr(pos, n));
+        pos += n;
+    } while (pos < data.size());
+    put(~crc, 4);
+    put(static_cast<std::uint32_t>(data.size()), 4);
+    return out;
+}
+
+// make_numbered_csv(n) as a multi-member .gz cut mid-line, with a fake gzip
+// member header inside one row's store_and_fwd_flag field.  Returns the
+// path of the plain CSV; the .gz is written next to it.
+static std::string write_gzip_members(int n, std::string& gz_path) {
+    std::string csv = make_numbered_csv(n);
+    const std::string fake("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10);
+    csv.replace(csv.find(",N,", csv.size() / 3) + 1, 1, fake);
+    const std::string path = write_temp_csv(csv);
+
+    std::string gz;
+    const std::size_t cut = csv.size() / 5 + 7;   // not on a line boundary
+    for (std::size_t pos = 0; pos < csv.size(); pos += cut) {
+        gz += gzip_stored(std::string_view(csv).substr(pos, cut));
+    }
+    gz_path = path + ".gz";
+    std::ofstream(gz_path, std::ios::binary) << gz;
+    return path;
+}
+
+void test_csv_reader_gzip_members() {
+    if (!taxi::compression_supported(taxi::Compression::Gzip)) return;   // no zlib
+    std::string gz_path;
+    const std::string path = write_gzip_members(3000, gz_path);
+    ASSERT_TRUE(taxi::file_compression(gz_path) == taxi::Compression::Gzip);
+    ASSERT_TRUE(taxi::file_compression(path) == taxi::Compression::None);
+
+    auto read_all = [](taxi::CsvReader& reader) {
+        std::vector<taxi::TripRecord> rows;
+        taxi::TripRecord r;
+        while (reader.read_next(r)) rows.push_back(r);
+        return rows;
+    };
+    taxi::CsvReader plain(path);
+    const auto expected = read_all(plain);
+    ASSERT_EQ(expected.size(), 3000u);
+
+    for (auto mode : {taxi::ReadMode::Mmap, taxi::ReadMode::Pread}) {
+        taxi::CsvReader reader(gz_path, mode);
+        ASSERT_TRUE(std::string(reader.io_backend()).rfind("gzip:", 0) == 0);
+        const auto rows = read_all(reader);
+        ASSERT_EQ(rows.size(), expected.size());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            ASSERT_EQ(rows[i].pu_location_id, expected[i].pu_location_id);
+            ASSERT_EQ(rows[i].store_and_fwd_flag, expected[i].store_and_fwd_flag);
+        }
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(gz_path);
+}
+
+void test_parallel_loader_gzip_members() {
+    if (!taxi::compression_supported(taxi::Compression::Gzip)) return;   // no zlib
+    std::string gz_path;
+    const std::string path = write_gzip_members(3000, gz_path);
+
+    // Five members plus one false candidate: the split is verified and the
+    // affected range decoded again, so the text comes back intact.
+    std::ifstream in(gz_path, std::ios::binary);
+    const std::string gz((std::istreambuf_iterator<char>(in)), {});
+    const auto text = taxi::decompress_parallel(gz, taxi::Compression::Gzip, 3);
+    ASSERT_EQ(text.members(), 5u);
+    ASSERT_EQ(text.size(), std::filesystem::file_size(path));
+    for (std::string_view b : text.blocks()) ASSERT_EQ(b.back(), '\n');
+
+    auto serial = taxi::ParallelLoader::load(path, 1);
+    auto par    = taxi::ParallelLoader::load(gz_path, 3, 4096);
+    ASSERT_EQ(par.records.size(), serial.records.size());
+    ASSERT_EQ(par.total_rows_read, serial.total_rows_read);
+    for (std::size_t i = 0; i < par.records.size(); ++i) {
+        ASSERT_EQ(par.records[i].pu_location_id, serial.records[i].pu_location_id);
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(gz_path);
+}
+
 // ── TripDataSoA tests ────────────────────────────────────────────────────────
 
 void test_soa_from_aos_size() {
@@ -433,6 +1191,1012 @@ void test_aos_soa_query_consistency() {
     ASSERT_NEAR(aos_agg.avg, soa_agg.avg, 0.001);
 }
 
+// ── Snapshot tests ───────────────────────────────────────────────────────────
+
+void test_snapshot_round_trip() {
+    auto csv = write_temp_csv(make_numbered_csv(300));
+    taxi::CsvReader::Stats stats;
+    auto soa = taxi::TripDataSoA::from_csv({csv}, 0, taxi::ColumnSet::all(),
+                                           taxi::ReadMode::Mmap, &stats);
+    taxi::SoAQueryEngine engine(soa);
+    engine.build_indexes();
+
+    const auto snap = (std::filesystem::temp_directory_path() / "taxi_unit_test.snap").string();
+    taxi::Snapshot::save(snap, soa, engine.time_index(), stats,
+                         taxi::Snapshot::fingerprint({csv}));
+    ASSERT_TRUE(taxi::Snapshot::is_snapshot(snap));
+    ASSERT_TRUE(!taxi::Snapshot::is_snapshot(csv));
+
+    auto back = taxi::Snapshot::load(snap);
+    ASSERT_EQ(back.data.size(), soa.size());
+    ASSERT_TRUE(back.data.columns() == soa.columns());
+    const auto a = soa.column_bytes();
+    const auto b = back.data.column_bytes();
+    ASSERT_EQ(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        ASSERT_TRUE(a[i].column == b[i].column);
+        ASSERT_EQ(std::memcmp(a[i].data, b[i].data, soa.size() * a[i].elem_bytes), 0);
+    }
+    ASSERT_TRUE(back.time_index == engine.time_index());
+    ASSERT_EQ(back.stats.rows_read, stats.rows_read);
+    ASSERT_EQ(back.stats.timestamp_cache_hits, stats.timestamp_cache_hits);
+    ASSERT_EQ(back.sources.size(), 1u);
+    ASSERT_TRUE(!taxi::Snapshot::is_stale(back));
+
+    // The restored index answers queries like a freshly built one.
+    taxi::SoAQueryEngine restored(back.data);
+    restored.restore_indexes(std::move(back.time_index));
+    taxi::TimeRangeQuery q{0, INT64_MAX};
+    ASSERT_EQ(restored.aggregate_fare_by_time(q).count, 300u);
+
+    // Touching the source CSV makes the snapshot stale.
+    std::ofstream(csv, std::ios::app) << "\n";
+    ASSERT_TRUE(taxi::Snapshot::is_stale(taxi::Snapshot::load(snap)));
+
+    std::filesystem::remove(snap);
+    std::filesystem::remove(csv);
+}
+
+void test_snapshot_rejects_corruption() {
+    auto csv = write_temp_csv(make_numbered_csv(200));
+    auto soa = taxi::TripDataSoA::from_csv({csv}, 0, {taxi::Column::PickupTimestamp,
+                                                      taxi::Column::FareAmount});
+    const auto snap = (std::filesystem::temp_directory_path() / "taxi_unit_test.snap").string();
+    const auto bytes = taxi::Snapshot::save(snap, soa, {}, {}, {});
+
+    auto throws = [](auto&& fn) {
+        try { fn(); } catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    ASSERT_TRUE(throws([&] { taxi::Snapshot::load(csv); }));   // not a snapshot
+    ASSERT_TRUE(taxi::Snapshot::load(snap).time_index.empty());
+    ASSERT_TRUE(throws([&] {                                   // wrong index size
+        taxi::Snapshot::save(snap + "2", soa, {0, 1}, {}, {});
+    }));
+
+    // Flip one byte of the first column section (at 4 KB).
+    {
+        std::fstream f(snap, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekg(4096);
+        char c = 0;
+        f.read(&c, 1);
+        f.seekp(4096);
+        c = static_cast<char>(c ^ 0x40);
+        f.write(&c, 1);
+    }
+    ASSERT_TRUE(throws([&] { taxi::Snapshot::load(snap); }));
+    ASSERT_EQ(taxi::Snapshot::load(snap, false).data.size(), 200u);
+
+    std::filesystem::resize_file(snap, bytes - 1);
+    ASSERT_TRUE(throws([&] { taxi::Snapshot::load(snap, false); }));
+
+    std::filesystem::remove(snap);
+    std::filesystem::remove(csv);
+}
+
+void test_snapshot_map_matches_load() {
+    auto csv = write_temp_csv(make_numbered_csv(300));
+    auto soa = taxi::TripDataSoA::from_csv({csv});
+    taxi::SoAQueryEngine engine(soa);
+    engine.build_indexes();
+    const auto snap = (std::filesystem::temp_directory_path() / "taxi_unit_test.snap").string();
+    taxi::Snapshot::save(snap, soa, engine.time_index(), {}, {});
+
+    auto mapped = taxi::Snapshot::map(snap, true);
+    ASSERT_TRUE(mapped.data.trip_distance.is_mapped());
+    ASSERT_TRUE(mapped.data.pu_location_id == soa.pu_location_id);
+    ASSERT_TRUE(mapped.data.total_amount == soa.total_amount);
+    ASSERT_TRUE(mapped.time_index == engine.time_index());
+
+    // The engine runs unchanged over mapped columns.
+    taxi::SoAQueryEngine lazy(mapped.data);
+    lazy.restore_indexes(std::move(mapped.time_index));
+    ASSERT_EQ(lazy.search_by_location({100, 200}).indices.size(),
+              engine.search_by_location({100, 200}).indices.size());
+    ASSERT_EQ(lazy.search_by_distance({1.0, 3.0}).indices.size(),
+              engine.search_by_distance({1.0, 3.0}).indices.size());
+    ASSERT_NEAR(lazy.aggregate_fare_by_time({0, INT64_MAX}).sum,
+                engine.aggregate_fare_by_time({0, INT64_MAX}).sum, 1e-9);
+
+    std::filesystem::remove(snap);
+    std::filesystem::remove(csv);
+}
+
+void test_column_data_mapped_copy_on_write() {
+    auto csv = write_temp_csv(make_numbered_csv(50));
+    auto soa = taxi::TripDataSoA::from_csv({csv});
+    const auto snap = (std::filesystem::temp_directory_path() / "taxi_unit_test.snap").string();
+    taxi::Snapshot::save(snap, soa, {}, {}, {});
+
+    auto mapped = taxi::Snapshot::map(snap);
+    auto& loc = mapped.data.pu_location_id;
+    ASSERT_TRUE(loc.is_mapped());
+    loc[0] = -1;                                   // private to this process
+    ASSERT_EQ(loc[0], -1);
+    ASSERT_EQ(taxi::Snapshot::load(snap).data.pu_location_id[0], 1);
+
+    auto copy = loc;                               // copies are owned
+    ASSERT_TRUE(!copy.is_mapped());
+    ASSERT_TRUE(copy == loc);
+    loc.push_back(51);                             // growing detaches
+    ASSERT_TRUE(!loc.is_mapped());
+    ASSERT_EQ(loc.size(), 51u);
+    ASSERT_EQ(loc[0], -1);
+    ASSERT_EQ(loc[49], 50);
+
+    std::filesystem::remove(snap);
+    std::filesystem::remove(csv);
+}
+
+// ── CompactSoA tests ─────────────────────────────────────────────────────────
+
+void test_narrow_column_widens() {
+    taxi::NarrowColumn col;
+    ASSERT_TRUE(col.width() == taxi::IntWidth::U8);
+    col.push_back(7);
+    col.push_back(255);
+    ASSERT_TRUE(col.width() == taxi::IntWidth::U8);
+    col.push_back(265);                            // a location ID: u16
+    ASSERT_TRUE(col.width() == taxi::IntWidth::U16);
+    col.push_back(-1);                             // an outlier: i32
+    ASSERT_TRUE(col.width() == taxi::IntWidth::I32);
+    ASSERT_EQ(col.size(), 4u);
+    ASSERT_EQ(col[0], 7);
+    ASSERT_EQ(col[1], 255);
+    ASSERT_EQ(col[2], 265);
+    ASSERT_EQ(col[3], -1);
+    ASSERT_EQ(col.bytes(), 16u);
+
+    const std::vector<int> locs = {1, 132, 265};
+    ASSERT_TRUE(taxi::NarrowColumn::from(locs).width() == taxi::IntWidth::U16);
+    ASSERT_TRUE(taxi::NarrowColumn::from(std::vector<int>{0, 6}).width() == taxi::IntWidth::U8);
+    ASSERT_EQ(taxi::NarrowColumn::from(locs)[2], 265);
+
+    std::uint8_t lo = 0, hi = 0;
+    ASSERT_TRUE(taxi::narrow_range(-5, 300, lo, hi));
+    ASSERT_EQ(int(lo), 0);
+    ASSERT_EQ(int(hi), 255);
+    ASSERT_TRUE(!taxi::narrow_range(256, 300, lo, hi));
+}
+
+void test_compact_soa_matches_wide() {
+    auto csv  = write_temp_csv(make_numbered_csv(300));
+    auto soa  = taxi::TripDataSoA::from_csv({csv});
+    auto from_csv = taxi::CompactTripDataSoA::from_csv({csv});
+    auto compact  = taxi::CompactTripDataSoA::from_soa(taxi::TripDataSoA::from_csv({csv}));
+
+    ASSERT_EQ(compact.size(), 300u);
+    ASSERT_TRUE(compact.pu_location_id.width() == taxi::IntWidth::U16);
+    ASSERT_EQ(compact.passenger_count.bits(), 0u);        // one value: no bits
+    ASSERT_TRUE(compact.passenger_count == from_csv.passenger_count);
+    ASSERT_TRUE(compact.wide.pu_location_id.empty());   // freed, not duplicated
+    ASSERT_TRUE(compact.pu_location_id == from_csv.pu_location_id);
+    ASSERT_TRUE(compact.wide.trip_distance == from_csv.wide.trip_distance);
+    ASSERT_EQ(compact.bytes(), from_csv.bytes());
+    std::size_t wide_bytes = 0;
+    for (const auto& c : soa.column_bytes()) wide_bytes += c.elem_bytes * soa.size();
+    // ints 6 x 4 + flag 1 -> locations 2+1 and five 4-byte dictionaries,
+    // money 7 x 8 -> 7 x 4, timestamps 8+8 -> 4 + 2 (900 s delta) plus one
+    // 12-byte block header
+    ASSERT_EQ(wide_bytes - compact.bytes(),
+              300u * ((25 - 3) + (56 - 28) + (16 - 6)) - 5 * 4 - 12);
+
+    taxi::SoAQueryEngine wide(soa), narrow(compact);
+    wide.build_indexes();
+    narrow.build_indexes();
+    for (auto q : {taxi::IntRangeQuery{100, 200}, taxi::IntRangeQuery{-10, 50},
+                   taxi::IntRangeQuery{70000, 80000}}) {
+        auto a = wide.search_by_location(q).indices;
+        auto b = narrow.search_by_location(q).indices;
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        ASSERT_TRUE(a == b);
+    }
+    const taxi::CombinedQuery q{{0, INT64_MAX}, {1.0, 3.0}, {1, 2}};
+    ASSERT_EQ(narrow.search_combined(q).indices.size(),
+              wide.search_combined(q).indices.size());
+
+    std::filesystem::remove(csv);
+}
+
+void test_money_column_cents() {
+    taxi::MoneyColumn col;
+    for (double v : {10.8, 0.3, -2.5, 1234.56}) col.push_back(v);
+    ASSERT_TRUE(col.is_cents());
+    ASSERT_EQ(col.bytes(), 16u);
+    ASSERT_TRUE(col[0] == 10.8 && col[1] == 0.3 && col[2] == -2.5 && col[3] == 1234.56);
+    col.push_back(0.125);                          // not whole cents: doubles
+    ASSERT_TRUE(!col.is_cents());
+    ASSERT_TRUE(col[0] == 10.8 && col[3] == 1234.56 && col[4] == 0.125);
+    const std::vector<double> amounts = {10.8, 0.3};
+    ASSERT_TRUE(taxi::MoneyColumn::from(amounts).is_cents());
+
+    // Cents bounds select exactly what the double comparison selects.
+    std::int32_t lo = 0, hi = 0;
+    ASSERT_TRUE(taxi::cents_range(10.0, 50.0, lo, hi));
+    ASSERT_EQ(lo, 1000);
+    ASSERT_EQ(hi, 5000);
+    ASSERT_TRUE(taxi::cents_range(0.1 + 0.2, 0.7, lo, hi));   // 0.30000000000000004
+    ASSERT_EQ(lo, 31);
+    ASSERT_TRUE(taxi::cents_range(10.001, 10.009, lo, hi) == false);
+    ASSERT_TRUE(taxi::cents_range(-1e300, 1e300, lo, hi));
+    ASSERT_EQ(lo, INT32_MIN);
+    ASSERT_EQ(hi, INT32_MAX);
+}
+
+void test_compact_money_queries_exact() {
+    std::string csv = make_numbered_csv(0);
+    for (int i = 1; i <= 400; ++i) {
+        const std::string fare  = std::to_string(i % 97) + "." + std::to_string(10 + i % 90);
+        const std::string total = std::to_string(5 + i % 60) + ".0" + std::to_string(i % 10);
+        csv += "1,01/01/2021 08:" + std::to_string(10 + i % 50) + ":00 AM,01/01/2021 09:00:00 AM,1,"
+             "2.5,1,N,100,75,1," + fare + ",0.00,0.50,1.00,0.00,0.30," + total + "\n";
+    }
+    auto path = write_temp_csv(csv);
+    auto soa     = taxi::TripDataSoA::from_csv({path});
+    auto compact = taxi::CompactTripDataSoA::from_csv({path});
+    ASSERT_TRUE(compact.fare_amount.is_cents());
+    ASSERT_TRUE(compact.total_amount.is_cents());
+
+    taxi::SoAQueryEngine wide(soa), cents(compact);
+    for (taxi::NumericRangeQuery q : {taxi::NumericRangeQuery{10.0, 50.0},
+                                      taxi::NumericRangeQuery{20.05, 20.05},
+                                      taxi::NumericRangeQuery{-5.0, 5.0}}) {
+        auto a = wide.search_by_fare(q).indices;
+        auto b = cents.search_by_fare(q).indices;
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        ASSERT_TRUE(a == b);
+    }
+
+    // The cents sum is exact: the same for every thread count, indexed or not.
+    long long expect_cents = 0;
+    for (std::size_t i = 0; i < soa.size(); ++i) expect_cents += std::llround(soa.fare_amount[i] * 100);
+    const auto all = taxi::TimeRangeQuery{0, INT64_MAX};
+#if defined(_OPENMP)
+    const int saved_threads = omp_get_max_threads();
+#endif
+    for (int threads : {1, 3}) {
+#if defined(_OPENMP)
+        omp_set_num_threads(threads);
+#endif
+        ASSERT_TRUE(cents.aggregate_fare_by_time(all).sum == static_cast<double>(expect_cents) / 100.0);
+    }
+    cents.build_indexes();
+    wide.build_indexes();
+    const auto c = cents.aggregate_fare_by_time(all);
+    ASSERT_TRUE(c.sum == static_cast<double>(expect_cents) / 100.0);
+    ASSERT_EQ(c.count, 400u);
+    ASSERT_NEAR(c.sum, wide.aggregate_fare_by_time(all).sum, 1e-6);
+#if defined(_OPENMP)
+    omp_set_num_threads(saved_threads);
+#endif
+
+    std::filesystem::remove(path);
+}
+
+void test_timestamp_column_encoding() {
+    taxi::TimestampColumn col;
+    std::vector<std::int64_t> values;
+    for (std::size_t i = 0; i < 2500; ++i)
+        values.push_back(1'600'000'000 + static_cast<std::int64_t>((i * 7919) % 5000));
+    values[1500] = 1'500'000'000;                  // below its block's base: rebases
+    for (auto v : values) col.push_back(v);
+    ASSERT_TRUE(col.is_encoded());
+    ASSERT_EQ(col.size(), 2500u);
+    ASSERT_EQ(col.bytes(), 2500u * 4 + 3 * 12);
+    for (std::size_t i = 0; i < values.size(); ++i) ASSERT_EQ(col[i], values[i]);
+    ASSERT_TRUE(taxi::TimestampColumn::from(values) == col);
+
+    col.visit([&](auto ts) {
+        if constexpr (std::is_same_v<decltype(ts), taxi::TimestampColumn::Reader>) {
+            std::uint32_t lo = 0, hi = 0;
+            ASSERT_EQ(ts.blocks, 3u);
+            ASSERT_TRUE(!ts.block_range(0, 0, 1'599'999'999, lo, hi));
+            ASSERT_TRUE(ts.block_range(0, 1'600'000'010, 1'600'000'020, lo, hi));
+            ASSERT_EQ(hi - lo, 10u);
+        }
+    });
+
+    col.push_back(INT64_C(1) << 40);               // a 2^40 s span: plain int64
+    ASSERT_TRUE(!col.is_encoded());
+    ASSERT_EQ(col[1500], 1'500'000'000);
+    ASSERT_EQ(col[2500], INT64_C(1) << 40);
+
+    taxi::TimestampDeltaColumn drop;
+    const std::vector<std::int64_t> pick = {100, 200, 300};
+    drop.push_back(160, 100, pick);
+    drop.push_back(100'200, 200, pick);            // 27.8 h: u8 -> i32
+    ASSERT_TRUE(drop.is_delta());
+    ASSERT_EQ(drop.at(1, 200), 100'200);
+    drop.push_back(INT64_C(1) << 40, 300, pick);   // beyond int: plain
+    ASSERT_TRUE(!drop.is_delta());
+    ASSERT_EQ(drop.at(0, 0), 160);
+    ASSERT_EQ(drop.at(2, 0), INT64_C(1) << 40);
+}
+
+void test_compact_time_queries_match() {
+    std::string csv = make_numbered_csv(0);
+    char row[160];
+    for (int i = 0; i < 3000; ++i) {
+        std::snprintf(row, sizeof row,
+                      "1,01/%02d/2021 %02d:%02d:00 AM,01/%02d/2021 11:59:00 PM,%d,"
+                      "%d.5,1,N,100,75,1,12.30,0.00,0.50,1.00,0.00,0.30,14.10\n",
+                      1 + (i / 110), 1 + (i * 7) % 11, i % 60, 1 + (i / 110), 1 + i % 4, i % 5);
+        csv += row;
+    }
+    auto path = write_temp_csv(csv);
+    auto soa     = taxi::TripDataSoA::from_csv({path});
+    auto compact = taxi::CompactTripDataSoA::from_soa(taxi::TripDataSoA::from_csv({path}));
+    ASSERT_EQ(compact.size(), 3000u);
+    ASSERT_TRUE(compact.pickup_timestamp.is_encoded());
+    ASSERT_TRUE(compact.wide.pickup_timestamp.empty());
+    ASSERT_EQ(compact.passenger_count.bits(), 2u);      // 1-4: Q5 selects on 2 bits
+    for (std::size_t i = 0; i < soa.size(); ++i) {
+        ASSERT_EQ(compact.pickup_timestamp[i], soa.pickup_timestamp[i]);
+        ASSERT_EQ(compact.dropoff_at(i), soa.dropoff_timestamp[i]);
+    }
+
+    const std::int64_t t0 = soa.pickup_timestamp[500], t1 = soa.pickup_timestamp[2200];
+    const taxi::TimeRangeQuery q{std::min(t0, t1), std::max(t0, t1)};
+    const taxi::CombinedQuery  cq{q, {1.0, 3.0}, {2, 3}};
+    taxi::SoAQueryEngine wide(soa), narrow(compact);
+    for (bool indexed : {false, true}) {               // block scans, then the index
+        if (indexed) {
+            wide.build_indexes();
+            narrow.build_indexes();
+            ASSERT_TRUE(wide.time_index() == narrow.time_index());
+        }
+        auto a = wide.search_by_time(q).indices;
+        auto b = narrow.search_by_time(q).indices;
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        ASSERT_TRUE(!a.empty() && a == b);
+        ASSERT_EQ(narrow.search_combined(cq).indices.size(),
+                  wide.search_combined(cq).indices.size());
+        ASSERT_EQ(narrow.aggregate_fare_by_time(q).count, wide.aggregate_fare_by_time(q).count);
+    }
+
+    std::filesystem::remove(path);
+}
+
+void test_packed_column_select() {
+    // Passenger counts 0-6 plus a rare 9: 8 distinct values, 3 bits.
+    std::vector<int> pax;
+    for (int i = 0; i < 1000; ++i) pax.push_back(i % 97 == 0 ? 9 : i % 7);
+    auto col = taxi::PackedColumn::from(std::span<const int>(pax));
+    ASSERT_EQ(col.bits(), 3u);
+    ASSERT_EQ(col.dictionary().size(), 8u);
+    ASSERT_EQ(col.bytes(), 16u * 3 * 8 + 8 * 4);       // 16 groups of 3 words
+    for (std::size_t i = 0; i < pax.size(); ++i) ASSERT_EQ(col[i], pax[i]);
+
+    auto check_select = [&](const taxi::PackedColumn& c) {
+        for (auto [lo, hi] : {std::pair{1, 2}, std::pair{0, 6}, std::pair{3, 9},
+                              std::pair{7, 8}, std::pair{-5, 0}, std::pair{9, 100}}) {
+            const auto sel = c.select(lo, hi);
+            ASSERT_EQ(sel.size(), 16u);
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < pax.size(); ++i) {
+                ASSERT_EQ(taxi::selected(sel, i), pax[i] >= lo && pax[i] <= hi);
+                count += pax[i] >= lo && pax[i] <= hi;
+            }
+            std::size_t bits = 0;                   // nothing set past size()
+            for (auto w : sel) bits += std::popcount(w);
+            ASSERT_EQ(bits, count);
+        }
+    };
+    check_select(col);
+
+    // Appending gives new values the next code in arrival order (9 first,
+    // then 1-6, then 0), so ranges like [3, 9] are not one code range.
+    taxi::PackedColumn grown;
+    for (int v : pax) grown.push_back(v);
+    ASSERT_TRUE(grown == col);
+    ASSERT_EQ(grown.dictionary()[0], 9);
+    ASSERT_EQ(grown.bits(), 3u);
+    check_select(grown);
+
+    // A 9th value widens to 4 bits without touching the existing codes.
+    grown.push_back(-1);
+    ASSERT_EQ(grown.bits(), 4u);
+    ASSERT_EQ(grown[1000], -1);
+    ASSERT_EQ(grown[97], 9);
+    for (std::size_t i = 0; i < pax.size(); ++i) ASSERT_EQ(grown[i], pax[i]);
+    ASSERT_TRUE(taxi::selected(grown.select(-1, -1), 1000));
+}
+
+// ── ZoneMap tests ───────────────────────────────────────────────────────────
+
+void test_zone_map_summaries() {
+    // 10000 rows: blocks of 4096, 4096 and 1808; PULocationID = row + 1.
+    auto path = write_temp_csv(make_numbered_csv(10000));
+    auto soa  = taxi::TripDataSoA::from_csv({path});
+    auto map  = taxi::ZoneMap::build(soa);
+
+    auto pu = map.zones(taxi::Column::PuLocationId);
+    ASSERT_EQ(pu.size(), 3u);
+    ASSERT_EQ(pu[0].min, 1.0);
+    ASSERT_EQ(pu[0].max, 4096.0);
+    ASSERT_EQ(pu[2].min, 8193.0);
+    ASSERT_EQ(pu[2].max, 10000.0);
+    ASSERT_EQ(pu[2].zeros, 0u);
+    ASSERT_EQ(map.zones(taxi::Column::Extra)[2].zeros, 1808u);
+    ASSERT_EQ(map.zones(taxi::Column::TotalAmount)[1].max, 11.80);
+    ASSERT_EQ(map.bytes(), 17u * 3 * sizeof(taxi::Zone));
+
+    // A compact table summarises its values, not their encodings.
+    auto compact = taxi::CompactTripDataSoA::from_soa(taxi::TripDataSoA::from_csv({path}));
+    auto cmap    = taxi::ZoneMap::build(compact);
+    for (std::size_t c = 0; c < taxi::kColumnCount; ++c) {
+        auto a = map.zones(static_cast<taxi::Column>(c));
+        auto b = cmap.zones(static_cast<taxi::Column>(c));
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t z = 0; z < a.size(); ++z) {
+            ASSERT_EQ(a[z].min, b[z].min);
+            ASSERT_EQ(a[z].max, b[z].max);
+            ASSERT_EQ(a[z].zeros, b[z].zeros);
+        }
+    }
+
+    // NaN is a null: out of min / max, and its block is never taken whole.
+    taxi::ZoneMap nan_map;
+    std::vector<double> v{1.0, std::nan(""), 3.0};
+    nan_map.add(taxi::Column::TripDistance, v.size(), [&](std::size_t i) { return v[i]; });
+    auto z = nan_map.zones(taxi::Column::TripDistance)[0];
+    ASSERT_EQ(z.nulls, 1u);
+    ASSERT_EQ(z.max, 3.0);
+    ASSERT_TRUE(taxi::zone_match(z, 0.0, 5.0) == taxi::ZoneMatch::Some);
+    ASSERT_TRUE(taxi::zone_match(z, 4.0, 5.0) == taxi::ZoneMatch::None);
+    std::filesystem::remove(path);
+}
+
+void test_zone_pruned_scans() {
+    auto path = write_temp_csv(make_numbered_csv(10000));
+    auto soa  = taxi::TripDataSoA::from_csv({path});
+    auto compact = taxi::CompactTripDataSoA::from_soa(taxi::TripDataSoA::from_csv({path}));
+    taxi::SoAQueryEngine unpruned(soa), wide(soa), narrow(compact);
+    wide.build_indexes();
+    narrow.build_indexes();
+
+    auto sorted = [](taxi::SoAQueryResult r) {
+        std::sort(r.indices.begin(), r.indices.end());
+        return r.indices;
+    };
+    for (const taxi::SoAQueryEngine* e : {&wide, &narrow}) {
+        // Locations are clustered: only the block holding the range is read,
+        // and a range covering whole blocks reads nothing.
+        taxi::IntRangeQuery few{5000, 5100}, blocks{1, 8192};
+        auto r = e->search_by_location(few);
+        ASSERT_EQ(r.scanned, 4096u);
+        ASSERT_TRUE(sorted(r) == sorted(unpruned.search_by_location(few)));
+        ASSERT_EQ(r.indices.size(), 101u);
+        r = e->search_by_location(blocks);
+        ASSERT_EQ(r.scanned, 0u);
+        ASSERT_EQ(r.indices.size(), 8192u);
+
+        // Every total is 11.80: all or nothing without reading a row.
+        ASSERT_EQ(e->search_by_fare({11.0, 12.0}).indices.size(), 10000u);
+        ASSERT_EQ(e->search_by_fare({11.0, 12.0}).scanned, 0u);
+        ASSERT_EQ(e->search_by_fare({20.0, 30.0}).scanned, 0u);
+
+        // Distances cycle 0.25 .. 6.25 in every block: nothing to prune.
+        taxi::NumericRangeQuery d{1.0, 2.5};
+        r = e->search_by_distance(d);
+        ASSERT_EQ(r.scanned, 10000u);
+        ASSERT_TRUE(sorted(r) == sorted(unpruned.search_by_distance(d)));
+    }
+    ASSERT_EQ(unpruned.search_by_location({5000, 5100}).scanned, 10000u);
+    std::filesystem::remove(path);
+}
+
+// ── PartitionedDataset tests ────────────────────────────────────────────────
+
+// n trips spread over months first..first + months - 1 of 2021, round robin;
+// PULocationID = row + 1.
+static std::string make_monthly_csv(int n, int first, int months) {
+    std::string csv =
+        "VendorID,tpep_pickup_datetime,tpep_dropoff_datetime,passenger_count,"
+        "trip_distance,RatecodeID,store_and_fwd_flag,PULocationID,DOLocationID,"
+        "payment_type,fare_amount,extra,mta_tax,tip_amount,tolls_amount,"
+        "improvement_surcharge,total_amount\n";
+    auto two = [](int v) { return (v < 10 ? "0" : "") + std::to_string(v); };
+    for (int i = 0; i < n; ++i) {
+        const std::string date = two(first + i % months) + "/" + two(1 + i % 28) + "/2021 ";
+        csv += std::to_string(1 + i % 2) + "," + date + "08:00:00 AM," + date + "08:20:00 AM,"
+             + std::to_string(1 + i % 4) + "," + std::to_string(i % 9) + ".5,1,N,"
+             + std::to_string(i + 1) + ",75,1," + std::to_string(5 + i % 40) + ".25,"
+             + "0.00,0.50,1.00,0.00,0.30," + std::to_string(8 + i % 40) + ".05\n";
+    }
+    return csv;
+}
+
+void test_partitioned_matches_monolithic() {
+    ASSERT_EQ(taxi::PartitionedDataset::month_of(0), 1970 * 12);
+    ASSERT_EQ(taxi::PartitionedDataset::month_of(-1), 1969 * 12 + 11);
+    ASSERT_EQ(taxi::PartitionedDataset::month_of(1614556799), 2021 * 12 + 1);  // 02-28 23:59:59
+    ASSERT_EQ(taxi::PartitionedDataset::month_of(1614556800), 2021 * 12 + 2);  // 03-01
+    for (std::int64_t days : {-800000, -1, 0, 59, 18687, 2932896}) {
+        int y, m, d;
+        taxi::civil_from_days(days, y, m, d);
+        ASSERT_EQ(taxi::days_from_civil(y, m, d), days);
+    }
+
+    auto path = write_temp_csv(make_monthly_csv(3000, 1, 3));
+    auto soa  = taxi::TripDataSoA::from_csv({path});
+    taxi::SoAQueryEngine whole(soa);
+    whole.build_indexes();
+    auto parts = taxi::PartitionedDataset::from_soa(taxi::TripDataSoA(soa));
+    parts.build_indexes();
+    ASSERT_EQ(parts.partitions(), 3u);
+    ASSERT_EQ(parts.size(), 3000u);
+    ASSERT_EQ(parts.partition(0).data.size(), 1000u);
+    ASSERT_EQ(parts.partition(2).month, 2021 * 12 + 2);
+
+    // Same trips, told apart by their PULocationID.
+    auto ids = [&](const taxi::SoAQueryResult& r, bool partitioned) {
+        std::vector<int> out;
+        for (std::size_t row : r.indices) {
+            if (!partitioned) { out.push_back(soa.pu_location_id[row]); continue; }
+            auto [p, local] = parts.locate(row);
+            out.push_back(p->data.pu_location_id[local]);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    const std::int64_t feb = 1612137600, mar = 1614556800;   // 2021-02-01, 2021-03-01
+    taxi::TimeRangeQuery february{feb, mar - 1};
+    auto r = parts.search_by_time(february);
+    ASSERT_EQ(r.indices.size(), 1000u);
+    ASSERT_TRUE(ids(r, true) == ids(whole.search_by_time(february), false));
+    ASSERT_TRUE(ids(parts.search_by_distance({2.0, 4.0}), true) ==
+                ids(whole.search_by_distance({2.0, 4.0}), false));
+    ASSERT_TRUE(ids(parts.search_by_fare({10.0, 20.0}), true) ==
+                ids(whole.search_by_fare({10.0, 20.0}), false));
+    ASSERT_TRUE(ids(parts.search_by_location({500, 2500}), true) ==
+                ids(whole.search_by_location({500, 2500}), false));
+    taxi::CombinedQuery c{{feb + 86400 * 3, mar + 86400 * 5}, {1.0, 6.0}, {2, 3}};
+    ASSERT_TRUE(ids(parts.search_combined(c), true) == ids(whole.search_combined(c), false));
+    auto a = parts.aggregate_fare_by_time(february);
+    auto b = whole.aggregate_fare_by_time(february);
+    ASSERT_EQ(a.count, b.count);
+    ASSERT_NEAR(a.sum, b.sum, 1e-6);
+    std::filesystem::remove(path);
+}
+
+void test_partitioned_incremental_add() {
+    const auto janfeb_path = write_temp_csv(make_monthly_csv(200, 1, 2));
+    const auto mar_path    = write_temp_csv(make_monthly_csv(100, 3, 1), "taxi_unit_test_mar.csv");
+    auto janfeb = taxi::TripDataSoA::from_csv({janfeb_path});
+    auto mar    = taxi::TripDataSoA::from_csv({mar_path});
+    auto parts  = taxi::PartitionedDataset::from_soa(taxi::TripDataSoA(janfeb));
+    parts.build_indexes();
+    const auto* jan = &parts.partition(0);
+
+    // A new month is a new partition; only it needs an index.
+    parts.add(taxi::TripDataSoA(mar));
+    ASSERT_EQ(parts.partitions(), 3u);
+    ASSERT_EQ(parts.size(), 300u);
+    ASSERT_TRUE(&parts.partition(0) == jan);
+    ASSERT_TRUE(parts.partition(1).engine.indexes_built());
+    ASSERT_TRUE(!parts.partition(2).engine.indexes_built());
+    parts.build_indexes();
+    ASSERT_TRUE(parts.partition(2).engine.indexes_built());
+
+    // Rows of a month already there extend it, and only it is re-indexed.
+    parts.add(std::move(janfeb));
+    ASSERT_EQ(parts.partition(1).data.size(), 200u);
+    ASSERT_EQ(parts.partition(2).offset, 400u);
+    ASSERT_TRUE(!parts.partition(1).engine.indexes_built());
+    ASSERT_TRUE(parts.partition(2).engine.indexes_built());
+    parts.build_indexes();
+
+    // A March query reads only March: its index range, nothing else.
+    auto r = parts.search_by_time({1614556800, 1617235199});
+    ASSERT_EQ(r.indices.size(), 100u);
+    ASSERT_EQ(r.scanned, 100u);
+    for (std::size_t row : r.indices) ASSERT_TRUE(row >= 400u && row < 500u);
+
+    taxi::PartitionedDataset empty;
+    bool threw = false;
+    try {
+        empty.add(taxi::TripDataSoA::from_csv({mar_path}, 0, {taxi::Column::TripDistance}));
+    } catch (const std::runtime_error&) { threw = true; }
+    ASSERT_TRUE(threw);
+    std::filesystem::remove(janfeb_path);
+    std::filesystem::remove(mar_path);
+}
+
+// ── HotColdTrips tests ──────────────────────────────────────────────────────
+
+void test_hot_cold_round_trip() {
+    static_assert(sizeof(taxi::TripHot) == 40);
+    auto data  = make_test_dataset();
+    data[2].store_and_fwd_flag = true;
+    auto trips = taxi::HotColdTrips::from_aos(data);
+    ASSERT_EQ(trips.size(), data.size());
+    ASSERT_EQ(trips.cold.size(), data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        const taxi::TripRecord r = trips.record(i);
+        ASSERT_EQ(r.vendor_id, data[i].vendor_id);
+        ASSERT_EQ(r.pickup_timestamp, data[i].pickup_timestamp);
+        ASSERT_EQ(r.dropoff_timestamp, data[i].dropoff_timestamp);
+        ASSERT_EQ(r.passenger_count, data[i].passenger_count);
+        ASSERT_EQ(r.trip_distance, data[i].trip_distance);
+        ASSERT_EQ(r.store_and_fwd_flag, data[i].store_and_fwd_flag);
+        ASSERT_EQ(r.pu_location_id, data[i].pu_location_id);
+        ASSERT_EQ(r.do_location_id, data[i].do_location_id);
+        ASSERT_EQ(r.fare_amount, data[i].fare_amount);
+        ASSERT_EQ(r.total_amount, data[i].total_amount);
+        ASSERT_EQ(trips.index_of(&trips.hot[i]), i);
+        ASSERT_EQ(trips.cold_of(&trips.hot[i]).do_location_id, data[i].do_location_id);
+    }
+}
+
+void test_hot_cold_queries_match_aos() {
+    auto path  = write_temp_csv(make_monthly_csv(3000, 1, 3));
+    taxi::DatasetManager mgr;
+    mgr.load_from_csv(path);
+    auto data  = mgr.take_records();
+    auto trips = taxi::HotColdTrips::from_aos(data);
+    taxi::QueryEngine        aos(data);
+    taxi::HotColdQueryEngine hot(trips.hot);
+    aos.build_indexes();
+    hot.build_indexes();
+
+    // Same trips, told apart by PULocationID; the cold half follows the pointer.
+    auto ids = [](const auto& r) {
+        std::vector<int> out;
+        for (const auto* rec : r.records) out.push_back(rec->pu_location_id);
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    const std::int64_t feb = 1612137600, mar = 1614556800;
+    ASSERT_TRUE(ids(hot.search_by_time({feb, mar - 1})) == ids(aos.search_by_time({feb, mar - 1})));
+    ASSERT_TRUE(ids(hot.search_by_distance({2.0, 4.0})) == ids(aos.search_by_distance({2.0, 4.0})));
+    ASSERT_TRUE(ids(hot.search_by_fare({10.0, 20.0})) == ids(aos.search_by_fare({10.0, 20.0})));
+    ASSERT_TRUE(ids(hot.search_by_location({500, 2500})) == ids(aos.search_by_location({500, 2500})));
+    taxi::CombinedQuery c{{feb, mar + 86400 * 5}, {1.0, 6.0}, {2, 3}};
+    auto r = hot.search_combined(c);
+    ASSERT_TRUE(ids(r) == ids(aos.search_combined(c)));
+    ASSERT_TRUE(!r.records.empty());
+    for (const auto* h : r.records)
+        ASSERT_EQ(trips.cold_of(h).do_location_id, 75);
+    ASSERT_NEAR(hot.aggregate_fare_by_time({feb, mar - 1}).sum,
+                aos.aggregate_fare_by_time({feb, mar - 1}).sum, 1e-6);
+    std::filesystem::remove(path);
+}
+
+// ── TripDataAoSoA tests ─────────────────────────────────────────────────────
+
+void test_aosoa_round_trip() {
+    static_assert(sizeof(taxi::TripTile) == 6720 && alignof(taxi::TripTile) == 64);
+    auto data = make_test_dataset();
+    data[3].store_and_fwd_flag = true;
+    auto tiles = taxi::TripDataAoSoA::from_aos(data);
+    ASSERT_EQ(tiles.size(), data.size());
+    ASSERT_EQ(tiles.tiles.size(), 1u);
+    ASSERT_EQ(tiles.tiles[0].trip_distance[data.size()], 0.0);   // unused lanes are zero
+    auto from_soa = taxi::TripDataAoSoA::from_soa(taxi::TripDataSoA::from_aos(data));
+    ASSERT_EQ(from_soa.size(), data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        for (const auto& r : {tiles.record(i), from_soa.record(i)}) {
+            ASSERT_EQ(r.vendor_id, data[i].vendor_id);
+            ASSERT_EQ(r.pickup_timestamp, data[i].pickup_timestamp);
+            ASSERT_EQ(r.dropoff_timestamp, data[i].dropoff_timestamp);
+            ASSERT_EQ(r.passenger_count, data[i].passenger_count);
+            ASSERT_EQ(r.trip_distance, data[i].trip_distance);
+            ASSERT_EQ(r.store_and_fwd_flag, data[i].store_and_fwd_flag);
+            ASSERT_EQ(r.pu_location_id, data[i].pu_location_id);
+            ASSERT_EQ(r.fare_amount, data[i].fare_amount);
+            ASSERT_EQ(r.total_amount, data[i].total_amount);
+        }
+    }
+
+    // Row i is lane i % 64 of tile i / 64.
+    taxi::TripDataAoSoA grown;
+    for (int i = 0; i < 130; ++i) {
+        taxi::TripRecord r = data[0];
+        r.pu_location_id = i;
+        grown.push_back(r);
+    }
+    ASSERT_EQ(grown.tiles.size(), 3u);
+    ASSERT_EQ(grown.tiles[2].pu_location_id[1], 129);
+    ASSERT_EQ(grown.record(70).pu_location_id, 70);
+}
+
+void test_aosoa_queries_match_soa() {
+    // 3000 rows: 46 full tiles and one of 56.
+    auto path = write_temp_csv(make_monthly_csv(3000, 1, 3));
+    auto soa  = taxi::TripDataSoA::from_csv({path});
+    auto aosoa = taxi::TripDataAoSoA::from_soa(soa);
+    taxi::SoAQueryEngine   soa_engine(soa);
+    taxi::AoSoAQueryEngine tile_engine(aosoa);
+    taxi::AoSoAQueryEngine scan_engine(aosoa);   // no index: tile scans only
+    soa_engine.build_indexes();
+    tile_engine.build_indexes();
+
+    auto rows = [](taxi::SoAQueryResult r) {
+        std::sort(r.indices.begin(), r.indices.end());
+        return r.indices;
+    };
+    const std::int64_t feb = 1612137600, mar = 1614556800;
+    const auto q1 = rows(soa_engine.search_by_time({feb, mar - 1}));
+    ASSERT_EQ(q1.size(), 1000u);
+    ASSERT_TRUE(rows(tile_engine.search_by_time({feb, mar - 1})) == q1);
+    ASSERT_TRUE(rows(scan_engine.search_by_time({feb, mar - 1})) == q1);
+    ASSERT_TRUE(rows(tile_engine.search_by_distance({2.0, 4.0})) ==
+                rows(soa_engine.search_by_distance({2.0, 4.0})));
+    ASSERT_TRUE(rows(tile_engine.search_by_fare({10.0, 20.0})) ==
+                rows(soa_engine.search_by_fare({10.0, 20.0})));
+    ASSERT_TRUE(rows(tile_engine.search_by_location({500, 2999})) ==
+                rows(soa_engine.search_by_location({500, 2999})));
+    taxi::CombinedQuery c{{feb, mar + 86400 * 5}, {1.0, 6.0}, {2, 3}};
+    const auto q5 = rows(soa_engine.search_combined(c));
+    ASSERT_TRUE(!q5.empty());
+    ASSERT_TRUE(rows(tile_engine.search_combined(c)) == q5);
+    ASSERT_TRUE(rows(scan_engine.search_combined(c)) == q5);
+    const auto agg = tile_engine.aggregate_fare_by_time({feb, mar - 1});
+    ASSERT_EQ(agg.count, 1000u);
+    ASSERT_NEAR(agg.sum, soa_engine.aggregate_fare_by_time({feb, mar - 1}).sum, 1e-6);
+
+    // Months interleave in file order, so every tile holds February rows.
+    // Sorted by pickup time, Q5 reads only the tiles of its window.
+    taxi::DatasetManager mgr;
+    mgr.load_from_csv(path);
+    auto records = mgr.take_records();
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.pickup_timestamp < b.pickup_timestamp;
+    });
+    auto sorted = taxi::TripDataAoSoA::from_aos(records);
+    taxi::AoSoAQueryEngine sorted_engine(sorted);
+    sorted_engine.build_indexes();
+    ASSERT_EQ(tile_engine.search_combined(c).scanned, 3000u);
+    const auto pruned = sorted_engine.search_combined(c);
+    ASSERT_EQ(pruned.indices.size(), q5.size());
+    ASSERT_TRUE(pruned.scanned < 1300);
+    std::filesystem::remove(path);
+}
+
+// ── HugePages tests ─────────────────────────────────────────────────────────
+
+void test_huge_page_allocator() {
+    const auto before = taxi::huge_page_stats();
+    {
+        taxi::HugeVector<double> big;
+        big.resize(std::size_t{1} << 20);   // 8 MB: mapped, 2 MB aligned
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(big.data()) % taxi::kHugePageBytes, 0u);
+        big.back() = 1.5;
+        ASSERT_EQ(big.back(), 1.5);
+        taxi::HugeVector<int> small(1000, 7);   // below 2 MB: operator new
+        ASSERT_EQ(small[999], 7);
+
+        const auto live = taxi::huge_page_stats();
+        ASSERT_EQ((live.explicit_bytes + live.thp_bytes) - (before.explicit_bytes + before.thp_bytes),
+                  std::size_t{8} << 20);
+        ASSERT_EQ(live.small_bytes, before.small_bytes);
+    }
+    // Freed mappings are taken back off the counters.
+    const auto after = taxi::huge_page_stats();
+    ASSERT_EQ(after.explicit_bytes + after.thp_bytes, before.explicit_bytes + before.thp_bytes);
+
+    taxi::set_page_policy(taxi::PagePolicy::Small);
+    {
+        taxi::HugeVector<std::size_t> idx(std::size_t{1} << 19);   // 4 MB
+        ASSERT_EQ(taxi::huge_page_stats().small_bytes - after.small_bytes, std::size_t{4} << 20);
+    }
+    taxi::set_page_policy(taxi::PagePolicy::Huge);
+    ASSERT_EQ(taxi::huge_page_stats().small_bytes, after.small_bytes);
+}
+
+void test_first_touch_resize_zeroes() {
+    // Column resize zeroes new values (in parallel); existing ones are kept.
+    taxi::ColumnData<double> col;
+    col.resize(10);
+    col[3] = 2.5;
+    col.resize(std::size_t{3} << 20);   // 24 MB
+    ASSERT_EQ(col[3], 2.5);
+    bool zero = true;
+    for (std::size_t i = 10; i < col.size(); ++i) zero = zero && col[i] == 0.0;
+    ASSERT_TRUE(zero);
+
+    std::vector<unsigned char> buf((std::size_t{5} << 20) + 123, 0xFF);
+    taxi::first_touch_zero(buf.data() + 1, buf.size() - 2);
+    ASSERT_EQ(buf.front(), 0xFF);
+    ASSERT_EQ(buf.back(), 0xFF);
+    ASSERT_EQ(std::count(buf.begin(), buf.end(), 0), static_cast<std::ptrdiff_t>(buf.size() - 2));
+
+    // Time index: written in parallel without a zero fill; a permutation.
+    auto data = make_test_dataset();
+    auto soa  = taxi::TripDataSoA::from_aos(data);
+    taxi::SoAQueryEngine engine(soa);
+    engine.build_indexes();
+    auto idx = engine.time_index();
+    std::sort(idx.begin(), idx.end());
+    for (std::size_t i = 0; i < idx.size(); ++i) ASSERT_EQ(idx[i], i);
+}
+
+// ── RadixSort tests ──────────────────────────────────────────────────────────
+
+void test_radix_sort_rows_stable() {
+    // Past the parallel threshold, with ties: equal keys keep row order.
+    const std::size_t n = 200000;
+    auto check = [n](auto key) {
+        std::vector<std::size_t> expect(n);
+        for (std::size_t i = 0; i < n; ++i) expect[i] = i;
+        std::stable_sort(expect.begin(), expect.end(),
+                         [&](std::size_t a, std::size_t b) { return key(a) < key(b); });
+        taxi::RowIndex got(n);
+        taxi::radix_sort_rows(n, key, got.data());
+        return std::equal(expect.begin(), expect.end(), got.begin());
+    };
+    // 32-bit pairs: a year of seconds, negative keys, a one-second range.
+    ASSERT_TRUE(check([](std::size_t i) {
+        return std::int64_t{1609459200} + static_cast<std::int64_t>((i * 2654435761u) % 31536000);
+    }));
+    ASSERT_TRUE(check([](std::size_t i) { return -static_cast<std::int64_t>((i * 7919) % 1000); }));
+    ASSERT_TRUE(check([](std::size_t i) { return static_cast<std::int64_t>(i % 2); }));
+    // 64-bit pairs: a span wider than 2^32.
+    ASSERT_TRUE(check([](std::size_t i) {
+        return static_cast<std::int64_t>((i * 40503) % 1000) * (std::int64_t{1} << 40) - 7;
+    }));
+    // Already in order: the identity, without a sort.
+    ASSERT_TRUE(check([](std::size_t i) { return static_cast<std::int64_t>(i / 3); }));
+
+    taxi::HugeVector<taxi::KeyRow<std::uint32_t>> pairs;
+    for (std::uint32_t i = 0; i < 6; ++i) pairs.push_back({(6 - i) / 2, i});
+    taxi::radix_sort(pairs, 2);
+    const std::uint32_t rows[] = {5, 3, 4, 1, 2, 0};
+    for (std::size_t i = 0; i < 6; ++i) ASSERT_EQ(pairs[i].row, rows[i]);
+}
+
+void test_time_indexes_agree() {
+    // TimeIndex (AoS), SoA and AoSoA indices share the radix sort: the same
+    // permutation, in pickup order, with ties in row order.
+    std::vector<taxi::TripRecord> records(100000);
+    for (std::size_t i = 0; i < records.size(); ++i)
+        records[i].pickup_timestamp =
+            1609459200 + static_cast<std::int64_t>((i * 48271) % 86400);
+    const std::span<const taxi::TripRecord> rows(records);
+    taxi::TimeIndex aos;
+    aos.build(rows);
+
+    auto soa = taxi::TripDataSoA::from_aos(records);
+    taxi::SoAQueryEngine soa_engine(soa);
+    soa_engine.build_indexes();
+    auto tiles = taxi::TripDataAoSoA::from_soa(soa);
+    taxi::AoSoAQueryEngine aosoa_engine(tiles);
+    aosoa_engine.build_indexes();
+
+    const auto& idx = aos.sorted_indices();
+    ASSERT_EQ(idx.size(), records.size());
+    ASSERT_TRUE(std::equal(idx.begin(), idx.end(), soa_engine.time_index().begin()));
+    bool ordered = true;
+    for (std::size_t i = 1; i < idx.size(); ++i) {
+        const auto a = records[idx[i - 1]].pickup_timestamp;
+        const auto b = records[idx[i]].pickup_timestamp;
+        ordered = ordered && (a < b || (a == b && idx[i - 1] < idx[i]));
+    }
+    ASSERT_TRUE(ordered);
+
+    taxi::TimeRangeQuery q{1609459200 + 1000, 1609459200 + 2000};
+    const auto [first, last] = aos.lookup(rows, q.start_time, q.end_time);
+    const auto tiled = aosoa_engine.search_by_time(q);
+    ASSERT_EQ(tiled.indices.size(), last - first);
+    ASSERT_TRUE(std::equal(tiled.indices.begin(), tiled.indices.end(), idx.begin() + first));
+}
+
+// ── TimeClustering tests ────────────────────────────────────────────────────
+
+// Trips in scrambled time order over @p days days; tip_amount holds the
+// original row number, so permuted rows can be traced.
+static std::vector<taxi::TripRecord> make_scrambled_trips(std::size_t n, std::int64_t days) {
+    std::vector<taxi::TripRecord> records(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto& r = records[i];
+        r.pickup_timestamp  = 1609459200 + static_cast<std::int64_t>((i * 7919) % (days * 86400 / 60)) * 60;
+        r.dropoff_timestamp = r.pickup_timestamp + 600;
+        r.pu_location_id    = static_cast<int>(1 + (i * 31) % 265);
+        r.passenger_count   = static_cast<int>(i % 5);
+        r.trip_distance     = static_cast<double>(i % 97) / 10.0;
+        r.fare_amount       = static_cast<double>(i % 50) + 2.5;
+        r.tip_amount        = static_cast<double>(i);
+    }
+    return records;
+}
+
+void test_cluster_by_time_orders_rows() {
+    const auto records = make_scrambled_trips(100000, 20);
+
+    // Pickup order, stable: equal times keep their original row order.
+    auto soa = taxi::TripDataSoA::from_aos(records);
+    ASSERT_TRUE(soa.time_clustering() == taxi::TimeClustering::None);
+    soa.cluster_by_time();
+    ASSERT_TRUE(soa.time_clustering() == taxi::TimeClustering::Pickup);
+    ASSERT_EQ(soa.size(), records.size());
+    bool ordered = true, intact = true;
+    std::vector<bool> seen(records.size(), false);
+    for (std::size_t i = 0; i < soa.size(); ++i) {
+        const auto id = static_cast<std::size_t>(soa.tip_amount[i]);
+        intact = intact && !seen[id] && soa.pickup_timestamp[i] == records[id].pickup_timestamp &&
+                 soa.dropoff_timestamp[i] == records[id].dropoff_timestamp &&
+                 soa.pu_location_id[i] == records[id].pu_location_id;
+        seen[id] = true;
+        if (i == 0) continue;
+        ordered = ordered &&
+                  (soa.pickup_timestamp[i - 1] < soa.pickup_timestamp[i] ||
+                   (soa.pickup_timestamp[i - 1] == soa.pickup_timestamp[i] &&
+                    soa.tip_amount[i - 1] < soa.tip_amount[i]));
+    }
+    ASSERT_TRUE(intact);
+    ASSERT_TRUE(ordered);
+
+    // Day, then location, then time.
+    auto by_loc = taxi::TripDataSoA::from_aos(records);
+    by_loc.cluster_by_time(taxi::TimeClustering::DayLocation);
+    ordered = true;
+    for (std::size_t i = 1; i < by_loc.size(); ++i) {
+        const auto key = [&](std::size_t r) {
+            return std::tuple{by_loc.pickup_timestamp[r] / 86400, by_loc.pu_location_id[r],
+                              by_loc.pickup_timestamp[r]};
+        };
+        ordered = ordered && key(i - 1) <= key(i);
+    }
+    ASSERT_TRUE(ordered);
+
+    // Added rows end the order; a missing key column is an error.
+    by_loc.push_back(records[0]);
+    ASSERT_TRUE(by_loc.time_clustering() == taxi::TimeClustering::None);
+    taxi::TripDataSoA no_location(taxi::ColumnSet{taxi::Column::PickupTimestamp});
+    bool threw = false;
+    try { no_location.cluster_by_time(taxi::TimeClustering::DayLocation); }
+    catch (const std::runtime_error&) { threw = true; }
+    ASSERT_TRUE(threw);
+}
+
+void test_clustered_engine_matches_index() {
+    // Q1 / Q5 / Q6 on clustered tables (row slices, no index) == the
+    // indexed engine on the scrambled table, compared by original row.
+    const auto records = make_scrambled_trips(60000, 30);
+    auto plain = taxi::TripDataSoA::from_aos(records);
+    taxi::SoAQueryEngine indexed(plain);
+    indexed.build_indexes();
+
+    auto ids = [](const taxi::TripDataSoA& t, const taxi::SoAQueryResult& r) {
+        std::vector<double> out;
+        for (std::size_t row : r.indices) out.push_back(t.tip_amount[row]);
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    const taxi::TimeRangeQuery window{1609459200 + 3 * 86400 + 5000, 1609459200 + 11 * 86400 + 700};
+    const taxi::CombinedQuery  combined{window, {1.0, 6.0}, {1, 3}};
+
+    for (auto order : {taxi::TimeClustering::Pickup, taxi::TimeClustering::DayLocation}) {
+        auto soa = taxi::TripDataSoA::from_aos(records);
+        soa.cluster_by_time(order);
+        taxi::SoAQueryEngine engine(soa);
+        engine.build_indexes();
+        ASSERT_TRUE(engine.time_clustering() == order);
+        ASSERT_TRUE(engine.time_index().empty());
+
+        ASSERT_TRUE(ids(soa, engine.search_by_time(window)) ==
+                    ids(plain, indexed.search_by_time(window)));
+        ASSERT_TRUE(ids(soa, engine.search_combined(combined)) ==
+                    ids(plain, indexed.search_combined(combined)));
+        const auto agg  = engine.aggregate_fare_by_time(window);
+        const auto want = indexed.aggregate_fare_by_time(window);
+        ASSERT_EQ(agg.count, want.count);
+        ASSERT_NEAR(agg.sum, want.sum, 1e-6);
+
+        // A time-ordered Q1 is exactly its slice of rows.
+        if (order == taxi::TimeClustering::Pickup) {
+            const auto r = engine.search_by_time(window);
+            ASSERT_EQ(r.scanned, r.indices.size());
+            ASSERT_TRUE(std::is_sorted(r.indices.begin(), r.indices.end()));
+        }
+        ASSERT_EQ(engine.search_by_time({0, 1}).indices.size(), 0u);
+    }
+}
+
 // ── main ─────────────────────────────────────────────────────────────────────
 
 int main() {
@@ -451,6 +2215,47 @@ int main() {
     RUN_TEST(test_csv_reader_eof);
     RUN_TEST(test_csv_reader_nonexistent_file);
     RUN_TEST(test_csv_reader_multiple_rows);
+    RUN_TEST(test_csv_reader_mmap_matches_stream);
+    RUN_TEST(test_csv_reader_load_chunk_covers_every_row);
+
+    std::cout << "\n-- CsvScanner --\n";
+    RUN_TEST(test_csv_scanner_quoted_row);
+    RUN_TEST(test_csv_scanner_kernels_agree);
+
+    std::cout << "\n-- FieldDecoder --\n";
+    RUN_TEST(test_field_decoder_int_double);
+    RUN_TEST(test_field_decoder_cents_money);
+
+    std::cout << "\n-- TimestampDecoder --\n";
+    RUN_TEST(test_days_from_civil_matches_year_loop);
+    RUN_TEST(test_timestamp_formats_agree);
+    RUN_TEST(test_csv_reader_iso_timestamps);
+    RUN_TEST(test_date_cache_find_insert);
+    RUN_TEST(test_csv_reader_timestamp_cache_stats);
+
+    std::cout << "\n-- ParallelLoader --\n";
+    RUN_TEST(test_parallel_loader_split_morsels);
+    RUN_TEST(test_parallel_loader_morsels_match_serial);
+    RUN_TEST(test_parallel_loader_multi_file_single_output);
+    RUN_TEST(test_parallel_loader_soa_matches_from_csv);
+
+    std::cout << "\n-- IngestPipeline --\n";
+    RUN_TEST(test_bounded_queue_mpmc);
+    RUN_TEST(test_ingest_pipeline_matches_serial);
+
+    std::cout << "\n-- ColumnMap --\n";
+    RUN_TEST(test_column_map_from_header);
+    RUN_TEST(test_csv_reader_reordered_schema);
+    RUN_TEST(test_soa_column_projection);
+
+    std::cout << "\n-- FileSource --\n";
+    RUN_TEST(test_file_source_backends_read_whole_file);
+    RUN_TEST(test_file_source_direct_short_read);
+    RUN_TEST(test_csv_reader_read_modes_agree);
+
+    std::cout << "\n-- Compression --\n";
+    RUN_TEST(test_csv_reader_gzip_members);
+    RUN_TEST(test_parallel_loader_gzip_members);
 
     std::cout << "\n-- TripDataSoA --\n";
     RUN_TEST(test_soa_from_aos_size);
@@ -476,6 +2281,49 @@ int main() {
     RUN_TEST(test_soa_query_aggregate_fare);
     RUN_TEST(test_aos_soa_query_consistency);
 
+    std::cout << "\n-- Snapshot --\n";
+    RUN_TEST(test_snapshot_round_trip);
+    RUN_TEST(test_snapshot_rejects_corruption);
+    RUN_TEST(test_snapshot_map_matches_load);
+    RUN_TEST(test_column_data_mapped_copy_on_write);
+
+    std::cout << "\n-- CompactSoA --\n";
+    RUN_TEST(test_narrow_column_widens);
+    RUN_TEST(test_compact_soa_matches_wide);
+    RUN_TEST(test_money_column_cents);
+    RUN_TEST(test_compact_money_queries_exact);
+    RUN_TEST(test_timestamp_column_encoding);
+    RUN_TEST(test_compact_time_queries_match);
+    RUN_TEST(test_packed_column_select);
+
+    std::cout << "\n-- ZoneMap --\n";
+    RUN_TEST(test_zone_map_summaries);
+    RUN_TEST(test_zone_pruned_scans);
+
+    std::cout << "\n-- PartitionedDataset --\n";
+    RUN_TEST(test_partitioned_matches_monolithic);
+    RUN_TEST(test_partitioned_incremental_add);
+
+    std::cout << "\n-- HotColdTrips --\n";
+    RUN_TEST(test_hot_cold_round_trip);
+    RUN_TEST(test_hot_cold_queries_match_aos);
+
+    std::cout << "\n-- TripDataAoSoA --\n";
+    RUN_TEST(test_aosoa_round_trip);
+    RUN_TEST(test_aosoa_queries_match_soa);
+
+    std::cout << "\n-- HugePages --\n";
+    RUN_TEST(test_huge_page_allocator);
+    RUN_TEST(test_first_touch_resize_zeroes);
+
+    std::cout << "\n-- RadixSort --\n";
+    RUN_TEST(test_radix_sort_rows_stable);
+    RUN_TEST(test_time_indexes_agree);
+
+    std::cout << "\n-- TimeClustering --\n";
+    RUN_TEST(test_cluster_by_time_orders_rows);
+    RUN_TEST(test_clustered_engine_matches_index);
+
     std::cout << "\n=================================\n";
     std::cout << "  Total: " << (passed + failed)
               << "  Passed: " << passed